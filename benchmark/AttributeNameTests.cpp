@@ -0,0 +1,87 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "AttributeName.hpp"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+// the tango host has a network domain, so it is never resolved in the benchmarks
+const std::string BenchAttrFQDName = "tango://archiver.esrf.fr:10000/sr/d-ct/gauge-01/current";
+} // namespace
+
+//=============================================================================
+//=============================================================================
+void bmAttributeNameParse(benchmark::State& state) 
+{
+    // TEST - Setting a name and requesting every element, as done when an attribute
+    // is configured
+    hdbpp_internal::AttributeName attr_name;
+
+    for (auto _ : state)
+    {
+        attr_name.set(BenchAttrFQDName);
+        benchmark::DoNotOptimize(attr_name.tangoHostWithDomain());
+        benchmark::DoNotOptimize(attr_name.fullAttributeName());
+        benchmark::DoNotOptimize(attr_name.domain());
+        benchmark::DoNotOptimize(attr_name.family());
+        benchmark::DoNotOptimize(attr_name.member());
+        benchmark::DoNotOptimize(attr_name.name());
+    }
+}
+
+BENCHMARK(bmAttributeNameParse);
+
+//=============================================================================
+//=============================================================================
+void bmAttributeNameCopy(benchmark::State& state) 
+{
+    // TEST - Copying a parsed name, the copy keeps the elements without parsing again
+    hdbpp_internal::AttributeName attr_name {BenchAttrFQDName};
+    benchmark::DoNotOptimize(attr_name.name());
+
+    for (auto _ : state)
+    {
+        hdbpp_internal::AttributeName copy {attr_name};
+        benchmark::DoNotOptimize(copy.name());
+    }
+}
+
+BENCHMARK(bmAttributeNameCopy);
+
+//=============================================================================
+//=============================================================================
+void bmAttributeNameStorageName(benchmark::State& state) 
+{
+    // TEST - Parsing a name and building the name it is stored under, the work done
+    // for each event of an attribute that is not registered
+    for (auto _ : state)
+    {
+        hdbpp_internal::AttributeName attr_name {BenchAttrFQDName};
+        auto tango_host = attr_name.tangoHostWithDomain();
+        auto full_attr_name = attr_name.fullAttributeName();
+
+        std::string storage_name {"tango://"};
+        storage_name.append(tango_host.data(), tango_host.size()).append("/");
+        storage_name.append(full_attr_name.data(), full_attr_name.size());
+        benchmark::DoNotOptimize(storage_name);
+    }
+}
+
+BENCHMARK(bmAttributeNameStorageName);
@@ -0,0 +1,66 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "StatementTable.hpp"
+#include <benchmark/benchmark.h>
+
+//=============================================================================
+//=============================================================================
+void bmStatementTableLookup(benchmark::State& state) 
+{
+    // TEST - Finding the data event statement in the dense table, this replaces the
+    // name and statement lookups in the QueryBuilder caches, see bmTraitsComparator
+    hdbpp_internal::LogConfigurator::initLogging();
+
+    hdbpp_internal::pqxx_conn::QueryBuilder query_builder;
+    hdbpp_internal::pqxx_conn::StatementTable statements;
+    statements.build(query_builder);
+
+    hdbpp_internal::AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(statements.handle(traits));
+}
+
+BENCHMARK(bmStatementTableLookup);
+
+//=============================================================================
+//=============================================================================
+void bmQueryBuilderNameLookup(benchmark::State& state) 
+{
+    // TEST - The lookups the data event store path made before the statement table, the
+    // name three times and the statement once, against a fully populated cache
+    hdbpp_internal::LogConfigurator::initLogging();
+
+    hdbpp_internal::pqxx_conn::QueryBuilder query_builder;
+    hdbpp_internal::pqxx_conn::StatementTable statements;
+    statements.build(query_builder);
+
+    hdbpp_internal::AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(query_builder.storeDataEventName(traits));
+        benchmark::DoNotOptimize(query_builder.storeDataEventName(traits));
+        benchmark::DoNotOptimize(query_builder.storeDataEventName(traits));
+        benchmark::DoNotOptimize(query_builder.storeDataEventStatement<double>(traits));
+    }
+}
+
+BENCHMARK(bmQueryBuilderNameLookup);
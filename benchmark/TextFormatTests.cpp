@@ -0,0 +1,72 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "PqxxExtension.hpp"
+#include "TextFormat.hpp"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<double> randomSpectrum(std::size_t size)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1.0e6, 1.0e6);
+    std::vector<double> values(size);
+
+    for (auto &value : values)
+        value = distribution(generator);
+
+    return values;
+}
+} // namespace
+
+//=============================================================================
+//=============================================================================
+void bmFormatDoubleArray(benchmark::State& state) 
+{
+    // TEST - Formatting a double spectrum as a postgres array literal, as used when
+    // binding it to a prepared statement
+    auto values = randomSpectrum(state.range(0));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(pqxx::to_string(values));
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmFormatDoubleArray)->Arg(16)->Arg(1024)->Arg(16384);
+
+//=============================================================================
+//=============================================================================
+void bmFormatDoubleArrayPqxx(benchmark::State& state) 
+{
+    // TEST - The same spectrum formatted with the pqxx per element conversion the
+    // array formatting used before
+    auto values = randomSpectrum(state.range(0));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize("{" + pqxx::separated_list(",", values.begin(), values.end()) + "}");
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmFormatDoubleArrayPqxx)->Arg(16)->Arg(1024)->Arg(16384);
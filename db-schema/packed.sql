@@ -0,0 +1,17 @@
+-- Optional columns for packed array values, see array_packing in the configuration
+-- documentation. Run this after schema.sql to allow a library with array_packing
+-- enabled to store its numeric spectrum and image values as packed bytea, rather
+-- than as an array of the element type.
+--
+-- A row stores its values in either the array or the packed columns, so the value_r
+-- and value_w columns of existing rows are left as they are.
+
+ALTER TABLE att_array_devuchar ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devshort ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devushort ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devlong ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devulong ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devlong64 ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devulong64 ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devfloat ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
+ALTER TABLE att_array_devdouble ADD COLUMN IF NOT EXISTS value_r_packed bytea, ADD COLUMN IF NOT EXISTS value_w_packed bytea;
@@ -0,0 +1,252 @@
+-- Optional rollups of the numeric scalar data tables, see rollups in the configuration
+-- documentation. Each is a continuous aggregate holding the minimum, maximum, average and
+-- count of the read values of each attribute in buckets of a minute, an hour or a day,
+-- kept up to date by a refresh policy. These are the rollups a library with rollups
+-- enabled creates at startup, run this after schema.sql to create them in advance, for
+-- example when the library's user can not create them.
+--
+-- Each rollup is filled from the events already stored as it is created, which may take
+-- a long time for a large table. Requires TimescaleDB 2.0 or later.
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devuchar_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devuchar
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devuchar_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devuchar_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devuchar
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devuchar_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devuchar_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devuchar
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devuchar_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devshort_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devshort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devshort_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devshort_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devshort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devshort_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devshort_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devshort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devshort_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devushort_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devushort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devushort_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devushort_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devushort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devushort_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devushort_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devushort
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devushort_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong64_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong64_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong64_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong64_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devlong64_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devlong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devlong64_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong64_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong64_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong64_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong64_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devulong64_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devulong64
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devulong64_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devfloat_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devfloat
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devfloat_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devfloat_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devfloat
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devfloat_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devfloat_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devfloat
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devfloat_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devdouble_1m
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 minute', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devdouble
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 minute', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devdouble_1m', start_offset => INTERVAL '1 day', end_offset => INTERVAL '1 minute', schedule_interval => INTERVAL '5 minutes', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devdouble_1h
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 hour', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devdouble
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 hour', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devdouble_1h', start_offset => INTERVAL '7 days', end_offset => INTERVAL '1 hour', schedule_interval => INTERVAL '1 hour', if_not_exists => true);
+
+CREATE MATERIALIZED VIEW IF NOT EXISTS att_scalar_devdouble_1d
+    WITH (timescaledb.continuous, timescaledb.materialized_only = false) AS
+    SELECT att_conf_id, time_bucket(INTERVAL '1 day', data_time) AS bucket,
+        MIN(value_r) AS value_r_min, MAX(value_r) AS value_r_max, AVG(value_r) AS value_r_avg, COUNT(value_r) AS value_r_count
+    FROM att_scalar_devdouble
+    GROUP BY att_conf_id, time_bucket(INTERVAL '1 day', data_time);
+
+SELECT add_continuous_aggregate_policy('att_scalar_devdouble_1d', start_offset => INTERVAL '31 days', end_offset => INTERVAL '1 day', schedule_interval => INTERVAL '1 day', if_not_exists => true);
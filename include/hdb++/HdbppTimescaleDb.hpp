@@ -85,8 +85,7 @@ public:
      * @param  ttl The time to live in hour, 0 for infinity
      * @throw Tango::DevFailed
      */
-    virtual void configure_Attr(
-        std::string fqdn_attr_name, int type, int format, int write_type, unsigned int /* ttl */);
+    virtual void configure_Attr(std::string fqdn_attr_name, int type, int format, int write_type, unsigned int ttl);
 
     /**
      * @brief Update the ttl value for an attribute.
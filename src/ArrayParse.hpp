@@ -0,0 +1,241 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _ARRAY_PARSE_HPP
+#define _ARRAY_PARSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <locale.h>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // This namespace parses the elements of a postgres array of numbers or bools, as
+    // returned in the text format, for example the body of {1.5,-2,NaN}. It works on
+    // the text in place, so there is no copying or allocation other than the result,
+    // and delimiters are found 16 or 32 bytes at a time where the CPU supports it.
+    // Arrays of strings are left to the pqxx array_parser, since they may be quoted.
+    namespace array_parse
+    {
+        //=============================================================================
+        //=============================================================================
+        inline const char *findDelimiter(const char *begin, const char *end, char delimiter) noexcept
+        {
+#if defined(__AVX2__)
+            auto pattern32 = _mm256_set1_epi8(delimiter);
+
+            for (; end - begin >= 32; begin += 32)
+            {
+                auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+                auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern32)));
+
+                if (mask != 0)
+                    return begin + __builtin_ctz(mask);
+            }
+#endif
+#if defined(__SSE2__)
+            auto pattern16 = _mm_set1_epi8(delimiter);
+
+            for (; end - begin >= 16; begin += 16)
+            {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern16)));
+
+                if (mask != 0)
+                    return begin + __builtin_ctz(mask);
+            }
+#endif
+            for (; begin != end; ++begin)
+                if (*begin == delimiter)
+                    return begin;
+
+            return end;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline std::size_t countDelimiters(const char *begin, const char *end, char delimiter) noexcept
+        {
+            std::size_t count = 0;
+
+#if defined(__SSE2__)
+            auto pattern = _mm_set1_epi8(delimiter);
+
+            for (; end - begin >= 16; begin += 16)
+            {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+                count += __builtin_popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern))));
+            }
+#endif
+            for (; begin != end; ++begin)
+                if (*begin == delimiter)
+                    count++;
+
+            return count;
+        }
+
+        // the C locale, so a decimal point is always a point whatever the process locale
+        inline locale_t cLocale()
+        {
+            static locale_t locale = newlocale(LC_ALL_MASK, "C", nullptr);
+            return locale;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type parseElement(
+            const char *begin, const char *end, T &value) noexcept
+        {
+            using Unsigned = typename std::make_unsigned<T>::type;
+
+            auto negative = false;
+
+            if (begin != end && (*begin == '-' || *begin == '+'))
+                negative = *begin++ == '-';
+
+            if (begin == end || (negative && std::is_unsigned<T>::value))
+                return false;
+
+            // the magnitude of the most negative value is one more than the maximum
+            auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+            uint64_t magnitude = 0;
+
+            for (; begin != end; ++begin)
+            {
+                auto digit = static_cast<unsigned>(*begin - '0');
+
+                if (digit > 9 || magnitude > (limit - digit) / 10)
+                    return false;
+
+                magnitude = magnitude * 10 + digit;
+            }
+
+            value = static_cast<T>(negative ? Unsigned(0) - static_cast<Unsigned>(magnitude) :
+                                              static_cast<Unsigned>(magnitude));
+
+            return true;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline bool parseElement(const char *begin, const char *end, double &value) noexcept
+        {
+            // strtod stops at the delimiter following the element, and reads the NaN
+            // and Infinity postgres writes for the non finite values
+            char *parsed = nullptr;
+            value = strtod_l(begin, &parsed, cLocale());
+            return begin != end && parsed == end;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline bool parseElement(const char *begin, const char *end, float &value) noexcept
+        {
+            char *parsed = nullptr;
+            value = strtof_l(begin, &parsed, cLocale());
+            return begin != end && parsed == end;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline bool parseElement(const char *begin, const char *end, bool &value) noexcept
+        {
+            // postgres writes t and f, but the longer forms are accepted too
+            auto matches = [begin, end](const char *word) {
+                auto iter = begin;
+
+                for (; iter != end && *word != '\0'; ++iter, ++word)
+                    if (*iter != *word)
+                        return false;
+
+                return iter == end && *word == '\0';
+            };
+
+            if (matches("t") || matches("true") || matches("1"))
+                value = true;
+            else if (matches("f") || matches("false") || matches("0"))
+                value = false;
+            else
+                return false;
+
+            return true;
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        typename std::enable_if<std::is_enum<T>::value, bool>::type parseElement(
+            const char *begin, const char *end, T &value) noexcept
+        {
+            // enums, for example DevState, are stored as their integer value
+            typename std::underlying_type<T>::type number;
+
+            if (!parseElement(begin, end, number))
+                return false;
+
+            value = static_cast<T>(number);
+            return true;
+        }
+
+        // Parse the comma separated elements between begin and end, the text inside the
+        // braces of the array, into the vector. Returns false if any element is invalid,
+        // in which case the vector holds the elements parsed before it. The text must be
+        // followed by a character that can not continue a number, such as the closing brace
+        template<typename T>
+        bool parseArray(const char *begin, const char *end, std::vector<T> &values)
+        {
+            values.clear();
+
+            if (begin == end)
+                return true;
+
+            values.reserve(countDelimiters(begin, end, ',') + 1);
+
+            for (;;)
+            {
+                auto delimiter = findDelimiter(begin, end, ',');
+
+                T value;
+
+                if (!parseElement(begin, delimiter, value))
+                    return false;
+
+                values.push_back(value);
+
+                if (delimiter == end)
+                    return true;
+
+                begin = delimiter + 1;
+            }
+        }
+    } // namespace array_parse
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _ARRAY_PARSE_HPP
@@ -19,14 +19,18 @@
 
 #include "AttributeName.hpp"
 
+#include "HostResolver.hpp"
 #include "LibUtils.hpp"
 
-#include <netdb.h>
-
 using namespace std;
 
 namespace hdbpp_internal
 {
+namespace
+{
+    const string TangoPrefix = "tango://";
+} // namespace
+
 //=============================================================================
 //=============================================================================
 AttributeName::AttributeName(const std::string &fqdn_attr_name)
@@ -38,9 +42,9 @@ AttributeName::AttributeName(const std::string &fqdn_attr_name)
 //=============================================================================
 void AttributeName::set(const std::string &fqdn_attr_name)
 {
-    // clear the cache and set the name
-    clear();
     _fqdn_attr_name = fqdn_attr_name;
+    _tango_host_with_domain.clear();
+    parse();
 }
 
 //=============================================================================
@@ -48,221 +52,151 @@ void AttributeName::set(const std::string &fqdn_attr_name)
 void AttributeName::clear() noexcept
 {
     _fqdn_attr_name.clear();
-    _full_attribute_name_cache.clear();
-    _tango_host_cache.clear();
-    _tango_host_with_domain_cache.clear();
-    _domain_cache.clear();
-    _family_cache.clear();
-    _member_cache.clear();
-    _attribute_name_cache.clear();
+    _tango_host_with_domain.clear();
+    parse();
 }
 
 //=============================================================================
 //=============================================================================
-const string &AttributeName::tangoHost()
+void AttributeName::parse() noexcept
 {
-    validate();
+    const auto &fqdn = _fqdn_attr_name;
+    const auto size = static_cast<uint32_t>(fqdn.size());
+
+    // if tango:// is on the front of the string, the tango host follows it
+    _host_begin = fqdn.compare(0, TangoPrefix.size(), TangoPrefix) == 0 ? static_cast<uint32_t>(TangoPrefix.size()) : 0;
+    _host_end = _host_begin;
+
+    while (_host_end < size && fqdn[_host_end] != '/')
+        _host_end++;
 
-    if (_tango_host_cache.empty())
+    // the full attribute name follows the slash after the tango host, when there
+    // is no such slash it is taken to be the entire fqdn
+    _full_begin = _host_end < size ? _host_end + 1 : 0;
+    _slash_count = 0;
+
+    for (auto i = _full_begin; i < size; i++)
     {
-        // if tango:// exists on the string, strip it off by moving the start in 8 characters
-        auto start = _fqdn_attr_name.find("tango://") == string::npos ? 0 : 8;
-        auto end = _fqdn_attr_name.find('/', start);
-        _tango_host_cache = _fqdn_attr_name.substr(start, end - start);
-    }
+        if (fqdn[i] == '/')
+        {
+            if (_slash_count < 3)
+                _slashes[_slash_count] = i;
 
-    return _tango_host_cache;
+            _slash_count++;
+        }
+    }
 }
 
 //=============================================================================
 //=============================================================================
-const string &AttributeName::tangoHostWithDomain()
+string_view AttributeName::tangoHost() const
 {
     validate();
+    return view(_host_begin, _host_end);
+}
 
-    if (_tango_host_with_domain_cache.empty())
-    {
-        string tango_host = tangoHost();
-
-        if (tango_host.find('.') == string::npos)
-        {
-            string server_name_with_domain;
-            auto server_name = tango_host.substr(0, tango_host.find(':', 0));
-
-            struct addrinfo hints = {};
-            hints.ai_family = AF_UNSPEC; /*either IPV4 or IPV6*/
-            hints.ai_socktype = SOCK_STREAM;
-            hints.ai_flags = AI_CANONNAME;
+//=============================================================================
+//=============================================================================
+string_view AttributeName::tangoHostWithDomain()
+{
+    validate();
 
-            struct addrinfo *result, *rp;
-            const int status = getaddrinfo(server_name.c_str(), nullptr, &hints, &result);
+    auto tango_host = tangoHost();
 
-            if (status != 0)
-            {
-                spdlog::error("Error: Unable to add domain to tango host: getaddrinfo failed with error: {}",
-                    gai_strerror(status));
+    if (tango_host.find('.') != string_view::npos)
+        return tango_host;
 
-                return tangoHost();
-            }
+    if (_tango_host_with_domain.empty())
+    {
+        // the resolver caches the name, so the host is not looked up for every event
+        auto port = tango_host.find(':');
+        auto server_name = tango_host.substr(0, port).to_string();
 
-            for (rp = result; rp != nullptr; rp = rp->ai_next)
-                server_name_with_domain = string(rp->ai_canonname) + tango_host.substr(tango_host.find(':', 0));
+        _tango_host_with_domain = HostResolver::instance().canonicalName(server_name);
 
-            freeaddrinfo(result); // all done with this structure
-            _tango_host_with_domain_cache = server_name_with_domain;
-        }
-        else
-        {
-            _tango_host_with_domain_cache = tango_host;
-        }
+        if (port != string_view::npos)
+            _tango_host_with_domain.append(tango_host.data() + port, tango_host.size() - port);
     }
 
-    return _tango_host_with_domain_cache;
+    return _tango_host_with_domain;
 }
 
 //=============================================================================
 //=============================================================================
-const string &AttributeName::fullAttributeName()
+string_view AttributeName::fullAttributeName() const
 {
     validate();
-
-    if (_full_attribute_name_cache.empty())
-    {
-        // if tango:// exists on the string, strip it off by moving the start in 8 characters
-        auto start = _fqdn_attr_name.find("tango://") == string::npos ? 0 : 8;
-        start = _fqdn_attr_name.find('/', start);
-        start++;
-        _full_attribute_name_cache = _fqdn_attr_name.substr(start);
-    }
-
-    return _full_attribute_name_cache;
+    return view(_full_begin, _fqdn_attr_name.size());
 }
 
 //=============================================================================
 //=============================================================================
-const std::string &AttributeName::domain()
+string_view AttributeName::domain() const
 {
-    validate();
-
-    if (_domain_cache.empty())
-        setDomainFamilyMemberName(fullAttributeName());
-
-    return _domain_cache;
+    validateElements();
+    return view(_full_begin, _slashes[0]);
 }
 
 //=============================================================================
 //=============================================================================
-const std::string &AttributeName::family()
+string_view AttributeName::family() const
 {
-    validate();
-
-    if (_domain_cache.empty())
-        setDomainFamilyMemberName(fullAttributeName());
-
-    return _family_cache;
+    validateElements();
+    return view(_slashes[0] + 1, _slashes[1]);
 }
 
 //=============================================================================
 //=============================================================================
-const std::string &AttributeName::member()
+string_view AttributeName::member() const
 {
-    validate();
-
-    if (_domain_cache.empty())
-        setDomainFamilyMemberName(fullAttributeName());
-
-    return _member_cache;
+    validateElements();
+    return view(_slashes[1] + 1, _slashes[2]);
 }
 
 //=============================================================================
 //=============================================================================
-const std::string &AttributeName::name()
+string_view AttributeName::name() const
 {
-    validate();
-
-    if (_domain_cache.empty())
-        setDomainFamilyMemberName(fullAttributeName());
-
-    return _attribute_name_cache;
+    validateElements();
+    return view(_slashes[2] + 1, _fqdn_attr_name.size());
 }
 
 //=============================================================================
 //=============================================================================
-void AttributeName::setDomainFamilyMemberName(const string &full_attr_name)
+void AttributeName::validateElements() const
 {
-    auto first_slash = full_attr_name.find('/');
-
-    if (first_slash == string::npos)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". There is no slash in attribute name"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    auto second_slash = full_attr_name.find('/', first_slash + 1);
-
-    if (second_slash == string::npos)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". There is only one slash in attribute name"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    auto third_slash = full_attr_name.find('/', second_slash + 1);
-
-    if (third_slash == string::npos)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". There are only two slashes in attribute name"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    auto last_slash = full_attr_name.rfind('/');
-
-    if (last_slash != third_slash)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". Too many slashes provided in attribute name"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    if (first_slash == 0)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". Empty domain"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    if (second_slash - first_slash - 1 == 0)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". Empty family"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
-
-    if (third_slash - second_slash - 1 == 0)
-    {
-        string msg {"Invalid attribute name: " + full_attr_name + ". Empty member"};
-        spdlog::error("Error: {}", msg);
-        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
-    }
+    validate();
 
-    if (third_slash + 1 == full_attr_name.length())
+    const char *error = nullptr;
+
+    if (_slash_count == 0)
+        error = "There is no slash in attribute name";
+    else if (_slash_count == 1)
+        error = "There is only one slash in attribute name";
+    else if (_slash_count == 2)
+        error = "There are only two slashes in attribute name";
+    else if (_slash_count > 3)
+        error = "Too many slashes provided in attribute name";
+    else if (_slashes[0] == _full_begin)
+        error = "Empty domain";
+    else if (_slashes[1] - _slashes[0] - 1 == 0)
+        error = "Empty family";
+    else if (_slashes[2] - _slashes[1] - 1 == 0)
+        error = "Empty member";
+    else if (_slashes[2] + 1 == _fqdn_attr_name.size())
+        error = "Empty name";
+
+    if (error != nullptr)
     {
-        string msg {"Invalid attribute name: " + full_attr_name + ". Empty name"};
+        string msg {"Invalid attribute name: " + fullAttributeName().to_string() + ". " + error};
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
-
-    _domain_cache = full_attr_name.substr(0, first_slash);
-    _family_cache = full_attr_name.substr(first_slash + 1, second_slash - first_slash - 1);
-    _member_cache = full_attr_name.substr(second_slash + 1, third_slash - second_slash - 1);
-    _attribute_name_cache = full_attr_name.substr(third_slash + 1);
 }
 
 //=============================================================================
 //=============================================================================
-void AttributeName::validate()
+void AttributeName::validate() const
 {
     // if the AttributeName is empty, then throw and exception, since
     // it means we just tried to execute a complex operation
@@ -281,28 +215,4 @@ void AttributeName::print(ostream &os) const
     os << "AttributeName(_fqdn_attr_name: " << _fqdn_attr_name << ")";
 }
 
-//=============================================================================
-//=============================================================================
-AttributeName &AttributeName::operator=(const AttributeName &other)
-{
-    // clear the cache
-    clear();
-
-    // now copy the fqdn, we do not copy the cache
-    _fqdn_attr_name = other._fqdn_attr_name;
-    return *this;
-}
-
-//=============================================================================
-//=============================================================================
-AttributeName &AttributeName::operator=(AttributeName &&other) noexcept
-{
-    // clear the cache
-    clear();
-
-    // now copy the fqdn, we do not copy the cache
-    _fqdn_attr_name = move(other._fqdn_attr_name);
-    return *this;
-}
-
 } // namespace hdbpp_internal
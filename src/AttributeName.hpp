@@ -22,41 +22,50 @@
 
 #include "LibUtils.hpp"
 
+#include <cstdint>
+#include <experimental/string_view>
 #include <iostream>
 #include <string>
 
 namespace hdbpp_internal
 {
+// the library is built as C++14, so views are taken with the technical specification
+// string_view, this alias is the single point to change when moving to C++17
+using string_view = std::experimental::string_view;
+
 /// Represents a FQDN for a device server attribute. The AttributeName
 /// class must be primed with a valid fully qualified domain attribute name. From
-/// this name the class can extract various fields for the user. Each field is cached,
-/// so if it is asked for multiple times then it is only extracted once. To not
-/// degrade performance, we return each cached value as a const reference, rather than value.
-/// If the fully qualified domain name is not valid, then the constructor will throw
-/// an exception.
+/// this name the class can extract various fields for the user. The name is split
+/// into its fields in a single pass when it is set, and each field is returned as
+/// a view into the one copy of the name held, so the object makes a single
+/// allocation and is cheap to copy. The views are valid until the name is next set,
+/// cleared or the object destroyed. Only a tango host without a network domain
+/// needs a second string, to hold its resolved name.
+/// If the name does not have a domain, family, member and name, then requesting
+/// any of them will throw an exception.
 class AttributeName
 {
 public:
     // TODO Test all exceptions
 
     AttributeName() = default;
+    AttributeName(const AttributeName &) = default;
     AttributeName(AttributeName &&) = default;
     ~AttributeName() = default;
-    AttributeName(const AttributeName &attr_name) { *this = attr_name; }
     AttributeName(const std::string &fqdn_attr_name);
 
     const std::string &fqdnAttributeName() const noexcept { return _fqdn_attr_name; }
-    const std::string &fullAttributeName();
+    string_view fullAttributeName() const;
 
     // tango host info
-    const std::string &tangoHost();
-    const std::string &tangoHostWithDomain();
+    string_view tangoHost() const;
+    string_view tangoHostWithDomain();
 
     // attribute name elements
-    const std::string &domain();
-    const std::string &family();
-    const std::string &member();
-    const std::string &name();
+    string_view domain() const;
+    string_view family() const;
+    string_view member() const;
+    string_view name() const;
 
     // utility functions
     void set(const std::string &fqdn_attr_name);
@@ -66,36 +75,44 @@ public:
 
     bool operator==(const AttributeName &other) const { return _fqdn_attr_name == other._fqdn_attr_name; }
     bool operator!=(const AttributeName &other) const { return !(_fqdn_attr_name == other._fqdn_attr_name); }
-    AttributeName &operator=(const AttributeName &other);
-    AttributeName &operator=(AttributeName &&other) noexcept;
+    AttributeName &operator=(const AttributeName &other) = default;
+    AttributeName &operator=(AttributeName &&other) = default;
 
 private:
-    // extract the full attribute name, i.e. domain/family/member/name
-    std::string getFullAttributeName(const std::string &fqdn_attr_name);
-
-    // takes the fqdn and breaks out the various component parts, such
-    // as domain, family etc
-    void setDomainFamilyMemberName(const std::string &full_attr_name);
+    // find the offsets of the tango host and each slash of the full attribute
+    // name, in one pass over the fqdn
+    void parse() noexcept;
 
-    // combine the local domain and tango host as a string
-    std::string addDomainToTangoHost(const std::string &tango_host);
+    // view of the fqdn between the offsets
+    string_view view(std::size_t begin, std::size_t end) const noexcept
+    {
+        return string_view {_fqdn_attr_name}.substr(begin, end - begin);
+    }
 
     // check if the AttributeName is empty before executing a complex
     // operation, such as returning the tango host
-    void validate();
+    void validate() const;
+
+    // check the full attribute name has a non empty domain, family, member and
+    // name, before returning one of them
+    void validateElements() const;
 
-    // the fully qualified domain name string
+    // the fully qualified domain name string, every field is a view into it
     std::string _fqdn_attr_name;
 
-    // each string is a cache, and generated only once to save
-    // on performance
-    std::string _full_attribute_name_cache;
-    std::string _tango_host_cache;
-    std::string _tango_host_with_domain_cache;
-    std::string _domain_cache;
-    std::string _family_cache;
-    std::string _member_cache;
-    std::string _attribute_name_cache;
+    // the tango host with the network domain added, only set once resolved for a
+    // tango host that has no domain
+    std::string _tango_host_with_domain;
+
+    // offsets into the fqdn, the tango host is [_host_begin, _host_end), and the full
+    // attribute name runs from _full_begin to the end
+    std::uint32_t _host_begin = 0;
+    std::uint32_t _host_end = 0;
+    std::uint32_t _full_begin = 0;
+
+    // the first three slashes of the full attribute name, and how many it has in all
+    std::uint32_t _slashes[3] = {0, 0, 0};
+    std::uint32_t _slash_count = 0;
 };
 
 } // namespace hdbpp_internal
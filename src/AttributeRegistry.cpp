@@ -0,0 +1,128 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "AttributeRegistry.hpp"
+
+#include "AttributeName.hpp"
+#include "HostResolver.hpp"
+#include "LibUtils.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+using namespace std;
+
+namespace hdbpp_internal
+{
+//=============================================================================
+//=============================================================================
+const AttributeRecord &AttributeRegistry::acquire(const string &fqdn_attr_name, const AttributeTraits &traits)
+{
+    // read before the storage name is built, so a change while building is seen next time
+    auto generation = HostResolver::instance().generation();
+
+    {
+        shared_lock<shared_timed_mutex> lock(_mutex);
+        auto iter = _handles.find(fqdn_attr_name);
+
+        if (iter != _handles.end() && _records[iter->second.handle].traits == traits &&
+            iter->second.host_generation == generation)
+        {
+            return _records[iter->second.handle];
+        }
+    }
+
+    // build the record without holding the lock, the host may have to be resolved
+    AttributeName attr_name {fqdn_attr_name};
+
+    AttributeRecord record;
+    record.fqdn_attr_name = fqdn_attr_name;
+    record.storage_name = "tango://" + attr_name.tangoHostWithDomain().to_string() + "/" +
+        attr_name.fullAttributeName().to_string();
+
+    record.shard = hash<string_view> {}(attr_name.fullAttributeName());
+    record.traits = traits;
+
+    unique_lock<shared_timed_mutex> lock(_mutex);
+
+    // another thread may have registered the attribute while the record was built, under
+    // the same or later host names, or the host names may have changed without changing
+    // this attribute's storage name
+    auto iter = _handles.find(fqdn_attr_name);
+
+    if (iter != _handles.end() && _records[iter->second.handle].traits == traits &&
+        (_records[iter->second.handle].storage_name == record.storage_name ||
+            iter->second.host_generation > generation))
+    {
+        iter->second.host_generation = max(iter->second.host_generation, generation);
+        return _records[iter->second.handle];
+    }
+
+    if (_records.size() == numeric_limits<AttributeHandle>::max())
+    {
+        string msg {"The attribute registry is full. Unable to register attribute: " + fqdn_attr_name};
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+    }
+
+    record.handle = static_cast<AttributeHandle>(_records.size());
+    _records.push_back(move(record));
+    _handles[fqdn_attr_name] = Registration {_records.back().handle, generation};
+
+    spdlog::debug("Registered attribute: {} with handle: {} and storage name: {}",
+        fqdn_attr_name,
+        _records.back().handle,
+        _records.back().storage_name);
+    return _records.back();
+}
+
+//=============================================================================
+//=============================================================================
+const AttributeRecord &AttributeRegistry::record(AttributeHandle handle) const
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+
+    if (handle >= _records.size())
+    {
+        string msg {"Unknown attribute handle: " + to_string(handle)};
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    return _records[handle];
+}
+
+//=============================================================================
+//=============================================================================
+size_t AttributeRegistry::size() const
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+    return _records.size();
+}
+
+//=============================================================================
+//=============================================================================
+void AttributeRegistry::print(ostream &os) const noexcept
+{
+    shared_lock<shared_timed_mutex> lock(_mutex);
+    os << "AttributeRegistry(records: " << _records.size() << ", attributes: " << _handles.size() << ")";
+}
+
+} // namespace hdbpp_internal
@@ -0,0 +1,104 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _ATTRIBUTE_REGISTRY_HPP
+#define _ATTRIBUTE_REGISTRY_HPP
+
+#include "AttributeTraits.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace hdbpp_internal
+{
+// compact handle of a registered attribute, an index into the AttributeRegistry
+using AttributeHandle = std::uint32_t;
+
+// Everything about an attribute that is derived from its name and traits, worked out
+// once when the attribute is registered rather than for every event
+struct AttributeRecord
+{
+    AttributeHandle handle = 0;
+
+    // the name as given to the library
+    std::string fqdn_attr_name;
+
+    // the name the attribute is stored under, with the domain added to the tango host
+    std::string storage_name;
+
+    // hash of the attribute name without the tango host, used to select its writer
+    std::size_t shard = 0;
+
+    AttributeTraits traits;
+};
+
+// The AttributeRegistry interns attributes, giving each a handle and a record of its
+// storage name, writer shard and traits the first time it is seen. Later events find
+// the record with a single lookup, with no parsing or allocation. An attribute seen
+// again with different traits is given a new record, and records are never removed,
+// so a record held by a queued event remains valid for the life of the registry.
+//
+// The storage name holds the canonical name of the tango host, which the HostResolver
+// refreshes in the background. Once the resolver reports a changed name, the storage
+// name of each attribute is built again on its next acquire, and should it differ the
+// attribute is given a new record, as for a change of traits.
+//
+// The conf id is deliberately not part of the record, it stays in the cache of each
+// connection, which is reloaded when the connection is re-established.
+//
+// The class is thread safe.
+class AttributeRegistry
+{
+public:
+    // the record of the attribute, registering it if it is new or its traits have
+    // changed. Throws if the attribute name is empty
+    const AttributeRecord &acquire(const std::string &fqdn_attr_name, const AttributeTraits &traits);
+
+    // the record for a handle returned by acquire()
+    const AttributeRecord &record(AttributeHandle handle) const;
+
+    // number of records held
+    std::size_t size() const;
+
+    void print(std::ostream &os) const noexcept;
+
+private:
+    mutable std::shared_timed_mutex _mutex;
+
+    // a deque does not move its elements as it grows, so references to records stay valid
+    std::deque<AttributeRecord> _records;
+
+    struct Registration
+    {
+        AttributeHandle handle;
+
+        // the HostResolver generation the storage name was last checked under
+        std::uint64_t host_generation;
+    };
+
+    // the latest record of each attribute name
+    std::unordered_map<std::string, Registration> _handles;
+};
+
+} // namespace hdbpp_internal
+#endif // _ATTRIBUTE_REGISTRY_HPP
@@ -0,0 +1,190 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _BATCH_BUFFER_HPP
+#define _BATCH_BUFFER_HPP
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // The BatchBuffer accumulates pre-built data event rows against the table they
+    // are destined for. A table batch is considered ready to flush when it reaches
+    // the configured size, or when its oldest row exceeds the maximum age. The buffer
+    // does no database access itself, the owner decides when and how to flush. The
+    // row type is whatever the flushing method needs, for example a string of values
+    // for a multi-row insert, or a tuple of fields for a COPY stream.
+    template<typename TRow>
+    class BatchBuffer
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        BatchBuffer(std::size_t batch_size, std::chrono::milliseconds max_age);
+
+        // add a row to the batch for the given table, returns true if the batch
+        // for this table is now full and should be flushed
+        bool add(const std::string &table, TRow row);
+
+        // remove and return all the rows batched against the given table
+        std::vector<TRow> take(const std::string &table);
+
+        // all tables that currently have rows waiting
+        std::vector<std::string> tables() const;
+
+        // all tables where the oldest row has been waiting longer than the max age
+        std::vector<std::string> expiredTables(typename Clock::time_point now = Clock::now()) const;
+
+        std::size_t size(const std::string &table) const noexcept;
+        std::size_t size() const noexcept;
+        bool empty() const noexcept { return size() == 0; }
+        void clear() noexcept { _batches.clear(); }
+
+        std::size_t batchSize() const noexcept { return _batch_size; }
+        std::chrono::milliseconds maxAge() const noexcept { return _max_age; }
+
+        void print(std::ostream &os) const noexcept;
+
+    private:
+        struct Batch
+        {
+            std::vector<TRow> rows;
+
+            // time the first row was added, used to age the batch
+            typename Clock::time_point started;
+        };
+
+        std::size_t _batch_size;
+        std::chrono::milliseconds _max_age;
+
+        std::unordered_map<std::string, Batch> _batches;
+    };
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    BatchBuffer<TRow>::BatchBuffer(std::size_t batch_size, std::chrono::milliseconds max_age) :
+        _batch_size(batch_size), _max_age(max_age)
+    {
+        assert(_batch_size > 0);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    bool BatchBuffer<TRow>::add(const std::string &table, TRow row)
+    {
+        auto &batch = _batches[table];
+
+        // an empty batch starts aging from the first row added
+        if (batch.rows.empty())
+        {
+            batch.rows.reserve(_batch_size);
+            batch.started = Clock::now();
+        }
+
+        batch.rows.push_back(std::move(row));
+        return batch.rows.size() >= _batch_size;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    std::vector<TRow> BatchBuffer<TRow>::take(const std::string &table)
+    {
+        auto iter = _batches.find(table);
+
+        if (iter == _batches.end())
+            return {};
+
+        auto rows = std::move(iter->second.rows);
+        _batches.erase(iter);
+        return rows;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    std::vector<std::string> BatchBuffer<TRow>::tables() const
+    {
+        std::vector<std::string> result;
+
+        for (const auto &batch : _batches)
+            if (!batch.second.rows.empty())
+                result.push_back(batch.first);
+
+        return result;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    std::vector<std::string> BatchBuffer<TRow>::expiredTables(typename Clock::time_point now) const
+    {
+        std::vector<std::string> result;
+
+        for (const auto &batch : _batches)
+            if (!batch.second.rows.empty() && now - batch.second.started >= _max_age)
+                result.push_back(batch.first);
+
+        return result;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    std::size_t BatchBuffer<TRow>::size(const std::string &table) const noexcept
+    {
+        auto iter = _batches.find(table);
+        return iter == _batches.end() ? 0 : iter->second.rows.size();
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    std::size_t BatchBuffer<TRow>::size() const noexcept
+    {
+        std::size_t total = 0;
+
+        for (const auto &batch : _batches)
+            total += batch.second.rows.size();
+
+        return total;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TRow>
+    void BatchBuffer<TRow>::print(std::ostream &os) const noexcept
+    {
+        os << "BatchBuffer(tables: " << _batches.size() << ", "
+           << "rows: " << size() << ", "
+           << "_batch_size: " << _batch_size << ", "
+           << "_max_age: " << _max_age.count() << "ms)";
+    }
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _BATCH_BUFFER_HPP
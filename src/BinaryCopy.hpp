@@ -0,0 +1,391 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _BINARY_COPY_HPP
+#define _BINARY_COPY_HPP
+
+#include "AttributeTraits.hpp"
+#include "ValueView.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // This namespace contains an encoder for the postgres binary COPY format. Values
+    // are written in network byte order, in the same form the server receive functions
+    // expect, so there is no text conversion on either side of the connection. See the
+    // COPY "Binary Format" section of the postgres documentation for the layout.
+    namespace binary_copy
+    {
+        // the unsigned types are stored in domains over numeric, the domain oids vary
+        // between databases so are looked up at connect time. They are only required
+        // to encode arrays, which must carry the exact element type
+        struct DomainOids
+        {
+            uint32_t uchar = 0;
+            uint32_t ushort = 0;
+            uint32_t ulong = 0;
+            uint32_t ulong64 = 0;
+        };
+
+        // builtin type oids, these are fixed by postgres
+        const uint32_t BoolOid = 16;
+        const uint32_t Int8Oid = 20;
+        const uint32_t Int2Oid = 21;
+        const uint32_t Int4Oid = 23;
+        const uint32_t TextOid = 25;
+        const uint32_t Float4Oid = 700;
+        const uint32_t Float8Oid = 701;
+
+        // timestamps are sent as microseconds since 2000-01-01 00:00:00 UTC
+        const int64_t PostgresEpochOffset = 946684800;
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendInt16(std::string &out, int16_t value)
+        {
+            auto v = static_cast<uint16_t>(value);
+            out += static_cast<char>(v >> 8);
+            out += static_cast<char>(v);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendInt32(std::string &out, int32_t value)
+        {
+            auto v = static_cast<uint32_t>(value);
+
+            for (int shift = 24; shift >= 0; shift -= 8)
+                out += static_cast<char>(v >> shift);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendInt64(std::string &out, int64_t value)
+        {
+            auto v = static_cast<uint64_t>(value);
+
+            for (int shift = 56; shift >= 0; shift -= 8)
+                out += static_cast<char>(v >> shift);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void patchInt32(std::string &out, std::string::size_type pos, int32_t value)
+        {
+            auto v = static_cast<uint32_t>(value);
+
+            for (int i = 0; i < 4; i++)
+                out[pos + i] = static_cast<char>(v >> (24 - i * 8));
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendNumeric(std::string &out, uint64_t value)
+        {
+            // numeric is sent as base 10000 digits, most significant first, with
+            // the weight being the power of 10000 of the first digit
+            int16_t digits[5];
+            int16_t count = 0;
+
+            for (; value != 0; value /= 10000)
+                digits[count++] = static_cast<int16_t>(value % 10000);
+
+            // trailing zero digits are implied by the weight and need not be sent
+            auto first = 0;
+
+            while (first < count && digits[first] == 0)
+                first++;
+
+            appendInt16(out, static_cast<int16_t>(count - first));
+            appendInt16(out, static_cast<int16_t>(count == 0 ? 0 : count - 1));
+            appendInt16(out, 0); // sign positive
+            appendInt16(out, 0); // display scale
+
+            for (auto i = count - 1; i >= first; i--)
+                appendInt16(out, digits[i]);
+        }
+
+        // Encode a single value of type T, without its length prefix, and report the
+        // oid of the type for use as an array element type
+        template<typename T>
+        struct Encode;
+
+        template<>
+        struct Encode<bool>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return BoolOid; }
+            static void run(std::string &out, bool value) { out += static_cast<char>(value ? 1 : 0); }
+        };
+
+        template<>
+        struct Encode<int16_t>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Int2Oid; }
+            static void run(std::string &out, int16_t value) { appendInt16(out, value); }
+        };
+
+        template<>
+        struct Encode<int32_t>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Int4Oid; }
+            static void run(std::string &out, int32_t value) { appendInt32(out, value); }
+        };
+
+        template<>
+        struct Encode<int64_t>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Int8Oid; }
+            static void run(std::string &out, int64_t value) { appendInt64(out, value); }
+        };
+
+        template<>
+        struct Encode<float>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Float4Oid; }
+
+            static void run(std::string &out, float value)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                appendInt32(out, static_cast<int32_t>(bits));
+            }
+        };
+
+        template<>
+        struct Encode<double>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Float8Oid; }
+
+            static void run(std::string &out, double value)
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                appendInt64(out, static_cast<int64_t>(bits));
+            }
+        };
+
+        template<>
+        struct Encode<uint8_t>
+        {
+            static uint32_t oid(const DomainOids &oids) { return oids.uchar; }
+            static void run(std::string &out, uint8_t value) { appendNumeric(out, value); }
+        };
+
+        template<>
+        struct Encode<uint16_t>
+        {
+            static uint32_t oid(const DomainOids &oids) { return oids.ushort; }
+            static void run(std::string &out, uint16_t value) { appendNumeric(out, value); }
+        };
+
+        template<>
+        struct Encode<uint32_t>
+        {
+            static uint32_t oid(const DomainOids &oids) { return oids.ulong; }
+            static void run(std::string &out, uint32_t value) { appendNumeric(out, value); }
+        };
+
+        template<>
+        struct Encode<uint64_t>
+        {
+            static uint32_t oid(const DomainOids &oids) { return oids.ulong64; }
+            static void run(std::string &out, uint64_t value) { appendNumeric(out, value); }
+        };
+
+        // DevState is stored as an int4
+        template<>
+        struct Encode<Tango::DevState>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return Int4Oid; }
+            static void run(std::string &out, Tango::DevState value) { appendInt32(out, static_cast<int32_t>(value)); }
+        };
+
+        // text is sent as is, no escaping is required in the binary format
+        template<>
+        struct Encode<std::string>
+        {
+            static uint32_t oid(const DomainOids & /*unused*/) { return TextOid; }
+            static void run(std::string &out, const std::string &value) { out += value; }
+        };
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendNull(std::string &out) { appendInt32(out, -1); }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendField(std::string &out, const T &value)
+        {
+            // reserve the length and fill it in once the value is written, since
+            // some types (numeric, text) are variable length
+            auto length_pos = out.size();
+            appendInt32(out, 0);
+            Encode<T>::run(out, value);
+            patchInt32(out, length_pos, static_cast<int32_t>(out.size() - length_pos - 4));
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T, typename TIter>
+        void appendArrayField(std::string &out, TIter first, TIter last, const DomainOids &oids)
+        {
+            auto length_pos = out.size();
+            appendInt32(out, 0);
+
+            // a single dimension array with no nulls, lower bound 1
+            appendInt32(out, 1);
+            appendInt32(out, 0);
+            appendInt32(out, static_cast<int32_t>(Encode<T>::oid(oids)));
+            appendInt32(out, static_cast<int32_t>(std::distance(first, last)));
+            appendInt32(out, 1);
+
+            // each element is written as a field, so vector<bool> is handled by its
+            // conversion to bool here
+            for (; first != last; ++first)
+            {
+                T value = *first;
+                appendField(out, value);
+            }
+
+            patchInt32(out, length_pos, static_cast<int32_t>(out.size() - length_pos - 4));
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendArrayField(std::string &out, const std::vector<T> &values, const DomainOids &oids)
+        {
+            appendArrayField<T>(out, values.begin(), values.end(), oids);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendTimestampField(std::string &out, double event_time)
+        {
+            appendInt32(out, 8);
+            appendInt64(out, std::llround(event_time * 1.0e6) - PostgresEpochOffset * 1000000);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendHeader(std::string &out)
+        {
+            // signature, flags and header extension length
+            out.append("PGCOPY\n\377\r\n\0", 11);
+            appendInt32(out, 0);
+            appendInt32(out, 0);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        inline void appendTrailer(std::string &out) { appendInt16(out, -1); }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendValueField(std::string &out,
+            bool has_data,
+            std::unique_ptr<std::vector<T>> &value,
+            const AttributeTraits &traits,
+            const DomainOids &oids)
+        {
+            if (!has_data || !value || value->empty())
+                appendNull(out);
+            else if (traits.isScalar())
+            {
+                T v = (*value)[0];
+                appendField(out, v);
+            }
+            else
+                appendArrayField(out, *value, oids);
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendValueField(std::string &out,
+            bool has_data,
+            const ValueView<T> &value,
+            const AttributeTraits &traits,
+            const DomainOids &oids)
+        {
+            if (!has_data || value.empty())
+                appendNull(out);
+            else if (traits.isScalar())
+                appendField(out, value[0]);
+            else
+                appendArrayField<T>(out, value.begin(), value.end(), oids);
+        }
+
+        // Builds a single tuple for a data event, the fields match the columns given by
+        // QueryBuilder::storeDataEventCopyColumns(). As with the text COPY rows, both value
+        // fields are always present and null when there is no data
+        template<typename T>
+        std::string dataEventTuple(int conf_id,
+            double event_time,
+            int quality,
+            std::unique_ptr<std::vector<T>> &value_r,
+            std::unique_ptr<std::vector<T>> &value_w,
+            const AttributeTraits &traits,
+            const DomainOids &oids)
+        {
+            std::string tuple;
+
+            appendInt16(tuple, 5);
+            appendField(tuple, static_cast<int32_t>(conf_id));
+            appendTimestampField(tuple, event_time);
+            appendValueField(tuple, traits.hasReadData(), value_r, traits, oids);
+            appendValueField(tuple, traits.hasWriteData(), value_w, traits, oids);
+            appendField(tuple, static_cast<int16_t>(quality));
+            return tuple;
+        }
+
+        // As dataEventTuple(), but the values are encoded straight from the views and the
+        // tuple is appended to the given buffer, so nothing is copied ahead of the encoding
+        template<typename T>
+        void appendDataEventTuple(std::string &out,
+            int conf_id,
+            double event_time,
+            int quality,
+            const ValueView<T> &value_r,
+            const ValueView<T> &value_w,
+            const AttributeTraits &traits,
+            const DomainOids &oids)
+        {
+            appendInt16(out, 5);
+            appendField(out, static_cast<int32_t>(conf_id));
+            appendTimestampField(out, event_time);
+            appendValueField(out, traits.hasReadData(), value_r, traits, oids);
+            appendValueField(out, traits.hasWriteData(), value_w, traits, oids);
+            appendField(out, static_cast<int16_t>(quality));
+        }
+    } // namespace binary_copy
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _BINARY_COPY_HPP
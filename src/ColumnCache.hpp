@@ -25,25 +25,40 @@
 #include "QueryBuilder.hpp"
 
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <pqxx/pqxx>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace hdbpp_internal
 {
 namespace pqxx_conn
 {
+    // References found missing from the database are remembered for a short time, so
+    // repeated requests for a reference that does not exist, such as events for an
+    // attribute that is not configured, do not each query the database. The missing
+    // references are bounded in number, and forgotten when a value is cached for them,
+    // or the cache is cleared or reloaded.
     template<typename TValue, typename TRef>
     class ColumnCache
     {
     public:
+        static const std::size_t DefaultMissingCapacity = 10000;
+        static constexpr std::chrono::milliseconds DefaultMissingTtl = std::chrono::seconds(5);
+
         ColumnCache(std::shared_ptr<pqxx::connection> conn,
             std::string table_name,
             std::string column_name,
-            std::string reference);
+            std::string reference,
+            std::size_t missing_capacity = DefaultMissingCapacity,
+            std::chrono::milliseconds missing_ttl = DefaultMissingTtl);
 
         // query if the reference has a value, if its not cached it will be
-        // loaded from the database
+        // loaded from the database. A reference recently found missing is reported
+        // missing without querying the database again
         bool valueExists(const TRef &reference);
 
         // get the value associated with the reference, throws and exception if it does not
@@ -55,12 +70,23 @@ namespace pqxx_conn
         // cache a value in the internal maps
         void cacheValue(const TValue &value, const TRef &reference);
 
-        // fetch all values from the database and cache them for future look up
+        // fetch all values from the database and cache them for future look up, the
+        // table is streamed in with a single COPY
         void fetchAll();
 
+        // forget that the reference was found missing, so the next request for it
+        // queries the database
+        void forgetMissing(const TRef &reference) { _missing.erase(reference); }
+
         // utility functions
-        void clear() noexcept { _values.clear(); }
+        void clear() noexcept
+        {
+            _values.clear();
+            _missing.clear();
+        }
+
         int size() const noexcept { return _values.size(); }
+        int missingSize() const noexcept { return _missing.size(); }
         void print(std::ostream &os) const noexcept;
 
     private:
@@ -72,35 +98,48 @@ namespace pqxx_conn
         std::string _column_name;
         std::string _reference;
 
-        // prepared query names for this cache, used to lookup
-        // prepared statements
-        std::string _fetch_all_query_name;
+        // prepared query name for this cache, used to lookup
+        // the prepared statement
         std::string _fetch_id_query_name;
 
+        // remember the reference was found missing from the database
+        void cacheMissing(const TRef &reference);
+
         // cache of values to a reference, the unordered map is not sorted
         // so we do not loose time on each insert having it resorted
         std::unordered_map<TRef, TValue> _values;
+
+        // references found missing, and when each should be looked up again
+        std::unordered_map<TRef, std::chrono::steady_clock::time_point> _missing;
+        std::size_t _missing_capacity;
+        std::chrono::milliseconds _missing_ttl;
     };
 
+    template<typename TValue, typename TRef>
+    constexpr std::chrono::milliseconds ColumnCache<TValue, TRef>::DefaultMissingTtl;
+
     //=============================================================================
     //=============================================================================
     template<typename TValue, typename TRef>
     ColumnCache<TValue, TRef>::ColumnCache(std::shared_ptr<pqxx::connection> conn,
         std::string table_name,
         std::string column_name,
-        std::string reference) :
+        std::string reference,
+        std::size_t missing_capacity,
+        std::chrono::milliseconds missing_ttl) :
         _conn(std::move(conn)),
         _table_name(std::move(table_name)),
         _column_name(std::move(column_name)),
-        _reference(std::move(reference))
+        _reference(std::move(reference)),
+        _missing_capacity(missing_capacity),
+        _missing_ttl(missing_ttl)
     {
         assert(_conn != nullptr);
         assert(!_table_name.empty());
         assert(!_column_name.empty());
         assert(!_reference.empty());
 
-        // create the query names
-        _fetch_all_query_name = _column_name + _table_name + _reference + "_all";
+        // create the query name
         _fetch_id_query_name = _column_name + _table_name + _reference + "_id";
 
         spdlog::trace("Cache created for table: {} using columns {}/{}", _table_name, _column_name, _reference);
@@ -120,24 +159,23 @@ namespace pqxx_conn
         try
         {
             pqxx::perform([this]() {
-                // request the entire table, since we will cache it fully
+                // a retried attempt starts over
+                _values.clear();
+
+                // stream the entire table in a single COPY, rather than a query result
+                // holding every row at once, since we will cache it fully
                 pqxx::work tx {*(_conn.get()), FetchAllValues};
+                pqxx::stream_from stream {tx, _table_name, std::vector<std::string> {_column_name, _reference}};
 
-                if (!tx.prepared(_fetch_all_query_name).exists())
-                {
-                    tx.conn().prepare(_fetch_all_query_name,
-                        QueryBuilder::fetchAllValuesStatement(_column_name, _table_name, _reference));
+                std::tuple<TValue, TRef> row;
 
-                    spdlog::trace("Created prepared statement for: {}", _fetch_all_query_name);
-                }
+                // load each value from the table into the cache
+                while (stream >> row)
+                    _values.insert({std::move(std::get<1>(row)), std::get<0>(row)});
 
-                auto result = tx.exec_prepared(_fetch_all_query_name);
+                stream.complete();
                 tx.commit();
 
-                // load each value from the table into the cache
-                for (const auto &row : result)
-                    _values.insert({row[1].template as<TRef>(), row[0].template as<TValue>()});
-
                 spdlog::debug("Loaded: {} values into cache", _values.size());
             });
         }
@@ -168,10 +206,21 @@ namespace pqxx_conn
         // not found, search the database
         if (value_iter == _values.end())
         {
+            // unless it was recently found missing from the database
+            auto missing_iter = _missing.find(reference);
+
+            if (missing_iter != _missing.end())
+            {
+                if (std::chrono::steady_clock::now() < missing_iter->second)
+                    return false;
+
+                _missing.erase(missing_iter);
+            }
+
             try
             {
                 // the value is not loaded, so next step is to check the database
-                return pqxx::perform([this, &reference]() {
+                auto found = pqxx::perform([this, &reference]() {
                     // lookup the value
                     pqxx::work tx {(*_conn), FetchValue};
 
@@ -211,6 +260,11 @@ namespace pqxx_conn
 
                     return value_exists;
                 });
+
+                if (!found)
+                    cacheMissing(reference);
+
+                return found;
             }
             catch (const pqxx::pqxx_exception &ex)
             {
@@ -265,15 +319,46 @@ namespace pqxx_conn
         }
 
         _values.insert({reference, value});
+        _missing.erase(reference);
         spdlog::debug("Cached new value: {} with reference: {} by request", value, reference);
     }
 
+    //=============================================================================
+    //=============================================================================
+    template<typename TValue, typename TRef>
+    void ColumnCache<TValue, TRef>::cacheMissing(const TRef &reference)
+    {
+        if (_missing_capacity == 0)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+
+        // make room by dropping the expired references first, and should they all
+        // still be fresh, any one of them
+        if (_missing.size() >= _missing_capacity)
+        {
+            for (auto iter = _missing.begin(); iter != _missing.end();)
+                iter = now < iter->second ? std::next(iter) : _missing.erase(iter);
+
+            if (_missing.size() >= _missing_capacity)
+                _missing.erase(_missing.begin());
+        }
+
+        _missing[reference] = now + _missing_ttl;
+
+        spdlog::debug("Reference: {} is missing from table: {}, it will not be looked up again for {}ms",
+            reference,
+            _table_name,
+            _missing_ttl.count());
+    }
+
     //=============================================================================
     //=============================================================================
     template<typename TValue, typename TRef>
     void ColumnCache<TValue, TRef>::print(std::ostream &os) const noexcept
     {
         os << "ColumnCache(size: " << _values.size() << ", "
+           << "missing: " << _missing.size() << ", "
            << "_table_name: " << _table_name << ", "
            << "_column_name: " << _column_name << ", "
            << "_reference: " << _reference << ")";
@@ -0,0 +1,399 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _COLUMNAR_SERIES_HPP
+#define _COLUMNAR_SERIES_HPP
+
+#include "DataEventChunk.hpp"
+#include "LibUtils.hpp"
+#include "spdlog/spdlog.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace hdbpp_internal
+{
+namespace columnar_utils
+{
+    // Allocates buffers on the 64 byte boundary Apache Arrow recommends, so they can be
+    // handed to Arrow, or numpy, as they are
+    template<typename T>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+
+        static const std::size_t Alignment = 64;
+
+        AlignedAllocator() = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U> & /*unused*/) noexcept
+        {}
+
+        T *allocate(std::size_t count)
+        {
+            void *memory = nullptr;
+
+            if (posix_memalign(&memory, Alignment, count * sizeof(T)) != 0)
+                throw std::bad_alloc();
+
+            return static_cast<T *>(memory);
+        }
+
+        void deallocate(T *memory, std::size_t /*unused*/) noexcept { free(memory); }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U> & /*unused*/) const noexcept
+        {
+            return true;
+        }
+
+        template<typename U>
+        bool operator!=(const AlignedAllocator<U> & /*unused*/) const noexcept
+        {
+            return false;
+        }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    // A bitmap in the Arrow bit order, bit i is bit (i % 8) of byte (i / 8)
+    class Bitmap
+    {
+    public:
+        void append(bool value)
+        {
+            if (_size % 8 == 0)
+                _bytes.push_back(0);
+
+            if (value)
+                _bytes.back() |= static_cast<uint8_t>(1 << (_size % 8));
+
+            _size++;
+        }
+
+        bool operator[](std::size_t index) const noexcept { return (_bytes[index / 8] >> (index % 8)) & 1; }
+
+        std::size_t size() const noexcept { return _size; }
+        const uint8_t *data() const noexcept { return _bytes.data(); }
+
+    private:
+        AlignedVector<uint8_t> _bytes;
+        std::size_t _size = 0;
+    };
+
+    // This function returns the Arrow C data interface format string for the elements
+    // of a series, it is specialized for all the types a series can hold
+    template<typename T>
+    const char *arrowFormat();
+
+    template<>
+    inline const char *arrowFormat<bool>()
+    {
+        return "b";
+    }
+
+    template<>
+    inline const char *arrowFormat<int16_t>()
+    {
+        return "s";
+    }
+
+    template<>
+    inline const char *arrowFormat<int32_t>()
+    {
+        return "i";
+    }
+
+    template<>
+    inline const char *arrowFormat<int64_t>()
+    {
+        return "l";
+    }
+
+    template<>
+    inline const char *arrowFormat<float>()
+    {
+        return "f";
+    }
+
+    template<>
+    inline const char *arrowFormat<double>()
+    {
+        return "g";
+    }
+
+    template<>
+    inline const char *arrowFormat<uint8_t>()
+    {
+        return "C";
+    }
+
+    template<>
+    inline const char *arrowFormat<uint16_t>()
+    {
+        return "S";
+    }
+
+    template<>
+    inline const char *arrowFormat<uint32_t>()
+    {
+        return "I";
+    }
+
+    template<>
+    inline const char *arrowFormat<uint64_t>()
+    {
+        return "L";
+    }
+
+    template<>
+    inline const char *arrowFormat<std::string>()
+    {
+        return "u";
+    }
+
+    // DevState is held as its integer value
+    template<>
+    inline const char *arrowFormat<Tango::DevState>()
+    {
+        return "i";
+    }
+
+    // The element values of a series as a fixed width Arrow buffer. Every row has a
+    // slot, including null scalar rows, as Arrow expects
+    template<typename T>
+    class ValueBuffer
+    {
+    public:
+        // enums are held as their integer value
+        using Stored = typename std::conditional<std::is_enum<T>::value, int32_t, T>::type;
+
+        void append(const T &value) { _values.push_back(static_cast<Stored>(value)); }
+        void appendEmpty() { _values.emplace_back(); }
+
+        std::size_t size() const noexcept { return _values.size(); }
+        const void *data() const noexcept { return _values.data(); }
+        const int32_t *offsets() const noexcept { return nullptr; }
+
+    private:
+        AlignedVector<Stored> _values;
+    };
+
+    // Arrow packs bools into a bitmap
+    template<>
+    class ValueBuffer<bool>
+    {
+    public:
+        void append(bool value) { _values.append(value); }
+        void appendEmpty() { _values.append(false); }
+
+        std::size_t size() const noexcept { return _values.size(); }
+        const void *data() const noexcept { return _values.data(); }
+        const int32_t *offsets() const noexcept { return nullptr; }
+
+    private:
+        Bitmap _values;
+    };
+
+    // Strings are an Arrow utf8 array, their characters end to end with the offset of
+    // each string, plus a final offset for the end of the last
+    template<>
+    class ValueBuffer<std::string>
+    {
+    public:
+        void append(const std::string &value)
+        {
+            _chars.insert(_chars.end(), value.begin(), value.end());
+            _offsets.push_back(static_cast<int32_t>(_chars.size()));
+        }
+
+        void appendEmpty() { _offsets.push_back(static_cast<int32_t>(_chars.size())); }
+
+        std::size_t size() const noexcept { return _offsets.size() - 1; }
+        const void *data() const noexcept { return _chars.data(); }
+        const int32_t *offsets() const noexcept { return _offsets.data(); }
+
+    private:
+        AlignedVector<char> _chars;
+        AlignedVector<int32_t> _offsets {0};
+    };
+
+    // Convert an event time, in seconds since the epoch, to the nanoseconds of an Arrow
+    // timestamp. Event times are stored to the microsecond, so are rounded to it first
+    inline int64_t toNanoseconds(double event_time) noexcept
+    {
+        return static_cast<int64_t>(std::llround(event_time * 1.0e6)) * 1000;
+    }
+} // namespace columnar_utils
+
+// A ColumnarSeries holds the values of an attribute over time as a struct of arrays,
+// laid out as the buffers of an Apache Arrow record batch, so they can be shared with
+// Arrow, numpy or pandas without a copy. There is a timestamp column, in nanoseconds
+// since the epoch (Arrow format "tsn:UTC"), and a value column. The value column has a
+// validity bitmap, a row is null when the event has no value or its quality is
+// invalid. Scalar attributes have one element per row. For spectrum and image
+// attributes each row is an Arrow list ("+l"), with offsets() giving the first element
+// of each row in the values, and images are flattened. Every buffer is 64 byte aligned.
+//
+// This base class gives access to the buffers whatever the element type, which is
+// described by valueFormat()
+class ColumnarSeriesBase
+{
+public:
+    virtual ~ColumnarSeriesBase() = default;
+
+    ColumnarSeriesBase(const ColumnarSeriesBase &) = delete;
+    ColumnarSeriesBase &operator=(const ColumnarSeriesBase &) = delete;
+
+    // number of rows, and how many of them are null
+    std::size_t size() const noexcept { return _timestamps.size(); }
+    std::size_t nullCount() const noexcept { return _null_count; }
+
+    // true when each row is a list of elements
+    bool isList() const noexcept { return _is_list; }
+
+    // the timestamp of each row
+    const int64_t *timestamps() const noexcept { return _timestamps.data(); }
+
+    // one bit per row, set when the row is valid
+    const uint8_t *validity() const noexcept { return _validity.data(); }
+    bool isValid(std::size_t row) const noexcept { return _validity[row]; }
+
+    // for a list, size() + 1 offsets into the elements of the values, null otherwise
+    const int32_t *offsets() const noexcept { return _is_list ? _offsets.data() : nullptr; }
+
+    // the Arrow format of the value elements
+    virtual const char *valueFormat() const noexcept = 0;
+
+    // the number of value elements, and their buffer. Bools are a bitmap, and strings
+    // are their characters end to end
+    virtual std::size_t valueCount() const noexcept = 0;
+    virtual const void *valueData() const noexcept = 0;
+
+    // for strings, valueCount() + 1 offsets of each string into the characters, null
+    // for any other type
+    virtual const int32_t *valueOffsets() const noexcept = 0;
+
+protected:
+    explicit ColumnarSeriesBase(bool is_list) : _is_list(is_list)
+    {
+        if (_is_list)
+            _offsets.push_back(0);
+    }
+
+    // record a row, its timestamp and validity, and the element count the values of a
+    // list have reached after it
+    void appendRow(int64_t timestamp, bool valid, std::size_t value_count)
+    {
+        _timestamps.push_back(timestamp);
+        _validity.append(valid);
+
+        if (!valid)
+            _null_count++;
+
+        if (_is_list)
+        {
+            if (value_count > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+            {
+                std::string msg {"The series has more elements than can be offset by 32 bits: " +
+                    std::to_string(value_count)};
+
+                spdlog::error("Error: {}", msg);
+                Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+            }
+
+            _offsets.push_back(static_cast<int32_t>(value_count));
+        }
+    }
+
+private:
+    bool _is_list;
+    std::size_t _null_count = 0;
+
+    columnar_utils::AlignedVector<int64_t> _timestamps;
+    columnar_utils::Bitmap _validity;
+    columnar_utils::AlignedVector<int32_t> _offsets;
+};
+
+// The series for values of type T
+template<typename T>
+class ColumnarSeries : public ColumnarSeriesBase
+{
+public:
+    explicit ColumnarSeries(bool is_list) : ColumnarSeriesBase(is_list) {}
+
+    // append a single event, it is stored as a null row when it has no values or its
+    // quality is invalid
+    template<typename TIter>
+    void append(int64_t timestamp, int quality, TIter begin, TIter end)
+    {
+        auto valid = begin != end && quality != Tango::ATTR_INVALID;
+
+        if (isList())
+        {
+            if (valid)
+                for (auto iter = begin; iter != end; ++iter)
+                    _values.append(*iter);
+        }
+        else if (valid)
+            _values.append(*begin);
+        else
+            _values.appendEmpty();
+
+        appendRow(timestamp, valid, _values.size());
+    }
+
+    void append(int64_t timestamp, int quality, const std::vector<T> &values)
+    {
+        append(timestamp, quality, values.begin(), values.end());
+    }
+
+    // append the read, or write, values of every event in a chunk
+    void append(const DataEventChunk<T> &chunk, bool write_values = false)
+    {
+        const auto &values = write_values ? chunk.value_w : chunk.value_r;
+        const auto &offsets = write_values ? chunk.value_w_offsets : chunk.value_r_offsets;
+
+        for (std::size_t i = 0; i < chunk.size(); i++)
+        {
+            append(columnar_utils::toNanoseconds(chunk.data_time[i]),
+                chunk.quality[i],
+                values.begin() + offsets[i],
+                values.begin() + offsets[i + 1]);
+        }
+    }
+
+    const char *valueFormat() const noexcept override { return columnar_utils::arrowFormat<T>(); }
+    std::size_t valueCount() const noexcept override { return _values.size(); }
+    const void *valueData() const noexcept override { return _values.data(); }
+    const int32_t *valueOffsets() const noexcept override { return _values.offsets(); }
+
+private:
+    columnar_utils::ValueBuffer<T> _values;
+};
+} // namespace hdbpp_internal
+#endif // _COLUMNAR_SERIES_HPP
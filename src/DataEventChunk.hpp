@@ -0,0 +1,73 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _DATA_EVENT_CHUNK_HPP
+#define _DATA_EVENT_CHUNK_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// A DataEventChunk holds a run of archived data events for a single attribute, as
+// fetched from the database, in columns rather than rows. The values of every event
+// are held end to end in a single column, with a column of offsets marking where the
+// values of each event begin, so neither scalars nor arrays need an allocation per
+// event. Row i of the chunk is made up of element i of the data_time and quality
+// columns, and the values from offset i up to offset i + 1. Events are ordered by time.
+template<typename T>
+struct DataEventChunk
+{
+    // number of events in the chunk
+    std::size_t size() const noexcept { return data_time.size(); }
+    bool empty() const noexcept { return data_time.empty(); }
+
+    // empty every column, keeping their allocations for the next chunk
+    void clear() noexcept
+    {
+        data_time.clear();
+        quality.clear();
+        value_r.clear();
+        value_w.clear();
+
+        // the leading offset of zero is kept
+        value_r_offsets.resize(1);
+        value_w_offsets.resize(1);
+    }
+
+    // the number of read, or write, values of row i, a single value for a scalar
+    // attribute, and none when the event had none, for example an error event
+    std::size_t readCount(std::size_t row) const noexcept { return value_r_offsets[row + 1] - value_r_offsets[row]; }
+    std::size_t writeCount(std::size_t row) const noexcept { return value_w_offsets[row + 1] - value_w_offsets[row]; }
+
+    // event times, in seconds since the epoch as they were stored
+    std::vector<double> data_time;
+    std::vector<int> quality;
+
+    // the values of every event end to end
+    std::vector<T> value_r;
+    std::vector<T> value_w;
+
+    // size() + 1 offsets into the values, the first value of each event followed by
+    // the end of the last
+    std::vector<std::size_t> value_r_offsets {0};
+    std::vector<std::size_t> value_w_offsets {0};
+};
+} // namespace hdbpp_internal
+#endif // _DATA_EVENT_CHUNK_HPP
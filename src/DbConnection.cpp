@@ -22,8 +22,11 @@
 #include "LibUtils.hpp"
 
 #include <cassert>
+#include <chrono>
 #include <experimental/optional>
 #include <iostream>
+#include <thread>
+#include <unordered_map>
 
 using namespace std;
 
@@ -31,9 +34,49 @@ namespace hdbpp_internal
 {
 namespace pqxx_conn
 {
+    namespace
+    {
+        // defaults for the CopyStream method, which is always batched
+        const std::size_t CopyBatchSize = 1000;
+        const std::chrono::milliseconds CopyFlushInterval {1000};
+
+        // limits of the delay between reconnection attempts
+        const std::chrono::milliseconds ReconnectMinBackoff {100};
+        const std::chrono::milliseconds ReconnectMaxBackoff {30000};
+
+        // least time the pipeline waits on the server before its connection is taken as
+        // lost, so a server that is only busy is not mistaken for one that is gone
+        const std::chrono::milliseconds PipelineMinTimeout {10000};
+
+        // limits of the chunk interval set by resizeChunkIntervals()
+        const std::chrono::seconds MinChunkInterval {std::chrono::hours(1)};
+        const std::chrono::seconds MaxChunkInterval {std::chrono::hours(24 * 365)};
+
+        // time between runs of the retention once enabled
+        const std::chrono::hours RetentionInterval {1};
+
+        // span of events materialized into a new rollup by each flush(), a multiple of
+        // every rollup bucket so slices meet on bucket boundaries
+        const std::chrono::seconds RollupFillSlice {std::chrono::hours(24 * 7)};
+    } // namespace
+
     //=============================================================================
     //=============================================================================
-    DbConnection::DbConnection(DbStoreMethod db_store_method) : _db_store_method(db_store_method) {}
+    DbConnection::DbConnection(DbStoreMethod db_store_method) : _db_store_method(db_store_method)
+    {
+        if (_db_store_method == DbStoreMethod::CopyStream)
+            _copy_buffer = make_unique<BatchBuffer<BatchedEvent<CopyRow>>>(CopyBatchSize, CopyFlushInterval);
+
+        if (_db_store_method == DbStoreMethod::CopyBinary)
+        {
+            _binary_buffer = make_unique<BatchBuffer<BatchedEvent<std::string>>>(CopyBatchSize, CopyFlushInterval);
+            _libpq_conn = make_unique<LibpqConnection>();
+            _libpq_required = true;
+        }
+
+        if (_db_store_method == DbStoreMethod::Pipeline)
+            _libpq_conn = make_unique<LibpqConnection>();
+    }
 
     //=============================================================================
     //=============================================================================
@@ -52,6 +95,25 @@ namespace pqxx_conn
             // lifetime between objects
             _conn = make_shared<pqxx::connection>(connect_string);
 
+            // the results of events still in the pipeline are lost with the connection
+            if (!_pipelined.empty())
+                journalPipeline("The connection was replaced");
+
+            // the binary copy and pipeline are sent over their own native connection
+            if (_libpq_conn)
+                _libpq_conn->connect(connect_string);
+
+            // statements are prepared per connection, so must be prepared again
+            if (_statements.empty())
+                _statements.build(_query_builder);
+
+            _statements.resetRegistration();
+
+            // temporary tables do not outlive the connection that created them
+            _staging_tables.clear();
+
+            _connection_string = connect_string;
+
             // mark the connected flag as true to cache this state
             _connected = true;
             spdlog::info("Connected to postgres successfully");
@@ -77,6 +139,31 @@ namespace pqxx_conn
 
         _event_id_cache = make_unique<ColumnCache<int, std::string>>(
             _conn, schema::HistoryEventTableName, schema::HistoryEventColEventId, schema::HistoryEventColEvent);
+
+        if (_cache_warmup)
+            warmCaches();
+
+        if (_db_store_method == DbStoreMethod::CopyBinary)
+            fetchDomainOids();
+
+        fetchPackedTables();
+
+        if (_db_store_method == DbStoreMethod::Pipeline)
+        {
+            if (_libpq_conn->pipelineSupported())
+            {
+                _libpq_conn->enterPipelineMode();
+                _libpq_required = true;
+                spdlog::info("Data events will be stored in pipeline mode");
+            }
+            else
+            {
+                // without the native connection data events take the prepared statement path
+                spdlog::warn("Pipeline mode requires postgres 14 or later, falling back to prepared statements");
+                _libpq_conn->disconnect();
+                _libpq_required = false;
+            }
+        }
     }
 
     //=============================================================================
@@ -88,6 +175,31 @@ namespace pqxx_conn
         assert(_error_desc_id_cache != nullptr);
         assert(_event_id_cache != nullptr);
 
+        // attempt to store any batched events before closing, there is nothing more
+        // we can do with them if this fails, so log the loss and carry on
+        if (isOpen())
+        {
+            try
+            {
+                flush();
+            }
+            catch (const Tango::DevFailed &)
+            {
+                spdlog::error("Error: Failed to store batched data events on disconnect, {} events discarded",
+                    (_batch_buffer ? _batch_buffer->size() : 0) + (_copy_buffer ? _copy_buffer->size() : 0) +
+                        (_binary_buffer ? _binary_buffer->size() : 0));
+
+                if (_batch_buffer)
+                    _batch_buffer->clear();
+
+                if (_copy_buffer)
+                    _copy_buffer->clear();
+
+                if (_binary_buffer)
+                    _binary_buffer->clear();
+            }
+        }
+
         _conf_id_cache->clear();
         _error_desc_id_cache->clear();
         _event_id_cache->clear();
@@ -95,11 +207,112 @@ namespace pqxx_conn
         // disconnect as requested, this will stop access to all functions
         _conn->disconnect();
 
+        if (_libpq_conn)
+            _libpq_conn->disconnect();
+
         // stop attempts to use the connection
         _connected = false;
         spdlog::debug("Disconnected from the postgres database");
     }
 
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::enableBatching(std::size_t batch_size, std::chrono::milliseconds max_age)
+    {
+        // do not lose events batched under the previous configuration
+        if (isOpen())
+            flush();
+
+        if (_db_store_method == DbStoreMethod::CopyStream || _db_store_method == DbStoreMethod::CopyBinary)
+        {
+            if (batch_size == 0)
+            {
+                batch_size = CopyBatchSize;
+                max_age = CopyFlushInterval;
+            }
+
+            if (_db_store_method == DbStoreMethod::CopyStream)
+                _copy_buffer = make_unique<BatchBuffer<BatchedEvent<CopyRow>>>(batch_size, max_age);
+            else
+                _binary_buffer = make_unique<BatchBuffer<BatchedEvent<std::string>>>(batch_size, max_age);
+
+            spdlog::info("Copy batch size: {} and flush interval: {}ms", batch_size, max_age.count());
+            return;
+        }
+
+        if (batch_size == 0)
+        {
+            _batch_buffer.reset();
+            spdlog::info("Data event batching disabled");
+            return;
+        }
+
+        _batch_buffer = make_unique<BatchBuffer<BatchedEvent<std::string>>>(batch_size, max_age);
+        spdlog::info("Data event batching enabled with batch size: {} and max age: {}ms", batch_size, max_age.count());
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::flush()
+    {
+        if (!_pipelined.empty())
+            collectPipeline(true);
+
+        if ((_batch_buffer && !_batch_buffer->empty()) || (_copy_buffer && !_copy_buffer->empty()) ||
+            (_binary_buffer && !_binary_buffer->empty()))
+        {
+            checkConnection(LOCATION_INFO);
+
+            if (_batch_buffer)
+                for (auto &table_name : _batch_buffer->tables())
+                    flushBatch(table_name);
+
+            if (_copy_buffer)
+                for (auto &table_name : _copy_buffer->tables())
+                    flushCopy(table_name);
+
+            if (_binary_buffer)
+                for (auto &table_name : _binary_buffer->tables())
+                    flushBinary(table_name);
+        }
+
+        // a quiet system still reconnects and replays the journal, since flush() is called
+        // while idle
+        if (_journal && !_in_replay && isOpen() && !_journal->empty() && (!connectionLost() || reconnect()))
+            replayJournal();
+
+        if (_retention && isOpen() && chrono::steady_clock::now() >= _next_retention)
+        {
+            _next_retention = chrono::steady_clock::now() + RetentionInterval;
+
+            // a failed run is logged by applyRetention(), and is simply tried again later
+            try
+            {
+                applyRetention();
+            }
+            catch (const Tango::DevFailed &)
+            {
+                spdlog::warn("The ttl retention failed, it will be run again in {} hours", RetentionInterval.count());
+            }
+        }
+
+        if (!_rollup_fills.empty() && isOpen())
+        {
+            // a failed fill is logged by fillRollup(), and is not tried again
+            try
+            {
+                fillRollup();
+            }
+            catch (const Tango::DevFailed &)
+            {
+                spdlog::warn("Rollup: {} is left without its older buckets",
+                    QueryBuilder::rollupName(_rollup_fills.front().traits, *_rollup_fills.front().rollup));
+
+                _rollup_fills.pop_front();
+            }
+        }
+    }
+
     //=============================================================================
     //=============================================================================
     void DbConnection::storeAttribute(const string &full_attr_name,
@@ -127,7 +340,9 @@ namespace pqxx_conn
         checkConnection(LOCATION_INFO);
 
         // if the attribute has already been configured, then we can not add it again,
-        // this is an error case
+        // this is an error case. It may have been added since it was last found missing
+        _conf_id_cache->forgetMissing(full_attr_name);
+
         if (_conf_id_cache->valueExists(full_attr_name))
         {
             string msg {
@@ -246,6 +461,47 @@ namespace pqxx_conn
         }
     }
 
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::storeAttributeTtl(const string &full_attr_name, unsigned int ttl)
+    {
+        assert(!full_attr_name.empty());
+        assert(_conn != nullptr);
+        assert(_conf_id_cache != nullptr);
+
+        spdlog::trace("Storing ttl {} for attribute {}", ttl, full_attr_name);
+
+        checkConnection(LOCATION_INFO);
+        checkAttributeExists(full_attr_name, LOCATION_INFO);
+
+        try
+        {
+            // create and perform a pqxx transaction
+            pqxx::perform([&full_attr_name, ttl, this]() {
+                pqxx::work tx {(*_conn), StoreAttributeTtl};
+
+                if (!tx.prepared(StoreAttributeTtl).exists())
+                {
+                    tx.conn().prepare(StoreAttributeTtl, QueryBuilder::storeAttributeTtlStatement());
+                    spdlog::trace("Created prepared statement for: {}", StoreAttributeTtl);
+                }
+
+                // no row is updated when the ttl is unchanged
+                tx.exec_prepared0(StoreAttributeTtl, static_cast<int>(ttl), _conf_id_cache->value(full_attr_name));
+                tx.commit();
+            });
+
+            spdlog::debug("Stored ttl {} for attribute {}", ttl, full_attr_name);
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("The attribute [" + full_attr_name + "] ttl was not saved.",
+                ex.base().what(),
+                QueryBuilder::storeAttributeTtlStatement(),
+                LOCATION_INFO);
+        }
+    }
+
     //=============================================================================
     //=============================================================================
     void DbConnection::storeParameterEvent(const string &full_attr_name,
@@ -295,6 +551,10 @@ namespace pqxx_conn
             archive_period,
             description);
 
+        // the archive thresholds apply to the data events that follow
+        if (_deadband_filter)
+            _deadband_filter->configure(full_attr_name, archive_abs_change, archive_rel_change, archive_period);
+
         checkConnection(LOCATION_INFO);
         checkAttributeExists(full_attr_name, LOCATION_INFO);
 
@@ -359,6 +619,10 @@ namespace pqxx_conn
             quality,
             error_msg);
 
+        // the next data event after an error is always stored
+        if (_deadband_filter)
+            _deadband_filter->reset(full_attr_name);
+
         checkConnection(LOCATION_INFO);
         checkAttributeExists(full_attr_name, LOCATION_INFO);
 
@@ -474,6 +738,10 @@ namespace pqxx_conn
         assert(_error_desc_id_cache != nullptr);
         assert(_event_id_cache != nullptr);
 
+        // this is asked when the attribute is configured, it may have been added since
+        // it was last found missing, so always check the database
+        _conf_id_cache->forgetMissing(full_attr_name);
+
         if (_conf_id_cache->valueExists(full_attr_name))
         {
             spdlog::trace("Query attribute archived returns true for: {}", full_attr_name);
@@ -531,6 +799,132 @@ namespace pqxx_conn
         return traits;
     }
 
+    //=============================================================================
+    //=============================================================================
+    std::unique_ptr<ColumnarSeriesBase> DbConnection::fetchSeries(
+        const std::string &full_attr_name, double start_time, double end_time, bool write_values)
+    {
+        assert(!full_attr_name.empty());
+
+        auto traits = fetchAttributeTraits(full_attr_name);
+
+        // the type is only used to select the template, each chunk is appended to the series
+        // as it is fetched
+        auto fetch = [&, this](auto type) -> std::unique_ptr<ColumnarSeriesBase> {
+            using T = decltype(type);
+
+            auto series = std::make_unique<ColumnarSeries<T>>(!traits.isScalar());
+
+            fetchDataEvents<T>(full_attr_name, start_time, end_time, [&series, write_values](const auto &chunk) {
+                series->append(chunk, write_values);
+            });
+
+            return series;
+        };
+
+        switch (traits.type())
+        {
+            case Tango::DEV_BOOLEAN: return fetch(bool {});
+            case Tango::DEV_SHORT: return fetch(int16_t {});
+            case Tango::DEV_LONG: return fetch(int32_t {});
+            case Tango::DEV_LONG64: return fetch(int64_t {});
+            case Tango::DEV_FLOAT: return fetch(float {});
+            case Tango::DEV_DOUBLE: return fetch(double {});
+            case Tango::DEV_UCHAR: return fetch(uint8_t {});
+            case Tango::DEV_USHORT: return fetch(uint16_t {});
+            case Tango::DEV_ULONG: return fetch(uint32_t {});
+            case Tango::DEV_ULONG64: return fetch(uint64_t {});
+            case Tango::DEV_STRING: return fetch(std::string {});
+            case Tango::DEV_STATE: return fetch(Tango::DevState {});
+
+            default:
+                std::string msg {"Can not fetch a series of the unsupported type: " +
+                    tangoEnumToString(traits.type()) + ", for attribute: [" + full_attr_name + "]"};
+
+                spdlog::error("Error: {}", msg);
+                Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+        }
+
+        return nullptr;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::fetchRollup(const std::string &full_attr_name,
+        double start_time,
+        double end_time,
+        std::chrono::seconds resolution,
+        const std::function<void(const RollupChunk &)> &callback,
+        std::size_t chunk_size)
+    {
+        assert(!full_attr_name.empty());
+        assert(_conn != nullptr);
+        assert(_conf_id_cache != nullptr);
+        assert(chunk_size > 0);
+
+        checkConnection(LOCATION_INFO);
+        checkAttributeExists(full_attr_name, LOCATION_INFO);
+
+        auto traits = fetchAttributeTraits(full_attr_name);
+
+        if (!QueryBuilder::hasRollups(traits) || resolution.count() <= 0)
+        {
+            std::string msg {"Can not fetch a rollup of the " + tangoEnumToString(traits.formatType()) + " " +
+                tangoEnumToString(traits.type()) + ", with a resolution of: " + std::to_string(resolution.count()) +
+                "s, for attribute: [" + full_attr_name +
+                "]. Only numeric scalars with a resolution of at least a second have rollups"};
+
+            spdlog::error("Error: {}", msg);
+            Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+        }
+
+        auto rollup = _rollups ? QueryBuilder::selectRollup(resolution) : nullptr;
+
+        auto query = QueryBuilder::fetchRollupStatement(
+            traits, rollup, _conf_id_cache->value(full_attr_name), start_time, end_time, resolution);
+
+        spdlog::trace("Fetching rollup for attribute: {} from: {}, between: {} and: {} with resolution: {}s",
+            full_attr_name,
+            rollup != nullptr ? QueryBuilder::rollupName(traits, *rollup) : QueryBuilder::tableName(traits),
+            start_time,
+            end_time,
+            resolution.count());
+
+        RollupChunk chunk;
+
+        try
+        {
+            // as fetchDataEvents(), the transaction is not retried once chunks are returned
+            pqxx::read_transaction tx {(*_conn), FetchRollup};
+            pqxx::icursorstream cursor {
+                tx, query, FetchRollup, static_cast<pqxx::cursor_base::difference_type>(chunk_size)};
+            pqxx::result result;
+
+            while (cursor >> result)
+            {
+                chunk.clear();
+
+                for (const auto &row : result)
+                {
+                    chunk.bucket.push_back(row[0].as<double>());
+                    chunk.min.push_back(row[1].as<double>());
+                    chunk.max.push_back(row[2].as<double>());
+                    chunk.avg.push_back(row[3].as<double>());
+                    chunk.count.push_back(row[4].as<int64_t>());
+                }
+
+                callback(chunk);
+            }
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the rollup for attribute [" + full_attr_name + "].",
+                ex.base().what(),
+                query,
+                LOCATION_INFO);
+        }
+    }
+
     //=============================================================================
     //=============================================================================
     void DbConnection::storeEvent(const std::string &full_attr_name, const std::string &event)
@@ -618,37 +1012,1157 @@ namespace pqxx_conn
 
     //=============================================================================
     //=============================================================================
-    void DbConnection::checkAttributeExists(const std::string &full_attr_name, const std::string &location)
+    void DbConnection::flushBatch(const std::string &table_name)
     {
-        // check the attribute has been configured and added to the database,
-        // if it has not then we can not use it for operations
-        if (!_conf_id_cache->valueExists(full_attr_name))
+        assert(_batch_buffer != nullptr);
+
+        // the rows are removed from the buffer even if the insert fails, since a
+        // failing row would otherwise block every subsequent flush of the table
+        auto rows = _batch_buffer->take(table_name);
+
+        if (rows.empty())
+            return;
+
+        spdlog::trace("Flushing {} batched data events to table {}", rows.size(), table_name);
+
+        // the whole statement is built in the reused query buffer, events already
+        // stored are skipped so a batch can be stored again after a failure
+        _query_buffer.clear();
+        _query_buffer += QueryBuilder::storeDataEventBatchStatement(table_name);
+
+        for (auto iter = rows.begin(); iter != rows.end(); ++iter)
         {
-            string msg {"This attribute [" + full_attr_name +
-                "] does not exist in the database. Unable to work with this attribute until it is added."};
+            if (iter != rows.begin())
+                _query_buffer += ',';
 
-            spdlog::error("Error: The attribute does not exist in the database, add it first.");
-            spdlog::error("Attribute details. Name: {}", full_attr_name);
-            spdlog::error("Throwing consistency error with message: \"{}\"", msg);
-            Tango::Except::throw_exception("Consistency Error", msg, location);
+            _query_buffer += iter->row;
+        }
+
+        _query_buffer += QueryBuilder::storeDataEventSkipStored();
+
+        try
+        {
+            pqxx::perform([&, this]() {
+                pqxx::work tx {(*_conn), StoreDataEventBatch};
+                tx.exec0(_query_buffer);
+                tx.commit();
+            });
+
+            return;
+        }
+        catch (const pqxx::broken_connection &ex)
+        {
+            journalBatch(rows.begin(), rows.end(), table_name, ex.what());
+            return;
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            spdlog::warn("The batch of {} data events for table {} failed, storing each in turn. Error: \"{}\"",
+                rows.size(),
+                table_name,
+                ex.base().what());
+        }
+
+        // a single bad event fails the whole statement, so the events are stored one at
+        // a time to keep all but those the database refuses
+        for (auto iter = rows.begin(); iter != rows.end(); ++iter)
+        {
+            _query_buffer.clear();
+            _query_buffer += QueryBuilder::storeDataEventBatchStatement(table_name);
+            _query_buffer += iter->row;
+            _query_buffer += QueryBuilder::storeDataEventSkipStored();
+
+            try
+            {
+                pqxx::perform([&, this]() {
+                    pqxx::work tx {(*_conn), StoreDataEventBatch};
+                    tx.exec0(_query_buffer);
+                    tx.commit();
+                });
+            }
+            catch (const pqxx::broken_connection &ex)
+            {
+                journalBatch(iter, rows.end(), table_name, ex.what());
+                return;
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                // the caller that triggered the flush is not the one that failed, so
+                // the event is reported against its attribute in the log only
+                spdlog::error("Error: The attribute [{}] batched data event was not saved. Error: \"{}\"",
+                    iter->event.attr_name,
+                    ex.base().what());
+
+                spdlog::error("Error: Failed query: {}", _query_buffer);
+
+                // the deadband filter compares later events with this one, as if stored
+                if (_deadband_filter)
+                    _deadband_filter->reset(iter->event.attr_name);
+            }
         }
     }
 
     //=============================================================================
     //=============================================================================
-    void DbConnection::checkConnection(const std::string &location)
+    void DbConnection::flushCopy(const std::string &table_name)
     {
-        if (isClosed())
+        assert(_copy_buffer != nullptr);
+
+        // as with flushBatch(), the rows are dropped from the buffer even on failure
+        auto rows = _copy_buffer->take(table_name);
+
+        if (rows.empty())
+            return;
+
+        spdlog::trace("Streaming {} data events to table {}", rows.size(), table_name);
+
+        try
         {
-            string msg {
-                "Connection to database is closed. Ensure it has been opened before trying to use the connection."};
+            copyStaged(table_name, rows.cbegin(), rows.cend());
+            return;
+        }
+        catch (const pqxx::broken_connection &ex)
+        {
+            journalBatch(rows.cbegin(), rows.cend(), table_name, ex.what());
+            return;
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            spdlog::warn("The stream of {} data events for table {} failed, storing each in turn. Error: \"{}\"",
+                rows.size(),
+                table_name,
+                ex.base().what());
+        }
 
-            spdlog::error(
-                "Error: The DbConnection is showing a closed connection status, open it before using store functions");
+        // as with flushBatch(), a single bad event fails the whole stream, so the
+        // events are streamed one at a time to keep all but those the database refuses
+        for (auto iter = rows.cbegin(); iter != rows.cend(); ++iter)
+        {
+            try
+            {
+                copyStaged(table_name, iter, iter + 1);
+            }
+            catch (const pqxx::broken_connection &ex)
+            {
+                journalBatch(iter, rows.cend(), table_name, ex.what());
+                return;
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                spdlog::error("Error: The attribute [{}] streamed data event was not saved. Error: \"{}\"",
+                    iter->event.attr_name,
+                    ex.base().what());
+
+                if (_deadband_filter)
+                    _deadband_filter->reset(iter->event.attr_name);
+            }
+        }
+    }
 
-            spdlog::error("Throwing connection error with message: \"{}\"", msg);
-            Tango::Except::throw_exception("Connection Error", msg, location);
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::copyStaged(const std::string &table_name,
+        std::vector<BatchedEvent<CopyRow>>::const_iterator begin,
+        std::vector<BatchedEvent<CopyRow>>::const_iterator end)
+    {
+        auto create = _staging_tables.count(table_name) == 0;
+
+        // a connection can only run a single COPY at a time, so each table is
+        // streamed in turn, with a new stream opened for every flush
+        pqxx::perform([&, this]() {
+            pqxx::work tx {(*_conn), StoreDataEventCopy};
+
+            if (create)
+                tx.exec0(QueryBuilder::createStagingTableStatement(table_name));
+
+            pqxx::stream_to stream {
+                tx, QueryBuilder::storeDataEventStagingTable(table_name), QueryBuilder::storeDataEventCopyColumns()};
+
+            for (auto iter = begin; iter != end; ++iter)
+                stream << iter->row;
+
+            stream.complete();
+            tx.exec0(QueryBuilder::storeStagedDataEventsStatement(table_name));
+            tx.commit();
+        });
+
+        // the table is only kept once the transaction creating it has committed
+        _staging_tables.insert(table_name);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::flushBinary(const std::string &table_name)
+    {
+        assert(_binary_buffer != nullptr);
+        assert(_libpq_conn != nullptr);
+
+        // as with flushBatch(), the rows are dropped from the buffer even on failure
+        auto tuples = _binary_buffer->take(table_name);
+
+        if (tuples.empty())
+            return;
+
+        spdlog::trace("Streaming {} binary data events to table {}", tuples.size(), table_name);
+
+        try
+        {
+            copyStagedBinary(table_name, tuples.cbegin(), tuples.cend());
+            return;
+        }
+        catch (const pqxx::broken_connection &ex)
+        {
+            journalBatch(tuples.cbegin(), tuples.cend(), table_name, ex.what());
+            return;
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            spdlog::warn("The binary stream of {} data events for table {} failed, storing each in turn. Error: \"{}\"",
+                tuples.size(),
+                table_name,
+                ex.base().what());
+        }
+
+        // as with flushCopy(), the events are streamed one at a time to keep all but
+        // those the database refuses
+        for (auto iter = tuples.cbegin(); iter != tuples.cend(); ++iter)
+        {
+            try
+            {
+                copyStagedBinary(table_name, iter, iter + 1);
+            }
+            catch (const pqxx::broken_connection &ex)
+            {
+                journalBatch(iter, tuples.cend(), table_name, ex.what());
+                return;
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                spdlog::error("Error: The attribute [{}] binary streamed data event was not saved. Error: \"{}\"",
+                    iter->event.attr_name,
+                    ex.base().what());
+
+                if (_deadband_filter)
+                    _deadband_filter->reset(iter->event.attr_name);
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::copyStagedBinary(const std::string &table_name,
+        std::vector<BatchedEvent<std::string>>::const_iterator begin,
+        std::vector<BatchedEvent<std::string>>::const_iterator end)
+    {
+        // the stream buffer keeps its capacity between flushes, so once it has grown to
+        // the size of a full batch no further allocation is needed
+        _binary_stream.clear();
+        binary_copy::appendHeader(_binary_stream);
+
+        for (auto iter = begin; iter != end; ++iter)
+            _binary_stream += iter->row;
+
+        binary_copy::appendTrailer(_binary_stream);
+
+        auto copy =
+            QueryBuilder::storeDataEventCopyStatement(QueryBuilder::storeDataEventStagingTable(table_name), true);
+
+        // the native connection has no transaction object, so the staging statements
+        // are wrapped in one by hand
+        _libpq_conn->exec("BEGIN");
+
+        try
+        {
+            if (_staging_tables.count(table_name) == 0)
+                _libpq_conn->exec(QueryBuilder::createStagingTableStatement(table_name));
+
+            _libpq_conn->copyIn(copy, _binary_stream);
+
+            _libpq_conn->exec(QueryBuilder::storeStagedDataEventsStatement(table_name));
+            _libpq_conn->exec("COMMIT");
+        }
+        catch (const pqxx::broken_connection &)
+        {
+            throw;
+        }
+        catch (const pqxx::pqxx_exception &)
+        {
+            _libpq_conn->exec("ROLLBACK");
+            throw;
         }
+
+        _staging_tables.insert(table_name);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::addBinaryTuple(const std::string &table_name, BatchedEvent<std::string> tuple)
+    {
+        assert(_binary_buffer != nullptr);
+
+        // flush the table once its batch is full, then any tables that have waited too long
+        if (_binary_buffer->add(table_name, std::move(tuple)))
+            flushBinary(table_name);
+
+        for (auto &expired : _binary_buffer->expiredTables())
+            flushBinary(expired);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::warmCaches()
+    {
+        assert(_conf_id_cache != nullptr);
+        assert(_error_desc_id_cache != nullptr);
+        assert(_event_id_cache != nullptr);
+
+        auto start = chrono::steady_clock::now();
+
+        try
+        {
+            _conf_id_cache->fetchAll();
+            _error_desc_id_cache->fetchAll();
+            _event_id_cache->fetchAll();
+        }
+        catch (const Tango::DevFailed &)
+        {
+            // not fatal, each reference is looked up when it is first used instead
+            spdlog::warn("Failed to load the caches, references will be looked up as they are used");
+
+            _conf_id_cache->clear();
+            _error_desc_id_cache->clear();
+            _event_id_cache->clear();
+            return;
+        }
+
+        spdlog::info("Loaded {} attributes, {} error messages and {} history events into the caches in {}ms",
+            _conf_id_cache->size(),
+            _error_desc_id_cache->size(),
+            _event_id_cache->size(),
+            chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::fetchDomainOids()
+    {
+        try
+        {
+            pqxx::perform([&, this]() {
+                pqxx::work tx {(*_conn), FetchDomainOids};
+                auto result = tx.exec(QueryBuilder::fetchDomainOidsStatement());
+                tx.commit();
+
+                for (const auto &row : result)
+                {
+                    auto name = row.at(0).as<std::string>();
+                    auto oid = row.at(1).as<uint32_t>();
+
+                    if (name == schema::DomainUchar)
+                        _domain_oids.uchar = oid;
+                    else if (name == schema::DomainUshort)
+                        _domain_oids.ushort = oid;
+                    else if (name == schema::DomainUlong)
+                        _domain_oids.ulong = oid;
+                    else if (name == schema::DomainUlong64)
+                        _domain_oids.ulong64 = oid;
+                }
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the unsigned domain type ids.",
+                ex.base().what(),
+                QueryBuilder::fetchDomainOidsStatement(),
+                LOCATION_INFO);
+        }
+
+        spdlog::debug("Unsigned domain oids uchar: {} ushort: {} ulong: {} ulong64: {}",
+            _domain_oids.uchar,
+            _domain_oids.ushort,
+            _domain_oids.ulong,
+            _domain_oids.ulong64);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::fetchPackedTables()
+    {
+        try
+        {
+            _packed_tables = pqxx::perform([this]() {
+                pqxx::work tx {(*_conn), FetchPackedTables};
+                auto result = tx.exec(QueryBuilder::fetchPackedTablesStatement());
+                tx.commit();
+
+                unordered_set<string> found;
+
+                for (const auto &row : result)
+                    found.insert(row.at(0).as<string>());
+
+                return found;
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the data tables with packed value columns.",
+                ex.base().what(),
+                QueryBuilder::fetchPackedTablesStatement(),
+                LOCATION_INFO);
+        }
+
+        spdlog::debug("Found {} data tables with packed value columns", _packed_tables.size());
+    }
+
+    //=============================================================================
+    //=============================================================================
+    vector<pair<string, bool>> DbConnection::fetchDataTables()
+    {
+        vector<pair<string, bool>> tables;
+
+        try
+        {
+            tables = pqxx::perform([this]() {
+                pqxx::work tx {(*_conn), FetchDataTables};
+                auto result = tx.exec(QueryBuilder::fetchDataTablesStatement());
+                tx.commit();
+
+                vector<pair<string, bool>> found;
+
+                for (const auto &row : result)
+                    found.emplace_back(row.at(0).as<string>(), row.at(1).as<bool>());
+
+                return found;
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the data tables.",
+                ex.base().what(),
+                QueryBuilder::fetchDataTablesStatement(),
+                LOCATION_INFO);
+        }
+
+        return tables;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::resizeChunkIntervals(std::size_t target_bytes)
+    {
+        assert(target_bytes > 0);
+        assert(_conn != nullptr);
+
+        checkConnection(LOCATION_INFO);
+
+        for (const auto &table : fetchDataTables())
+        {
+            string query;
+
+            try
+            {
+                auto rate = pqxx::perform([&table, &query, this]() {
+                    pqxx::work tx {(*_conn), MaintainDataTable};
+                    query = QueryBuilder::fetchIngestRateStatement(table.first);
+
+                    auto row = tx.exec1(query);
+                    tx.commit();
+
+                    return row.at(0).is_null() ? 0.0 : row.at(0).as<double>();
+                });
+
+                if (rate <= 0)
+                {
+                    spdlog::debug("No recent data in table: {}, its chunk interval is unchanged", table.first);
+                    continue;
+                }
+
+                auto interval = chunkInterval(rate, target_bytes);
+
+                pqxx::perform([&table, &query, interval, this]() {
+                    pqxx::work tx {(*_conn), MaintainDataTable};
+                    query = QueryBuilder::setChunkIntervalStatement(table.first, interval);
+
+                    tx.exec(query);
+                    tx.commit();
+                });
+
+                spdlog::info("Set the chunk interval of table: {} to: {}s for an ingest rate of: {} bytes/s",
+                    table.first,
+                    interval.count(),
+                    rate);
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                handlePqxxError("Can not set the chunk interval of table [" + table.first + "].",
+                    ex.base().what(),
+                    query,
+                    LOCATION_INFO);
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::enableCompression(std::chrono::hours compress_after)
+    {
+        assert(_conn != nullptr);
+
+        checkConnection(LOCATION_INFO);
+
+        for (const auto &table : fetchDataTables())
+        {
+            string query;
+
+            try
+            {
+                pqxx::perform([&table, &query, compress_after, this]() {
+                    pqxx::work tx {(*_conn), MaintainDataTable};
+
+                    // the settings can not be changed once chunks are compressed, so they are
+                    // only applied to tables without compression
+                    if (!table.second)
+                    {
+                        query = QueryBuilder::enableCompressionStatement(table.first);
+                        tx.exec0(query);
+                    }
+
+                    // the policy is replaced, so a change of compress_after takes effect
+                    query = QueryBuilder::removeCompressionPolicyStatement(table.first);
+                    tx.exec(query);
+
+                    query = QueryBuilder::addCompressionPolicyStatement(table.first, compress_after);
+                    tx.exec(query);
+                    tx.commit();
+                });
+
+                spdlog::info("Compression enabled for table: {} after: {} hours", table.first, compress_after.count());
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                handlePqxxError("Can not enable compression of table [" + table.first + "].",
+                    ex.base().what(),
+                    query,
+                    LOCATION_INFO);
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::applyRetention()
+    {
+        assert(_conn != nullptr);
+
+        checkConnection(LOCATION_INFO);
+
+        auto fetch = [this](const string &query, const string &msg) {
+            pqxx::result result;
+
+            try
+            {
+                result = pqxx::perform([&query, this]() {
+                    pqxx::work tx {(*_conn), ApplyRetention};
+                    auto rows = tx.exec(query);
+                    tx.commit();
+                    return rows;
+                });
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                handlePqxxError(msg, ex.base().what(), query, LOCATION_INFO);
+            }
+
+            return result;
+        };
+
+        // each statement is run in its own transaction, so the locks taken are released
+        // as the run progresses
+        auto exec = [this](const string &query, const string &msg) {
+            std::size_t affected = 0;
+
+            try
+            {
+                affected = pqxx::perform([&query, this]() {
+                    pqxx::work tx {(*_conn), ApplyRetention};
+                    auto result = tx.exec(query);
+                    tx.commit();
+                    return static_cast<std::size_t>(result.affected_rows());
+                });
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                handlePqxxError(msg, ex.base().what(), query, LOCATION_INFO);
+            }
+
+            return affected;
+        };
+
+        // a chunk older than the largest ttl of its table only holds expired events, so
+        // long as every attribute of the table has a ttl. Dropping it is far cheaper than
+        // deleting its events, and also removes compressed chunks
+        std::size_t dropped_tables = 0;
+
+        for (const auto &row : fetch(QueryBuilder::fetchTableTtlsStatement(), "Can not fetch the data table ttls."))
+        {
+            if (row.at(1).as<int>() <= 0)
+                continue;
+
+            auto table_name = row.at(0).as<string>();
+
+            exec(QueryBuilder::dropExpiredChunksStatement(table_name, row.at(2).as<int>()),
+                "Can not drop the expired chunks of table [" + table_name + "].");
+
+            dropped_tables++;
+        }
+
+        // deleting from a compressed chunk fails, or decompresses it, on all but the latest
+        // TimescaleDB, so events are only deleted after the newest compressed chunk. Expired
+        // events before it are removed once their chunk is dropped
+        std::unordered_map<std::string, std::int64_t> compressed_ends;
+
+        for (const auto &row :
+            fetch(QueryBuilder::fetchCompressedEndsStatement(), "Can not fetch the compressed chunks."))
+        {
+            compressed_ends.emplace(row.at(0).as<string>(), row.at(1).as<std::int64_t>());
+        }
+
+        auto attributes = fetch(QueryBuilder::fetchAttributeTtlsStatement(), "Can not fetch the attribute ttls.");
+        std::size_t deleted = 0;
+
+        for (const auto &row : attributes)
+        {
+            auto table_name = row.at(1).as<string>();
+            auto compressed_end = compressed_ends.find(table_name);
+
+            auto query = QueryBuilder::deleteExpiredEventsStatement(table_name,
+                row.at(0).as<int>(),
+                row.at(2).as<int>(),
+                compressed_end == compressed_ends.end() ? 0 : compressed_end->second);
+
+            deleted +=
+                exec(query, "Can not delete the expired events of attribute id [" + row.at(0).as<string>() + "].");
+        }
+
+        spdlog::info("Retention dropped expired chunks of: {} tables, deleted: {} events of: {} attributes with a ttl",
+            dropped_tables,
+            deleted,
+            attributes.size());
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::enableRetention()
+    {
+        _retention = true;
+
+        // the first run is left to flush() as the later ones are, so a long retention
+        // does not hold up startup and a failure is only logged
+        _next_retention = chrono::steady_clock::now();
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::createRollups()
+    {
+        assert(_conn != nullptr);
+
+        checkConnection(LOCATION_INFO);
+
+        vector<Tango::CmdArgType> types {Tango::DEV_DOUBLE,
+            Tango::DEV_FLOAT,
+            Tango::DEV_LONG,
+            Tango::DEV_ULONG,
+            Tango::DEV_LONG64,
+            Tango::DEV_ULONG64,
+            Tango::DEV_SHORT,
+            Tango::DEV_USHORT,
+            Tango::DEV_UCHAR};
+
+        // rollups that already exist are left as they are, and not filled again
+        unordered_set<string> existing;
+
+        try
+        {
+            pqxx::perform([&existing, this]() {
+                pqxx::read_transaction tx {(*_conn), CreateRollup};
+                auto result = tx.exec(QueryBuilder::fetchRollupNamesStatement());
+
+                for (const auto &row : result)
+                    existing.insert(row.at(0).as<string>());
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the existing rollups.",
+                ex.base().what(),
+                QueryBuilder::fetchRollupNamesStatement(),
+                LOCATION_INFO);
+        }
+
+        auto now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+        for (auto type : types)
+        {
+            AttributeTraits traits {Tango::READ, Tango::SCALAR, type};
+            assert(QueryBuilder::hasRollups(traits));
+
+            for (const auto &rollup : QueryBuilder::rollups())
+            {
+                auto name = QueryBuilder::rollupName(traits, rollup);
+                string query;
+
+                // a rollup that can not be created is logged, the others are still created
+                try
+                {
+                    pqxx::perform([&traits, &rollup, &query, this]() {
+                        // a continuous aggregate can not be created in a transaction
+                        pqxx::nontransaction tx {(*_conn), CreateRollup};
+                        query = QueryBuilder::createRollupStatement(traits, rollup);
+                        tx.exec0(query);
+
+                        query = QueryBuilder::addRollupPolicyStatement(traits, rollup);
+                        tx.exec(query);
+                        tx.commit();
+                    });
+
+                    spdlog::info("Rollup: {} is maintained", name);
+                }
+                catch (const pqxx::pqxx_exception &ex)
+                {
+                    spdlog::error("Error: Can not create the rollup [{}]. Unable to complete query: {}, error: {}",
+                        name,
+                        query,
+                        ex.base().what());
+
+                    continue;
+                }
+
+                // the refresh policy only covers recent buckets, so the events already stored
+                // are filled in from the end of its window back. The window end is aligned to
+                // the bucket, as only whole buckets are refreshed
+                if (existing.count(name) == 0)
+                {
+                    auto bucket = rollup.bucket.count();
+                    auto end = (now - rollup.end_offset.count()) / bucket * bucket;
+                    _rollup_fills.push_back(RollupFill {traits, &rollup, end, 0, false});
+                }
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::fillRollup()
+    {
+        assert(_conn != nullptr);
+        assert(!_rollup_fills.empty());
+
+        auto &fill = _rollup_fills.front();
+        auto bucket = fill.rollup->bucket.count();
+        string query;
+
+        try
+        {
+            pqxx::perform([&fill, &query, bucket, this]() {
+                // the refresh can not be run in a transaction
+                pqxx::nontransaction tx {(*_conn), FillRollup};
+
+                if (!fill.first_fetched)
+                {
+                    query = QueryBuilder::fetchFirstEventStatement(QueryBuilder::tableName(fill.traits));
+                    auto row = tx.exec1(query);
+
+                    // an empty table has nothing to fill, the slices stop at once
+                    fill.first = row.at(0).is_null() ? fill.end : row.at(0).as<int64_t>() / bucket * bucket;
+                    fill.first_fetched = true;
+                }
+
+                if (fill.end > fill.first)
+                {
+                    auto start = max(fill.first, fill.end - RollupFillSlice.count());
+                    query = QueryBuilder::refreshRollupStatement(fill.traits, *fill.rollup, start, fill.end);
+                    tx.exec(query);
+                    fill.end = start;
+                }
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fill the rollup [" + QueryBuilder::rollupName(fill.traits, *fill.rollup) + "].",
+                ex.base().what(),
+                query,
+                LOCATION_INFO);
+        }
+
+        if (fill.end <= fill.first)
+        {
+            spdlog::info("Rollup: {} is filled", QueryBuilder::rollupName(fill.traits, *fill.rollup));
+            _rollup_fills.pop_front();
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    std::chrono::seconds DbConnection::chunkInterval(double bytes_per_second, std::size_t target_bytes) noexcept
+    {
+        if (bytes_per_second <= 0)
+            return MaxChunkInterval;
+
+        auto seconds = static_cast<double>(target_bytes) / bytes_per_second;
+
+        if (seconds < static_cast<double>(MinChunkInterval.count()))
+            return MinChunkInterval;
+
+        if (seconds > static_cast<double>(MaxChunkInterval.count()))
+            return MaxChunkInterval;
+
+        return std::chrono::seconds {static_cast<std::chrono::seconds::rep>(seconds)};
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::checkAttributeExists(const std::string &full_attr_name, const std::string &location)
+    {
+        // check the attribute has been configured and added to the database,
+        // if it has not then we can not use it for operations
+        if (!_conf_id_cache->valueExists(full_attr_name))
+        {
+            string msg {"This attribute [" + full_attr_name +
+                "] does not exist in the database. Unable to work with this attribute until it is added."};
+
+            spdlog::error("Error: The attribute does not exist in the database, add it first.");
+            spdlog::error("Attribute details. Name: {}", full_attr_name);
+            spdlog::error("Throwing consistency error with message: \"{}\"", msg);
+            Tango::Except::throw_exception("Consistency Error", msg, location);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::replayJournal()
+    {
+        assert(_journal != nullptr);
+
+        // nothing is returned while another connection sharing the journal is replaying
+        auto records = _journal->beginReplay(ReplayBatchSize);
+
+        if (records.empty())
+            return;
+
+        spdlog::debug("Replaying {} journaled data events", records.size());
+
+        std::size_t consumed = 0;
+        std::size_t failed = 0;
+
+        {
+            // restores the replay state however the replay ends, so an unexpected error can
+            // not leave the journal replaying for good, or the deadband filter bypassed
+            struct ReplayGuard
+            {
+                bool &in_replay;
+                EventJournal &journal;
+                const std::size_t &consumed;
+
+                ~ReplayGuard()
+                {
+                    in_replay = false;
+                    journal.endReplay(consumed);
+                }
+            } guard {_in_replay, *_journal, consumed};
+
+            _in_replay = true;
+
+            // each event is stored in its own transaction, and skipped should it already be
+            // stored, so an event leaves the journal only once it is in the database or the
+            // database refuses it. Errors have already been logged by replayRecord(). Once
+            // the connection is lost, the event and those after it are kept to be replayed
+            // again
+            for (auto &record : records)
+            {
+                try
+                {
+                    replayRecord(record);
+                }
+                catch (const Tango::DevFailed &)
+                {
+                    if (connectionLost())
+                        break;
+
+                    failed++;
+                }
+                catch (...)
+                {
+                    // any other error has not been logged, but is otherwise a refused event
+                    spdlog::error("Error: Unexpected error replaying a journaled data event for attribute: [{}]",
+                        record.attr_name);
+
+                    if (connectionLost())
+                        break;
+
+                    failed++;
+                }
+
+                consumed++;
+            }
+        }
+
+        if (consumed < records.size())
+        {
+            spdlog::warn(
+                "Lost the database connection while replaying the event journal, {} events remain", _journal->size());
+        }
+
+        if (failed > 0)
+            spdlog::error("Error: {} journaled data events could not be replayed and were discarded", failed);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::replayRecord(const JournalRecord &record)
+    {
+        // the type is only used to select the template, the values come from the record
+        auto replay = [&record, this](auto type) {
+            using T = decltype(type);
+
+            std::size_t pos = 0;
+            auto value_r = journal_utils::readValues<T>(record.values, pos, record.values.size());
+            auto value_w = journal_utils::readValues<T>(record.values, pos, record.values.size());
+
+            if (!value_r || !value_w || pos != record.values.size())
+            {
+                std::string msg {
+                    "Journaled data event has corrupt values, for attribute: [" + record.attr_name + "]"};
+
+                spdlog::error("Error: {}", msg);
+                Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+            }
+
+            storeReplayedEvent<T>(
+                record.attr_name, record.event_time, record.quality, value_r, value_w, record.traits);
+        };
+
+        switch (record.traits.type())
+        {
+            case Tango::DEV_BOOLEAN: replay(bool {}); break;
+            case Tango::DEV_SHORT: replay(int16_t {}); break;
+            case Tango::DEV_LONG: replay(int32_t {}); break;
+            case Tango::DEV_LONG64: replay(int64_t {}); break;
+            case Tango::DEV_FLOAT: replay(float {}); break;
+            case Tango::DEV_DOUBLE: replay(double {}); break;
+            case Tango::DEV_UCHAR: replay(uint8_t {}); break;
+            case Tango::DEV_USHORT: replay(uint16_t {}); break;
+            case Tango::DEV_ULONG: replay(uint32_t {}); break;
+            case Tango::DEV_ULONG64: replay(uint64_t {}); break;
+            case Tango::DEV_STRING: replay(std::string {}); break;
+            case Tango::DEV_STATE: replay(Tango::DevState {}); break;
+
+            default:
+                std::string msg {"Journaled data event has an unsupported type: " +
+                    tangoEnumToString(record.traits.type()) + ", for attribute: [" + record.attr_name + "]"};
+
+                spdlog::error("Error: {}", msg);
+                Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool DbConnection::connectionLost() const noexcept
+    {
+        if (_conn && !_conn->is_open())
+            return true;
+
+        return _libpq_required && !_libpq_conn->isOpen();
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::setReconnectBudget(std::chrono::milliseconds budget)
+    {
+        _reconnect_budget = budget;
+
+        if (_libpq_conn)
+            _libpq_conn->setTimeout(max(budget, PipelineMinTimeout));
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool DbConnection::reconnect()
+    {
+        auto now = chrono::steady_clock::now();
+
+        // still backing off from the last failed attempt
+        if (now < _next_reconnect)
+            return false;
+
+        auto deadline = now + _reconnect_budget;
+        spdlog::warn("Lost the connection to the database, attempting to reconnect");
+
+        while (true)
+        {
+            try
+            {
+                // connect() rebuilds the caches and the native connection state
+                connect(_connection_string);
+
+                // register every statement used on the lost connection, pqxx prepares
+                // each on the server when it is next used
+                for (auto &statement : _query_builder.preparedStatements())
+                    _conn->prepare(statement.first, statement.second);
+
+                _reconnect_backoff = chrono::milliseconds(0);
+                spdlog::info("Reconnected to the database");
+                return true;
+            }
+            catch (const Tango::DevFailed &)
+            {
+                // connect() has already logged the failure
+            }
+            catch (const pqxx::pqxx_exception &ex)
+            {
+                spdlog::error("Error: Failed to reconnect to the database: \"{}\"", ex.base().what());
+            }
+
+            auto delay = nextBackoff();
+
+            // leave further attempts until the backoff expires, rather than block the caller
+            if (chrono::steady_clock::now() + delay > deadline)
+            {
+                _next_reconnect = chrono::steady_clock::now() + delay;
+                spdlog::warn("Failed to reconnect to the database, next attempt in {}ms", delay.count());
+                return false;
+            }
+
+            this_thread::sleep_for(delay);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    std::chrono::milliseconds DbConnection::nextBackoff()
+    {
+        _reconnect_backoff = _reconnect_backoff.count() == 0 ? ReconnectMinBackoff :
+                                                               min(_reconnect_backoff * 2, ReconnectMaxBackoff);
+
+        // the delay is jittered between half and the full backoff, so a pool of connections
+        // does not reconnect in lock step once the database comes back
+        uniform_int_distribution<chrono::milliseconds::rep> distribution(
+            _reconnect_backoff.count() / 2, _reconnect_backoff.count());
+
+        return chrono::milliseconds(distribution(_jitter));
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::checkConnection(const std::string &location)
+    {
+        if (isClosed())
+        {
+            string msg {
+                "Connection to database is closed. Ensure it has been opened before trying to use the connection."};
+
+            spdlog::error(
+                "Error: The DbConnection is showing a closed connection status, open it before using store functions");
+
+            spdlog::error("Throwing connection error with message: \"{}\"", msg);
+            Tango::Except::throw_exception("Connection Error", msg, location);
+        }
+
+        // the connection was open but has since been lost, for example by a database restart
+        if (connectionLost() && !reconnect())
+        {
+            string msg {"Connection to database was lost and could not be re-established."};
+            spdlog::error("Throwing connection error with message: \"{}\"", msg);
+            Tango::Except::throw_exception("Connection Error", msg, location);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::collectPipeline(bool wait)
+    {
+        assert(_libpq_conn != nullptr);
+
+        vector<LibpqConnection::PipelineResult> results;
+
+        try
+        {
+            results = _libpq_conn->collect(wait);
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            // the events may or may not have been stored, a replay skips those that were
+            journalPipeline(ex.base().what());
+            return;
+        }
+
+        for (auto &result : results)
+        {
+            assert(!_pipelined.empty());
+
+            auto request = move(_pipelined.front());
+            _pipelined.pop_front();
+
+            if (result.error.empty())
+                continue;
+
+            if (!request.statement.empty())
+            {
+                // allow a failed prepare to be prepared again on the next event that needs it
+                auto *handle = _statements.find(request.statement);
+
+                if (handle != nullptr)
+                    handle->pipelined = false;
+
+                spdlog::error(
+                    "Error: Pipelined prepare for: {} failed with error: \"{}\"", request.statement, result.error);
+            }
+            else
+            {
+                // as with batching, the caller is not the one that failed, so the event
+                // is reported against its attribute in the log only
+                spdlog::error("Error: The attribute [{}] pipelined data event was not saved. Error: \"{}\"",
+                    request.event.attr_name,
+                    result.error);
+
+                if (_deadband_filter)
+                    _deadband_filter->reset(request.event.attr_name);
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void DbConnection::journalPipeline(const string &what)
+    {
+        std::size_t journaled = 0;
+
+        for (auto &request : _pipelined)
+        {
+            // prepares are simply sent again on the new connection
+            if (!request.statement.empty())
+                continue;
+
+            if (_journal && !_in_replay && _journal->append(request.event))
+            {
+                journaled++;
+                continue;
+            }
+
+            spdlog::error("Error: The attribute [{}] pipelined data event was not saved{}. Error: \"{}\"",
+                request.event.attr_name,
+                _journal ? ", the event journal is full" : "",
+                what);
+
+            if (_deadband_filter)
+                _deadband_filter->reset(request.event.attr_name);
+        }
+
+        if (journaled > 0)
+            spdlog::warn("Lost the database connection, journaled {} pipelined data events", journaled);
+
+        _pipelined.clear();
     }
 
     //=============================================================================
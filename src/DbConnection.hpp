@@ -21,22 +21,74 @@
 #define _PSQL_CONNECTION_HPP
 
 #include "AttributeTraits.hpp"
+#include "BatchBuffer.hpp"
+#include "BinaryCopy.hpp"
 #include "ColumnCache.hpp"
+#include "ColumnarSeries.hpp"
 #include "ConnectionBase.hpp"
+#include "DataEventChunk.hpp"
+#include "DeadbandFilter.hpp"
+#include "EventJournal.hpp"
 #include "HdbppTxFactory.hpp"
+#include "LibpqConnection.hpp"
+#include "PayloadPool.hpp"
 #include "QueryBuilder.hpp"
+#include "RollupChunk.hpp"
+#include "StatementTable.hpp"
 #include "TimescaleSchema.hpp"
+#include "ValuePacking.hpp"
+#include "ValueView.hpp"
 #include "spdlog/spdlog.h"
 
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <pqxx/pqxx>
+#include <random>
 #include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace hdbpp_internal
 {
 namespace pqxx_conn
 {
+    // A data event waiting in a batch, with the event it was built from. Should its batch
+    // not be stored, the event names the attribute in the error, and when the journal is
+    // enabled, holds the values to journal.
+    template<typename TRow>
+    struct BatchedEvent
+    {
+        TRow row;
+        JournalRecord event;
+    };
+
+    // A rollup created empty whose buckets before its refresh policy window are still
+    // to be materialized. They are filled a slice at a time from the newest back, end is
+    // the end of the next slice and first the first event of the data table, in seconds
+    // since the epoch. first is only fetched with the first slice.
+    struct RollupFill
+    {
+        AttributeTraits traits;
+        const Rollup *rollup;
+        std::int64_t end;
+        std::int64_t first;
+        bool first_fetched;
+    };
+
+    // A request sent in pipeline mode and waiting on its result. A prepare names its
+    // statement, while a data event holds the event it was sent for, to name its attribute
+    // should it fail, and to journal it should the connection be lost first.
+    struct PipelinedRequest
+    {
+        std::string statement;
+        JournalRecord event;
+    };
+
     // The DbConnection represents a direct connection to a database, in this case
     // postgresql. The API is fixed by the transaction classes usage and CRTP
     class DbConnection : public ConnectionBase, public HdbppTxFactory<DbConnection>
@@ -53,7 +105,23 @@ namespace pqxx_conn
 
             // Where possible, use prepared statements, this is quicker than
             // using strings
-            PreparedStatement
+            PreparedStatement,
+
+            // Buffer data events per table and stream them in with COPY FROM STDIN,
+            // this is always batched and much quicker for high rate attributes.
+            // Other events are stored with prepared statements.
+            CopyStream,
+
+            // As CopyStream, but the data is encoded in the binary COPY format and
+            // sent over a second, native libpq connection. This removes the text
+            // conversion of every value on both the client and the server.
+            CopyBinary,
+
+            // As PreparedStatement, but data events are sent in libpq pipeline mode over
+            // a second, native connection without waiting for each result. Each event is
+            // still its own transaction. Requires postgres 14 or later, otherwise it falls
+            // back to PreparedStatement.
+            Pipeline
         };
 
         DbConnection(DbStoreMethod db_store_method);
@@ -64,6 +132,71 @@ namespace pqxx_conn
         bool isOpen() const noexcept override { return _connected; }
         bool isClosed() const noexcept override { return !isOpen(); }
 
+        // batching API
+
+        // Accumulate data events per table and store them as a single multi-row insert
+        // once batch_size events are waiting, or the oldest has waited longer than max_age.
+        // The age is checked as events arrive, so a quiet table is only stored on the next
+        // event, flush() or disconnect(). A batch_size of 0 disables batching (default).
+        // The copy methods are always batched, here a batch_size of 0 restores their
+        // default batch size and flush interval.
+        void enableBatching(std::size_t batch_size, std::chrono::milliseconds max_age);
+
+        bool isBatching() const noexcept
+        {
+            return _batch_buffer != nullptr || _copy_buffer != nullptr || _binary_buffer != nullptr;
+        }
+
+        // store all waiting batched data events immediately, then replay any
+        // journaled events, and run the retention and rollup fills once due
+        void flush();
+
+        // reconnection API
+
+        // When the connection to the database is lost it is re-established on the next
+        // request, with the caches rebuilt and the prepared statements registered again.
+        // Attempts are retried with a jittered exponential backoff for at most budget,
+        // after which the request fails and the next attempt is left until the backoff
+        // expires, so a database outage does not stall each caller. Each attempt is
+        // further bounded by the connect_timeout in the connection string. The budget also
+        // bounds how long the pipeline waits on a server that has stopped responding.
+        void setReconnectBudget(std::chrono::milliseconds budget);
+
+        // journal API
+
+        // Data events that can not be stored because the database is unreachable are
+        // added to the journal, rather than raising an error. They are replayed through
+        // the configured store method once the database can be reached, in batches, as
+        // further data events arrive and on each flush(). The journal may be shared with
+        // other connections, only one replays at a time.
+        void enableJournal(std::shared_ptr<EventJournal> journal) { _journal = std::move(journal); }
+
+        // filter API
+
+        // Drop data events that repeat, or change by less than the archive thresholds of,
+        // the last event stored for their attribute. The thresholds are taken from the
+        // attribute's parameter events, attributes without any are not filtered. See
+        // DeadbandFilter for the details.
+        void enableDeadbandFilter() { _deadband_filter = std::make_unique<DeadbandFilter>(); }
+
+        // Store the values of numeric spectrum and image attributes packed into the bytea
+        // columns added by db-schema/packed.sql, rather than as arrays. Only the
+        // prepared_statement method without batching stores packed values. See value_packing
+        // for the encoding, fetchDataEvents() unpacks them.
+        void enableArrayPacking() { _array_packing = true; }
+
+        // Read aggregated values from the rollups created by createRollups(), or
+        // db-schema/rollup.sql, in fetchRollup(). Without them fetchRollup() aggregates
+        // the data tables.
+        void enableRollups() { _rollups = true; }
+
+        // cache API
+
+        // Load the attribute, error message and history event caches on connect, each
+        // table with a single streamed query, rather than looking up each reference the
+        // first time it is used. The caches are loaded again on each reconnect.
+        void enableCacheWarmup() { _cache_warmup = true; }
+
         // storage API
 
         // store a new attribute and its conf data into the database
@@ -78,6 +211,9 @@ namespace pqxx_conn
         // store a new history event in the database
         void storeHistoryEvent(const std::string &full_attr_name, const std::string &event);
 
+        // store the time to live of an attribute, in hours, 0 keeps its data forever
+        void storeAttributeTtl(const std::string &full_attr_name, unsigned int ttl);
+
         // store a parameter event in the database
         void storeParameterEvent(const std::string &full_attr_name,
             double event_time,
@@ -102,6 +238,17 @@ namespace pqxx_conn
             std::unique_ptr<vector<T>> value_w,
             const AttributeTraits &traits);
 
+        // As storeDataEvent(), but the values are borrowed rather than owned. The binary
+        // copy method encodes them directly into the COPY tuple, every other method (and
+        // the journal) takes a copy and stores it with storeDataEvent()
+        template<typename T>
+        void storeDataEventView(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            const ValueView<T> &value_r,
+            const ValueView<T> &value_w,
+            const AttributeTraits &traits);
+
         // store a data error event in the data tables
         void storeDataEventError(const std::string &full_attr_name,
             double event_time,
@@ -120,13 +267,193 @@ namespace pqxx_conn
         // get the AttributeTraits of an attribute in the database
         AttributeTraits fetchAttributeTraits(const std::string &full_attr_name);
 
+        // Fetch the data events of an attribute from start_time up to, but not including,
+        // end_time, oldest first. The events are read through a server side cursor and
+        // passed to the callback in chunks of at most chunk_size events, so a long range
+        // is never held in memory at once. The chunk is reused for each call. T must be
+        // the type the attribute is archived as. Batched events that are still waiting
+        // to be stored are not returned, call flush() first if they are needed.
+        template<typename T>
+        void fetchDataEvents(const std::string &full_attr_name,
+            double start_time,
+            double end_time,
+            const std::function<void(const DataEventChunk<T> &)> &callback,
+            std::size_t chunk_size = FetchChunkSize);
+
+        // Fetch the read, or write, values of an attribute from start_time up to, but not
+        // including, end_time as a ColumnarSeries of the type the attribute is archived
+        // as. The series holds the whole range, in buffers Arrow consumers can share
+        std::unique_ptr<ColumnarSeriesBase> fetchSeries(
+            const std::string &full_attr_name, double start_time, double end_time, bool write_values = false);
+
+        // Fetch the minimum, maximum, average and count of the read values of a numeric
+        // scalar attribute from start_time up to, but not including, end_time, in buckets
+        // of resolution. When rollups are enabled the values are read from the coarsest
+        // rollup whose bucket evenly divides resolution, so a long range reads a few rows
+        // per bucket rather than every event. Otherwise, or when the resolution is finer
+        // than every rollup, the data table is aggregated. The buckets are passed to the
+        // callback in chunks of at most chunk_size, the chunk is reused for each call.
+        void fetchRollup(const std::string &full_attr_name,
+            double start_time,
+            double end_time,
+            std::chrono::seconds resolution,
+            const std::function<void(const RollupChunk &)> &callback,
+            std::size_t chunk_size = FetchChunkSize);
+
+        // maintenance API
+
+        // These apply the TimescaleDB settings of the data tables, and are run once at
+        // startup, other than the retention which may also be run periodically. Each
+        // requires TimescaleDB 2.0 or later.
+
+        // Set the chunk interval of each data table so a chunk holds about target_bytes,
+        // based on the rate its recent uncompressed chunks have grown at. The interval
+        // applies to chunks created from now on, tables without recent data are left as
+        // they are.
+        void resizeChunkIntervals(std::size_t target_bytes);
+
+        // Enable compression of each data table, segmented by attribute, with a policy
+        // compressing chunks once they are older than compress_after
+        void enableCompression(std::chrono::hours compress_after);
+
+        // Delete the events of each attribute older than its time to live. The chunks of
+        // a table whose every attribute has a time to live are dropped once older than the
+        // largest of them, the remaining expired events are deleted by attribute from the
+        // chunks that are not compressed
+        void applyRetention();
+
+        // Apply the retention from the next flush(), and then every hour, so from the
+        // writer idle task when there is a write behind queue
+        void enableRetention();
+
+        // Create any missing rollups of the numeric scalar data tables, with their refresh
+        // policies. A new rollup is created empty, and the events already stored are filled
+        // into it by flush(), a slice at a time. A rollup that can not be created is logged
+        // and skipped.
+        void createRollups();
+
+        // The chunk interval for a table growing at bytes_per_second, so each chunk holds
+        // about target_bytes, limited to between an hour and a year
+        static std::chrono::seconds chunkInterval(double bytes_per_second, std::size_t target_bytes) noexcept;
+
     private:
         void storeEvent(const std::string &full_attr_name, const std::string &event);
         void storeErrorMsg(const std::string &full_attr_name, const std::string &error_msg);
 
+        void flushBatch(const std::string &table_name);
+
+        // build the event kept with a batched row, its values are only kept when they
+        // may need to be journaled
+        template<typename T>
+        JournalRecord batchedEvent(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        template<typename T>
+        JournalRecord batchedEvent(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            const ValueView<T> &value_r,
+            const ValueView<T> &value_w,
+            const AttributeTraits &traits);
+
+        // journal the batched events that could not be stored as the connection was lost,
+        // throws if there is no journal to hold them
+        template<typename TIter>
+        void journalBatch(TIter begin, TIter end, const std::string &table_name, const std::string &what);
+        void flushCopy(const std::string &table_name);
+
+        // copy the rows into the staging table of the data table and store them from
+        // there, skipping events already stored, in a single transaction
+        void copyStaged(const std::string &table_name,
+            std::vector<BatchedEvent<CopyRow>>::const_iterator begin,
+            std::vector<BatchedEvent<CopyRow>>::const_iterator end);
+        void flushBinary(const std::string &table_name);
+
+        // as copyStaged(), for tuples in the binary format sent over the native connection
+        void copyStagedBinary(const std::string &table_name,
+            std::vector<BatchedEvent<std::string>>::const_iterator begin,
+            std::vector<BatchedEvent<std::string>>::const_iterator end);
+
+        void addBinaryTuple(const std::string &table_name, BatchedEvent<std::string> tuple);
+        void fetchDomainOids();
+
+        // find the data tables with packed value columns, which are read whether or not
+        // packing is enabled, since rows may have been stored packed in an earlier run
+        void fetchPackedTables();
+
+        // load the caches, falling back to looking up each reference should it fail
+        void warmCaches();
+
+        // the data hypertables, each with whether compression is enabled for it
+        std::vector<std::pair<std::string, bool>> fetchDataTables();
+
+        // store a data event the deadband filter has accepted, by whichever method is
+        // configured
+        template<typename T>
+        void storeAcceptedDataEvent(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // send a data event in pipeline mode, the result is reconciled later
+        template<typename T>
+        void storePipelined(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // read the results of pipelined data events, failures are logged against their
+        // attribute rather than thrown to the caller, which sent a different event
+        void collectPipeline(bool wait);
+
+        // journal the pipelined data events whose results were lost with the connection
+        void journalPipeline(const std::string &what);
+
+        // journal an event that could not be stored
+        template<typename T>
+        void journalDataEvent(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // store a batch of journaled events, and the decoding of a single record
+        void replayJournal();
+        void replayRecord(const JournalRecord &record);
+
+        // store a journaled event on its own, bypassing any batching or pipeline, and
+        // skipping it should it already be stored
+        template<typename T>
+        void storeReplayedEvent(const std::string &full_attr_name,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // true when either connection has been lost since it was opened
+        bool connectionLost() const noexcept;
+
+        // attempt to re-establish a lost connection within the reconnect budget,
+        // returns false when the connection is still lost
+        bool reconnect();
+        std::chrono::milliseconds nextBackoff();
+
         void checkAttributeExists(const std::string &full_attr_name, const std::string &location);
         void checkConnection(const std::string &location);
 
+        // materialize the next slice of the first rollup waiting to be filled
+        void fillRollup();
+
         void handlePqxxError(
             const std::string &msg, const std::string &what, const std::string &query, const std::string &location);
 
@@ -156,8 +483,94 @@ namespace pqxx_conn
 
         // configured db access method
         DbStoreMethod _db_store_method;
+
+        // data events waiting to be stored when batching is enabled, null otherwise
+        std::unique_ptr<BatchBuffer<BatchedEvent<std::string>>> _batch_buffer;
+
+        // data events waiting to be streamed in the CopyStream method, null otherwise
+        std::unique_ptr<BatchBuffer<BatchedEvent<CopyRow>>> _copy_buffer;
+
+        // encoded tuples waiting to be sent in the CopyBinary method, null otherwise
+        std::unique_ptr<BatchBuffer<BatchedEvent<std::string>>> _binary_buffer;
+
+        // data tables whose staging table has been created on the current connection
+        std::unordered_set<std::string> _staging_tables;
+
+        // the COPY data sent on a binary flush, kept to reuse its allocation
+        std::string _binary_stream;
+
+        // the statement text built for the insert_string method and for batch flushes,
+        // also kept to reuse its allocation
+        std::string _query_buffer;
+
+        // native connection for the binary copy and pipeline methods, and the oids
+        // the binary copy needs for encoding arrays of the unsigned types
+        std::unique_ptr<LibpqConnection> _libpq_conn;
+        binary_copy::DomainOids _domain_oids;
+
+        // the data event statement for every supported traits, built on the first connect
+        StatementTable _statements;
+
+        // requests sent in pipeline mode whose results have not been collected, in the
+        // order sent, so matching the results returned by the native connection
+        std::deque<PipelinedRequest> _pipelined;
+
+        // pipelined results are reconciled without waiting as events are sent, but once
+        // this many are outstanding we wait for them all. This bounds the results buffered
+        // by the server, so neither side can stall with a full socket buffer
+        static const std::size_t PipelineDepth = 1000;
+
+        // true when the native connection is in use, and so must be open
+        bool _libpq_required = false;
+
+        // reconnection state, the backoff doubles with each failed attempt up to a limit
+        // and is zero while connected, no attempt is made before the next reconnect time
+        std::chrono::milliseconds _reconnect_budget {1000};
+        std::chrono::milliseconds _reconnect_backoff {0};
+        std::chrono::steady_clock::time_point _next_reconnect;
+        std::mt19937 _jitter {std::random_device {}()};
+
+        // optional journal for events that could not be stored, shared between connections
+        std::shared_ptr<EventJournal> _journal;
+
+        // set while replaying, so a replay is not started from within another
+        bool _in_replay = false;
+
+        // optional filter of data events inside their attribute's deadband, null otherwise
+        std::unique_ptr<DeadbandFilter> _deadband_filter;
+
+        // true when numeric arrays are stored packed
+        bool _array_packing = false;
+
+        // data tables with packed value columns, found on connect
+        std::unordered_set<std::string> _packed_tables;
+
+        // true when fetchRollup() reads from the rollups
+        bool _rollups = false;
+
+        // true when the caches are loaded on connect
+        bool _cache_warmup = false;
+
+        // true when the retention is applied periodically, and the time of the next run
+        bool _retention = false;
+        std::chrono::steady_clock::time_point _next_retention;
+
+        // rollups created by createRollups() that are still being filled
+        std::deque<RollupFill> _rollup_fills;
+
+        // number of journaled events replayed at a time, this bounds the delay a
+        // replay adds to the event that triggers it
+        static const std::size_t ReplayBatchSize = 1000;
+
+        // default number of events in each chunk returned by fetchDataEvents()
+        static const std::size_t FetchChunkSize = 10000;
     };
 } // namespace pqxx_conn
+
+// the DbConnection can encode values straight from a ValueView
+template<>
+struct StoresValueViews<pqxx_conn::DbConnection> : std::true_type
+{};
 } // namespace hdbpp_internal
 
 // include the template implementations for DbConnection
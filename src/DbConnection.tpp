@@ -95,8 +95,115 @@ namespace pqxx_conn
                     inv(*value);
             }
         };
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        struct StorePacked
+        {
+            // bind the values packed into a bytea, see value_packing
+            static void run(std::unique_ptr<std::vector<T>> &value, pqxx::prepare::invocation &inv)
+            {
+                run(value, inv, value_packing::Packable<T> {});
+            }
+
+            static void run(
+                std::unique_ptr<std::vector<T>> &value, pqxx::prepare::invocation &inv, std::true_type /*unused*/)
+            {
+                std::string packed;
+                value_packing::encode(*value, packed);
+                inv(pqxx::binarystring(packed));
+            }
+
+            // never called, value_packing::packable() only allows numbers to be packed
+            static void run(std::unique_ptr<std::vector<T>> & /*unused*/,
+                pqxx::prepare::invocation & /*unused*/,
+                std::false_type /*unused*/)
+            {}
+        };
     } // namespace store_data_utils
 
+    // Utilities to decode the fields returned by fetchDataEvents()
+    namespace fetch_data_utils
+    {
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        bool archivedAs(Tango::CmdArgType type) noexcept
+        {
+            switch (type)
+            {
+                case Tango::DEV_BOOLEAN: return std::is_same<T, bool>::value;
+                case Tango::DEV_SHORT: return std::is_same<T, int16_t>::value;
+                case Tango::DEV_LONG: return std::is_same<T, int32_t>::value;
+                case Tango::DEV_LONG64: return std::is_same<T, int64_t>::value;
+                case Tango::DEV_FLOAT: return std::is_same<T, float>::value;
+                case Tango::DEV_DOUBLE: return std::is_same<T, double>::value;
+                case Tango::DEV_UCHAR: return std::is_same<T, uint8_t>::value;
+                case Tango::DEV_USHORT: return std::is_same<T, uint16_t>::value;
+                case Tango::DEV_ULONG: return std::is_same<T, uint32_t>::value;
+                case Tango::DEV_ULONG64: return std::is_same<T, uint64_t>::value;
+                case Tango::DEV_STRING: return std::is_same<T, std::string>::value;
+                case Tango::DEV_STATE: return std::is_same<T, Tango::DevState>::value;
+                default: return false;
+            }
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendValues(
+            const pqxx::field &field, const AttributeTraits &traits, std::vector<T> &values, std::vector<T> &scratch)
+        {
+            // a null field, an event without this value, adds no values
+            if (field.is_null())
+                return;
+
+            if (traits.isScalar())
+            {
+                values.push_back(field.as<T>());
+                return;
+            }
+
+            // arrays are parsed into the scratch vector, which keeps its allocation
+            field.to(scratch);
+            values.insert(values.end(), scratch.begin(), scratch.end());
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void unpackValues(
+            const pqxx::field &field, std::vector<T> &values, std::size_t row_start, std::vector<T> &scratch)
+        {
+            // the array column is null when the values are packed, and the packed one is
+            // null when they are not
+            if (field.is_null() || values.size() != row_start)
+                return;
+
+            unpackValues(field, values, scratch, value_packing::Packable<T> {});
+        }
+
+        template<typename T>
+        void unpackValues(
+            const pqxx::field &field, std::vector<T> &values, std::vector<T> &scratch, std::true_type /*unused*/)
+        {
+            pqxx::binarystring packed {field};
+
+            if (!value_packing::decode(packed.data(), packed.size(), scratch))
+                throw pqxx::conversion_error("Invalid packed values in column: " + std::string(field.name()));
+
+            values.insert(values.end(), scratch.begin(), scratch.end());
+        }
+
+        template<typename T>
+        void unpackValues(const pqxx::field & /*unused*/,
+            std::vector<T> & /*unused*/,
+            std::vector<T> & /*unused*/,
+            std::false_type /*unused*/)
+        {}
+    } // namespace fetch_data_utils
+
     //=============================================================================
     //=============================================================================
     template<typename T>
@@ -110,15 +217,152 @@ namespace pqxx_conn
         assert(!full_attr_name.empty());
         assert(traits.isValid());
 
+        // the values are finished with once this returns, so hand them back for reuse
+        PayloadRecycler<T> recycler {value_r, value_w};
+
         spdlog::trace("Storing data event for attribute {} with traits {}, value_r valid: {}, value_w valid: {}",
             full_attr_name,
             traits,
             !value_r->empty(),
             !value_w->empty());
 
+        // replayed events were filtered when they were first stored
+        if (_deadband_filter && !_in_replay &&
+            !_deadband_filter->accept<T>(full_attr_name, event_time, quality, *value_r, *value_w))
+        {
+            spdlog::trace("Data event for attribute {} is inside its deadband and was not stored", full_attr_name);
+            return;
+        }
+
+        // the filter compares later events with this one, so should it not be stored after
+        // all, the attribute is reset and its next event is stored
+        try
+        {
+            storeAcceptedDataEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+        }
+        catch (...)
+        {
+            if (_deadband_filter)
+                _deadband_filter->reset(full_attr_name);
+
+            throw;
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::storeAcceptedDataEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        // while the connection is lost and reconnection is backing off, journal the event
+        // rather than fail
+        if (_journal && !_in_replay && isOpen() && connectionLost() && !reconnect())
+        {
+            journalDataEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+            return;
+        }
+
         checkConnection(LOCATION_INFO);
+
+        // journaled events are replayed ahead of new events while the database is reachable
+        if (_journal && !_in_replay && !_journal->empty())
+            replayJournal();
+
         checkAttributeExists(full_attr_name, LOCATION_INFO);
 
+        if (_binary_buffer)
+        {
+            // binary rows are encoded as they arrive, so the flush is a simple
+            // concatenation of the tuples for a table
+            auto tuple = binary_copy::dataEventTuple<T>(
+                _conf_id_cache->value(full_attr_name), event_time, quality, value_r, value_w, traits, _domain_oids);
+
+            addBinaryTuple(QueryBuilder::tableName(traits),
+                BatchedEvent<std::string> {
+                    std::move(tuple), batchedEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits)});
+
+            return;
+        }
+
+        if (_copy_buffer)
+        {
+            // rows are held per table until the COPY stream for that table is
+            // opened on the next flush
+            auto table_name = QueryBuilder::tableName(traits);
+
+            auto row = _query_builder.storeDataEventCopyRow<T>(
+                _conf_id_cache->value(full_attr_name), event_time, quality, value_r, value_w, traits);
+
+            auto full = _copy_buffer->add(table_name,
+                BatchedEvent<CopyRow> {
+                    std::move(row), batchedEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits)});
+
+            if (full)
+                flushCopy(table_name);
+
+            for (auto &expired : _copy_buffer->expiredTables())
+                flushCopy(expired);
+
+            return;
+        }
+
+        if (!_statements.supported(traits))
+        {
+            std::string msg {"Unable to store data events of unsupported type: " + tangoEnumToString(traits.type()) +
+                ", for attribute: [" + full_attr_name + "]"};
+
+            spdlog::error("Error: {}", msg);
+            Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
+        }
+
+        if (_db_store_method == DbStoreMethod::Pipeline && _libpq_conn->inPipelineMode())
+        {
+            storePipelined<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+            return;
+        }
+
+        if (_batch_buffer)
+        {
+            // batched events are built into a row of values for a multi-row insert,
+            // all rows for a table are stored together when the batch is full
+            auto table_name = QueryBuilder::tableName(traits);
+
+            std::string row;
+
+            _query_builder.storeDataEventValuesString<T>(
+                row, _conf_id_cache->value(full_attr_name), event_time, quality, value_r, value_w, traits);
+
+            auto full = _batch_buffer->add(table_name,
+                BatchedEvent<std::string> {std::move(row),
+                    batchedEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits)});
+
+            if (full)
+                flushBatch(table_name);
+
+            // age out any tables that have been waiting too long
+            for (auto &expired : _batch_buffer->expiredTables())
+                flushBatch(expired);
+
+            return;
+        }
+
+        // the statement logged should the store fail, which depends on the branch taken
+        auto failed_query = [&, this]() -> const std::string & {
+            if (_db_store_method == DbStoreMethod::InsertString ||
+                (traits.isArray() && traits.type() == Tango::DEV_STRING))
+                return _query_buffer;
+
+            if (_array_packing && value_packing::packable<T>(traits))
+                return _query_builder.storeDataEventPackedStatement(traits);
+
+            return _statements.handle(traits).statement;
+        };
+
         try
         {
             return pqxx::perform([&, this]() {
@@ -129,30 +373,69 @@ namespace pqxx_conn
                 if (_db_store_method == DbStoreMethod::InsertString ||
                     (traits.isArray() && traits.type() == Tango::DEV_STRING))
                 {
-                    auto query = _query_builder.storeDataEventString<T>(
-                        pqxx::to_string(_conf_id_cache->value(full_attr_name)),
-                        pqxx::to_string(event_time),
-                        pqxx::to_string(quality),
+                    // the statement is built in the reused query buffer, so once the buffer has
+                    // grown to fit the largest event no further allocation is needed
+                    _query_buffer.clear();
+
+                    _query_builder.storeDataEventString<T>(_query_buffer,
+                        _conf_id_cache->value(full_attr_name),
+                        event_time,
+                        quality,
                         value_r,
                         value_w,
                         traits);
 
-                    tx.exec0(query);
+                    tx.exec0(_query_buffer);
+                }
+                else if (_array_packing && value_packing::packable<T>(traits))
+                {
+                    // packed values have their own statement, registered on first use
+                    const auto &name = _query_builder.storeDataEventPackedName(traits);
+
+                    if (!tx.prepared(name).exists())
+                    {
+                        tx.conn().prepare(name, _query_builder.storeDataEventPackedStatement(traits));
+                        spdlog::trace("Created prepared statement for: {}", name);
+                    }
+
+                    auto inv = tx.prepared(name);
+
+                    // as below, an empty value is stored as a null
+                    auto store_value = [&inv](auto &value) {
+                        if (value && value->size() > 0)
+                            store_data_utils::StorePacked<T>::run(value, inv);
+                        else
+                            inv();
+                    };
+
+                    inv(_conf_id_cache->value(full_attr_name));
+                    inv(event_time);
+
+                    if (traits.hasReadData())
+                        store_value(value_r);
+
+                    if (traits.hasWriteData())
+                        store_value(value_w);
+
+                    inv(quality);
+                    inv.exec();
                 }
                 else
                 {
-                    // prepare as a prepared statement, we are going to use these
-                    // queries often
-                    if (!tx.prepared(_query_builder.storeDataEventName(traits)).exists())
+                    // register the prepared statement on first use, we are going to use
+                    // these queries often
+                    auto &handle = _statements.handle(traits);
+
+                    if (!handle.registered)
                     {
-                        tx.conn().prepare(_query_builder.storeDataEventName(traits),
-                            _query_builder.storeDataEventStatement<T>(traits));
+                        tx.conn().prepare(handle.name, handle.statement);
+                        handle.registered = true;
                     }
 
                     // get the pqxx prepared statement invocation object to allow us to
                     // bind each parameter in turn, this gives us the flexibility to bind
                     // conditional parameters (as long as the query string matches)
-                    auto inv = tx.prepared(_query_builder.storeDataEventName(traits));
+                    auto inv = tx.prepared(handle.name);
 
                     // this lambda stores the data value correctly into the invocation,
                     // we must treat scalar/spectrum in different ways, one is a single
@@ -192,11 +475,452 @@ namespace pqxx_conn
                 tx.commit();
             });
         }
+        catch (const pqxx::broken_connection &ex)
+        {
+            // the database is unreachable, so keep the event to be replayed later
+            if (!_journal || _in_replay)
+            {
+                handlePqxxError("The attribute [" + full_attr_name + "] data event was not saved.",
+                    ex.what(),
+                    failed_query(),
+                    LOCATION_INFO);
+            }
+
+            spdlog::warn("Lost the database connection, journaling the attribute [{}] data event", full_attr_name);
+            journalDataEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+        }
         catch (const pqxx::pqxx_exception &ex)
         {
             handlePqxxError("The attribute [" + full_attr_name + "] data event was not saved.",
                 ex.base().what(),
-                _query_builder.storeDataEventStatement<T>(traits),
+                failed_query(),
+                LOCATION_INFO);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::storeDataEventView(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        const ValueView<T> &value_r,
+        const ValueView<T> &value_w,
+        const AttributeTraits &traits)
+    {
+        // the values are only encoded in place while the binary copy has a healthy
+        // connection, journaling, replay and reconnection are left to storeDataEvent()
+        if (!_binary_buffer || (_journal && (_in_replay || connectionLost() || !_journal->empty())))
+        {
+            auto copy = [](const ValueView<T> &view) {
+                auto value = PayloadPool<T>::acquire();
+                value->assign(view.begin(), view.end());
+                return value;
+            };
+
+            storeDataEvent<T>(full_attr_name, event_time, quality, copy(value_r), copy(value_w), traits);
+            return;
+        }
+
+        assert(!full_attr_name.empty());
+        assert(traits.isValid());
+
+        spdlog::trace("Storing data event view for attribute {} with traits {}, value_r valid: {}, value_w valid: {}",
+            full_attr_name,
+            traits,
+            !value_r.empty(),
+            !value_w.empty());
+
+        if (_deadband_filter && !_deadband_filter->accept<T>(full_attr_name, event_time, quality, value_r, value_w))
+        {
+            spdlog::trace("Data event for attribute {} is inside its deadband and was not stored", full_attr_name);
+            return;
+        }
+
+        // as storeDataEvent(), the attribute is reset should the event not be stored
+        try
+        {
+            checkConnection(LOCATION_INFO);
+            checkAttributeExists(full_attr_name, LOCATION_INFO);
+
+            // size the tuple for the widest encoding of the elements, a numeric, so it is
+            // written without reallocating
+            std::string tuple;
+            tuple.reserve(64 + (value_r.size() + value_w.size()) * (sizeof(T) + 12));
+
+            binary_copy::appendDataEventTuple<T>(tuple,
+                _conf_id_cache->value(full_attr_name),
+                event_time,
+                quality,
+                value_r,
+                value_w,
+                traits,
+                _domain_oids);
+
+            addBinaryTuple(QueryBuilder::tableName(traits),
+                BatchedEvent<std::string> {std::move(tuple),
+                    batchedEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits)});
+        }
+        catch (...)
+        {
+            if (_deadband_filter)
+                _deadband_filter->reset(full_attr_name);
+
+            throw;
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::storePipelined(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        auto &handle = _statements.handle(traits);
+
+        // requests are queued before they are sent, so should a send fail, those
+        // queued for this event are removed again
+        auto queued = _pipelined.size();
+
+        try
+        {
+            // the prepare is pipelined too, so any error arrives with the results
+            if (!handle.pipelined)
+            {
+                _pipelined.push_back(PipelinedRequest {handle.name, JournalRecord {}});
+                _libpq_conn->sendPrepare(handle.name, handle.statement, handle.name);
+                handle.pipelined = true;
+                spdlog::trace("Created pipelined prepared statement for: {}", handle.name);
+            }
+
+            // params are sent as text, in the same form as a COPY field, since neither
+            // is parsed as part of a query and so neither needs quoting
+            auto conf_id = pqxx::to_string(_conf_id_cache->value(full_attr_name));
+            auto time = pqxx::to_string(event_time);
+            auto quality_str = pqxx::to_string(quality);
+            std::string read_str;
+            std::string write_str;
+
+            std::vector<const char *> params {conf_id.c_str(), time.c_str()};
+
+            // an empty value is stored as a null, as in the prepared statement path
+            auto add_value = [&traits, &params](auto &value, std::string &text) {
+                if (value && !value->empty())
+                {
+                    text = query_utils::DataToCopyString<T>::run(value, traits);
+                    params.push_back(text.c_str());
+                }
+                else
+                {
+                    params.push_back(nullptr);
+                }
+            };
+
+            if (traits.hasReadData())
+                add_value(value_r, read_str);
+
+            if (traits.hasWriteData())
+                add_value(value_w, write_str);
+
+            params.push_back(quality_str.c_str());
+
+            // the event is kept until its result arrives
+            _pipelined.push_back(PipelinedRequest {
+                std::string {}, batchedEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits)});
+
+            _libpq_conn->sendPrepared(handle.name, params, full_attr_name);
+        }
+        catch (const pqxx::broken_connection &ex)
+        {
+            _pipelined.resize(queued);
+
+            // the events already in the pipeline are journaled, this event is journaled
+            // on its own so a failure to do so is reported to this caller
+            journalPipeline(ex.what());
+
+            if (!_journal || _in_replay)
+            {
+                handlePqxxError("The attribute [" + full_attr_name + "] data event was not saved.",
+                    ex.what(),
+                    _statements.handle(traits).statement,
+                    LOCATION_INFO);
+            }
+
+            spdlog::warn("Lost the database connection, journaling the attribute [{}] data event", full_attr_name);
+            journalDataEvent<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+            return;
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            _pipelined.resize(queued);
+
+            handlePqxxError("The attribute [" + full_attr_name + "] data event was not saved.",
+                ex.base().what(),
+                _statements.handle(traits).statement,
+                LOCATION_INFO);
+        }
+
+        collectPipeline(_libpq_conn->pending() >= PipelineDepth);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::journalDataEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        assert(_journal != nullptr);
+
+        if (!_journal->append(
+                journal_utils::makeRecord<T>(full_attr_name, event_time, quality, value_r, value_w, traits)))
+        {
+            std::string msg {"The event journal: " + _journal->path() + " is full. The attribute [" + full_attr_name +
+                "] data event was not saved."};
+
+            spdlog::error("Error: The database is unreachable and the event journal is full");
+            spdlog::error("Throwing storage error with message: \"{}\"", msg);
+            Tango::Except::throw_exception("Storage Error", msg, LOCATION_INFO);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::storeReplayedEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        checkConnection(LOCATION_INFO);
+        checkAttributeExists(full_attr_name, LOCATION_INFO);
+
+        // the event may have been stored before the connection was lost, for example
+        // as part of a batch, so an event already in the table is skipped. The insert
+        // string supports every type, so arrays are stored unpacked
+        _query_buffer.clear();
+
+        _query_builder.storeDataEventString<T>(
+            _query_buffer, _conf_id_cache->value(full_attr_name), event_time, quality, value_r, value_w, traits);
+
+        _query_buffer += QueryBuilder::storeDataEventSkipStored();
+
+        try
+        {
+            pqxx::perform([&, this]() {
+                pqxx::work tx {(*_conn), StoreDataEvent};
+                tx.exec0(_query_buffer);
+                tx.commit();
+            });
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("The journaled attribute [" + full_attr_name + "] data event was not saved.",
+                ex.base().what(),
+                _query_buffer,
+                LOCATION_INFO);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    JournalRecord DbConnection::batchedEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        // replayed events are never journaled again, see journalBatch()
+        if (_journal && !_in_replay)
+            return journal_utils::makeRecord<T>(full_attr_name, event_time, quality, value_r, value_w, traits);
+
+        JournalRecord event;
+        event.attr_name = full_attr_name;
+        event.traits = traits;
+        event.event_time = event_time;
+        event.quality = quality;
+        return event;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    JournalRecord DbConnection::batchedEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        const ValueView<T> &value_r,
+        const ValueView<T> &value_w,
+        const AttributeTraits &traits)
+    {
+        JournalRecord event;
+        event.attr_name = full_attr_name;
+        event.traits = traits;
+        event.event_time = event_time;
+        event.quality = quality;
+
+        // as above, the values are only encoded when they may be journaled
+        if (_journal && !_in_replay)
+        {
+            journal_utils::appendValues<T>(event.values, value_r.begin(), value_r.end(), value_r.size());
+            journal_utils::appendValues<T>(event.values, value_w.begin(), value_w.end(), value_w.size());
+        }
+
+        return event;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename TIter>
+    void DbConnection::journalBatch(TIter begin, TIter end, const std::string &table_name, const std::string &what)
+    {
+        auto count = std::distance(begin, end);
+
+        if (!_journal || _in_replay)
+        {
+            // the deadband filter compares later events with these, as if they were stored
+            if (_deadband_filter)
+                for (auto iter = begin; iter != end; ++iter)
+                    _deadband_filter->reset(iter->event.attr_name);
+
+            handlePqxxError("The batch of " + std::to_string(count) + " data events for table [" + table_name +
+                    "] was not saved.",
+                what,
+                "Batched data events",
+                LOCATION_INFO);
+        }
+
+        spdlog::warn("Lost the database connection, journaling {} batched data events for table {}", count, table_name);
+
+        std::size_t refused = 0;
+
+        for (auto iter = begin; iter != end; ++iter)
+        {
+            if (!_journal->append(iter->event))
+            {
+                refused++;
+
+                if (_deadband_filter)
+                    _deadband_filter->reset(iter->event.attr_name);
+            }
+        }
+
+        if (refused > 0)
+        {
+            std::string msg {"The event journal: " + _journal->path() + " is full. " + std::to_string(refused) +
+                " batched data events for table [" + table_name + "] were not saved."};
+
+            spdlog::error("Error: The database is unreachable and the event journal is full");
+            spdlog::error("Throwing storage error with message: \"{}\"", msg);
+            Tango::Except::throw_exception("Storage Error", msg, LOCATION_INFO);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void DbConnection::fetchDataEvents(const std::string &full_attr_name,
+        double start_time,
+        double end_time,
+        const std::function<void(const DataEventChunk<T> &)> &callback,
+        std::size_t chunk_size)
+    {
+        assert(!full_attr_name.empty());
+        assert(_conn != nullptr);
+        assert(_conf_id_cache != nullptr);
+        assert(chunk_size > 0);
+
+        checkConnection(LOCATION_INFO);
+        checkAttributeExists(full_attr_name, LOCATION_INFO);
+
+        // the table, and how its values are decoded, depend on the archived traits
+        auto traits = fetchAttributeTraits(full_attr_name);
+
+        // the values of another type would either be converted, or fail part way through
+        if (!fetch_data_utils::archivedAs<T>(traits.type()))
+        {
+            std::string msg {"The attribute [" + full_attr_name + "] is archived as " +
+                tangoEnumToString(traits.type()) + ", its data events can not be fetched as another type"};
+
+            spdlog::error("Error: {}", msg);
+            Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+        }
+
+        // rows may have been stored packed in any run with packing enabled, so the packed
+        // columns are read whenever the table has them, and each row decoded from whichever
+        // of its columns is set
+        auto packed = value_packing::packable<T>(traits) && _packed_tables.count(QueryBuilder::tableName(traits)) > 0;
+
+        auto query = QueryBuilder::fetchDataEventsStatement(
+            traits, _conf_id_cache->value(full_attr_name), start_time, end_time, packed);
+
+        spdlog::trace("Fetching data events for attribute: {} with traits: {}, between: {} and: {}",
+            full_attr_name,
+            traits,
+            start_time,
+            end_time);
+
+        DataEventChunk<T> chunk;
+
+        // array values are parsed, or unpacked, into this before joining the value columns
+        std::vector<T> scratch;
+
+        try
+        {
+            // the transaction is not run by pqxx::perform(), since a retry would pass the
+            // chunks already returned to the callback a second time
+            pqxx::read_transaction tx {(*_conn), FetchDataEvents};
+            pqxx::icursorstream cursor {
+                tx, query, FetchDataEvents, static_cast<pqxx::cursor_base::difference_type>(chunk_size)};
+            pqxx::result result;
+
+            while (cursor >> result)
+            {
+                chunk.clear();
+
+                for (const auto &row : result)
+                {
+                    chunk.data_time.push_back(row[0].as<double>());
+                    fetch_data_utils::appendValues(row[1], traits, chunk.value_r, scratch);
+                    fetch_data_utils::appendValues(row[2], traits, chunk.value_w, scratch);
+                    chunk.quality.push_back(row[3].as<int>());
+
+                    if (packed)
+                    {
+                        fetch_data_utils::unpackValues(row[4], chunk.value_r, chunk.value_r_offsets.back(), scratch);
+                        fetch_data_utils::unpackValues(row[5], chunk.value_w, chunk.value_w_offsets.back(), scratch);
+                    }
+
+                    chunk.value_r_offsets.push_back(chunk.value_r.size());
+                    chunk.value_w_offsets.push_back(chunk.value_w.size());
+                }
+
+                callback(chunk);
+            }
+        }
+        catch (const pqxx::conversion_error &ex)
+        {
+            // a value that can not be decoded, which is not a pqxx_exception
+            handlePqxxError("Can not decode the data events for attribute [" + full_attr_name + "].",
+                ex.what(),
+                query,
+                LOCATION_INFO);
+        }
+        catch (const pqxx::pqxx_exception &ex)
+        {
+            handlePqxxError("Can not fetch the data events for attribute [" + full_attr_name + "].",
+                ex.base().what(),
+                query,
                 LOCATION_INFO);
         }
     }
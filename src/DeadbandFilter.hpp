@@ -0,0 +1,309 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _DEADBAND_FILTER_HPP
+#define _DEADBAND_FILTER_HPP
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace hdbpp_internal
+{
+// The DeadbandFilter drops data events that repeat, or change by less than the archive
+// thresholds of, the last event stored for their attribute. The thresholds are the
+// archive_abs_change, archive_rel_change and archive_period of the attribute's parameter
+// events, as they are applied by Tango, so an event is stored when any value moves by at
+// least the absolute or relative change, or archive_period has passed since the last
+// stored event. A change of quality, including to an invalid event without values, is
+// always stored.
+//
+// Only attributes with an absolute or relative change are filtered. Their last stored
+// values are kept as raw bytes, so the filter holds no more than one event per attribute
+// and needs no allocation once it has seen each attribute. Values that are not numbers,
+// for example strings, are only dropped when they repeat exactly.
+class DeadbandFilter
+{
+public:
+    // set the thresholds for an attribute from the text of its parameter event, a value
+    // is either a single change, or a lower and upper change separated by a comma. Any
+    // value Tango does not specify is ignored, and when neither change is specified the
+    // attribute is no longer filtered
+    void configure(const std::string &full_attr_name,
+        const std::string &archive_abs_change,
+        const std::string &archive_rel_change,
+        const std::string &archive_period)
+    {
+        Thresholds thresholds;
+
+        thresholds.has_abs = parseChange(archive_abs_change, thresholds.abs_lower, thresholds.abs_upper);
+        thresholds.has_rel = parseChange(archive_rel_change, thresholds.rel_lower, thresholds.rel_upper);
+
+        // the period is in milliseconds, event times are in seconds
+        double period = 0;
+
+        if (parseNumber(archive_period, period) && period > 0)
+            thresholds.period = period / 1000.0;
+
+        if (!thresholds.has_abs && !thresholds.has_rel)
+        {
+            _entries.erase(full_attr_name);
+            return;
+        }
+
+        // the last stored event is kept, the next event is compared to it under the new thresholds
+        _entries[full_attr_name].thresholds = thresholds;
+    }
+
+    // returns true when the event should be stored, and if so it becomes the last stored
+    // event of the attribute. The values may be any container of T, such as a vector or
+    // a ValueView
+    template<typename T, typename Container>
+    bool accept(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        const Container &value_r,
+        const Container &value_w)
+    {
+        auto entry = _entries.find(full_attr_name);
+
+        if (entry == _entries.end())
+            return true;
+
+        auto &last = entry->second;
+
+        encode<T>(value_r, _value_r);
+        encode<T>(value_w, _value_w);
+
+        auto store = !last.stored || quality != last.quality ||
+            (last.thresholds.period > 0 && event_time - last.time >= last.thresholds.period) ||
+            changed<T>(last.thresholds, last.value_r, _value_r) || changed<T>(last.thresholds, last.value_w, _value_w);
+
+        if (!store)
+        {
+            _dropped++;
+            return false;
+        }
+
+        last.stored = true;
+        last.time = event_time;
+        last.quality = quality;
+
+        // the buffers are swapped, so the previous values become the next scratch space
+        last.value_r.swap(_value_r);
+        last.value_w.swap(_value_w);
+        return true;
+    }
+
+    // forget the last stored event of an attribute, so its next event is stored. Used
+    // when an event is stored another way, for example as an error
+    void reset(const std::string &full_attr_name)
+    {
+        auto entry = _entries.find(full_attr_name);
+
+        if (entry != _entries.end())
+            entry->second.stored = false;
+    }
+
+    // number of attributes being filtered, and events dropped so far
+    std::size_t size() const noexcept { return _entries.size(); }
+    std::size_t dropped() const noexcept { return _dropped; }
+
+private:
+    struct Thresholds
+    {
+        bool has_abs = false;
+        bool has_rel = false;
+
+        // the lower change is negative
+        double abs_lower = 0;
+        double abs_upper = 0;
+        double rel_lower = 0;
+        double rel_upper = 0;
+
+        // seconds, 0 when not set
+        double period = 0;
+    };
+
+    struct Entry
+    {
+        Thresholds thresholds;
+
+        // the last stored event, none has been stored while stored is false
+        bool stored = false;
+        double time = 0;
+        int quality = 0;
+        std::string value_r;
+        std::string value_w;
+    };
+
+    //=============================================================================
+    //=============================================================================
+    static bool parseNumber(const std::string &text, double &value)
+    {
+        char *end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+
+        // Tango fills unset values with text, for example "Not specified"
+        return end != text.c_str() && *end == '\0' && std::isfinite(value);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    static bool parseChange(const std::string &text, double &lower, double &upper)
+    {
+        auto separator = text.find(',');
+
+        if (separator == std::string::npos)
+        {
+            if (!parseNumber(text, upper))
+                return false;
+
+            upper = std::fabs(upper);
+            lower = -upper;
+            return true;
+        }
+
+        if (!parseNumber(text.substr(0, separator), lower) || !parseNumber(text.substr(separator + 1), upper))
+            return false;
+
+        lower = -std::fabs(lower);
+        upper = std::fabs(upper);
+        return true;
+    }
+
+    // the raw bytes of the values, numbers and bools at their size and strings as their
+    // length then characters, so they are kept without an allocation per element
+    template<typename T, typename Container>
+    static typename std::enable_if<!std::is_same<T, std::string>::value>::type encode(
+        const Container &values, std::string &out)
+    {
+        out.resize(values.size() * sizeof(T));
+        std::size_t offset = 0;
+
+        for (auto iter = values.begin(); iter != values.end(); ++iter, offset += sizeof(T))
+        {
+            T value = *iter;
+            std::memcpy(&out[offset], &value, sizeof(T));
+        }
+    }
+
+    template<typename T, typename Container>
+    static typename std::enable_if<std::is_same<T, std::string>::value>::type encode(
+        const Container &values, std::string &out)
+    {
+        out.clear();
+
+        for (const auto &value : values)
+        {
+            auto length = value.size();
+            out.append(reinterpret_cast<const char *>(&length), sizeof(length));
+            out.append(value);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    static bool changed(const Thresholds &thresholds, const std::string &last, const std::string &current)
+    {
+        if (last.size() != current.size())
+            return true;
+
+        if (last == current)
+            return false;
+
+        return changed<T>(thresholds,
+            last,
+            current,
+            std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value> {});
+    }
+
+    // numbers have changed when any element has moved by at least a threshold
+    template<typename T>
+    static bool changed(
+        const Thresholds &thresholds, const std::string &last, const std::string &current, std::true_type /*unused*/)
+    {
+        for (std::size_t offset = 0; offset < current.size(); offset += sizeof(T))
+        {
+            T last_value;
+            T value;
+            std::memcpy(&last_value, &last[offset], sizeof(T));
+            std::memcpy(&value, &current[offset], sizeof(T));
+
+            if (exceeds(thresholds, static_cast<double>(last_value), static_cast<double>(value)))
+                return true;
+        }
+
+        return false;
+    }
+
+    // anything else has changed when it differs at all
+    template<typename T>
+    static bool changed(const Thresholds & /*unused*/,
+        const std::string & /*unused*/,
+        const std::string & /*unused*/,
+        std::false_type /*unused*/)
+    {
+        return true;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    static bool exceeds(const Thresholds &thresholds, double last, double value)
+    {
+        if (std::isnan(last) || std::isnan(value))
+            return std::isnan(last) != std::isnan(value);
+
+        if (value == last)
+            return false;
+
+        auto delta = value - last;
+
+        if (thresholds.has_abs && (delta >= thresholds.abs_upper || delta <= thresholds.abs_lower))
+            return true;
+
+        if (thresholds.has_rel)
+        {
+            // any change from zero is an infinite relative change
+            if (last == 0)
+                return true;
+
+            auto percent = delta / std::fabs(last) * 100.0;
+
+            if (percent >= thresholds.rel_upper || percent <= thresholds.rel_lower)
+                return true;
+        }
+
+        return false;
+    }
+
+    std::unordered_map<std::string, Entry> _entries;
+
+    // scratch space for the values of the event being checked
+    std::string _value_r;
+    std::string _value_w;
+
+    std::size_t _dropped = 0;
+};
+} // namespace hdbpp_internal
+#endif // _DEADBAND_FILTER_HPP
@@ -0,0 +1,335 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "EventJournal.hpp"
+
+#include "LibUtils.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace hdbpp_internal
+{
+namespace
+{
+    // the header is the magic string followed by the replay offset,
+    // padded so records start on a cache line
+    const char JournalMagic[] = "HDBPPJ01";
+    const size_t MagicSize = 8;
+    const size_t ReadOffsetPos = 8;
+    const size_t HeaderSize = 64;
+
+    // fixed part of a record body: write type, format, type, padding,
+    // event time, quality, then the name and values lengths
+    const size_t RecordFixedSize = 4 + sizeof(double) + sizeof(int32_t) + 2 * sizeof(uint32_t);
+
+    //=============================================================================
+    //=============================================================================
+    void throwJournalError(const string &msg, const string &path, int error)
+    {
+        string full_msg {msg + " for journal: " + path + ". Error: " + strerror(error)};
+        spdlog::error("Error: {}", full_msg);
+        Tango::Except::throw_exception("Journal Error", full_msg, LOCATION_INFO);
+    }
+} // namespace
+
+//=============================================================================
+//=============================================================================
+EventJournal::EventJournal(const string &path, size_t capacity) : _path(path), _capacity(capacity)
+{
+    if (_capacity <= HeaderSize + RecordFixedSize)
+    {
+        string msg {"The journal capacity is too small: " + to_string(_capacity) + " bytes"};
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    _fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (_fd < 0)
+        throwJournalError("Failed to open", _path, errno);
+
+    struct stat st
+    {};
+
+    if (fstat(_fd, &st) != 0)
+    {
+        auto error = errno;
+        close(_fd);
+        throwJournalError("Failed to stat", _path, error);
+    }
+
+    auto existing = static_cast<size_t>(st.st_size);
+
+    // an existing journal is never shrunk, since it may hold events, but it
+    // is grown to the requested capacity. The new space reads as zero
+    if (existing > _capacity)
+        _capacity = existing;
+    else if (existing < _capacity && ftruncate(_fd, static_cast<off_t>(_capacity)) != 0)
+    {
+        auto error = errno;
+        close(_fd);
+        throwJournalError("Failed to allocate", _path, error);
+    }
+
+    auto *map = mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+    if (map == MAP_FAILED)
+    {
+        auto error = errno;
+        close(_fd);
+        throwJournalError("Failed to map", _path, error);
+    }
+
+    _map = static_cast<char *>(map);
+
+    if (existing == 0)
+    {
+        memcpy(_map, JournalMagic, MagicSize);
+        writeReadOffset(HeaderSize);
+    }
+    else if (memcmp(_map, JournalMagic, MagicSize) != 0)
+    {
+        munmap(_map, _capacity);
+        close(_fd);
+
+        string msg {"The file: " + _path + " is not an event journal"};
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Journal Error", msg, LOCATION_INFO);
+    }
+
+    uint64_t read_offset;
+    memcpy(&read_offset, _map + ReadOffsetPos, sizeof(read_offset));
+    _read_offset = read_offset < HeaderSize || read_offset >= _capacity ? HeaderSize : read_offset;
+
+    // find the end of the journal, and count the records waiting on the way
+    JournalRecord record;
+    _write_offset = _read_offset;
+
+    for (size_t next; readRecord(_write_offset, record, next); _write_offset = next)
+        _records++;
+
+    spdlog::info("Opened event journal: {} with {} records waiting to be replayed", _path, _records);
+}
+
+//=============================================================================
+//=============================================================================
+EventJournal::~EventJournal()
+{
+    msync(_map, _capacity, MS_SYNC);
+    munmap(_map, _capacity);
+    close(_fd);
+}
+
+//=============================================================================
+//=============================================================================
+bool EventJournal::append(const JournalRecord &record)
+{
+    string body;
+    body.reserve(RecordFixedSize + record.attr_name.size() + record.values.size());
+
+    body += static_cast<char>(record.traits.writeType());
+    body += static_cast<char>(record.traits.formatType());
+    body += static_cast<char>(record.traits.type());
+    body += '\0';
+
+    int32_t quality = record.quality;
+    body.append(reinterpret_cast<const char *>(&record.event_time), sizeof(double));
+    body.append(reinterpret_cast<const char *>(&quality), sizeof(quality));
+
+    journal_utils::Element<string>::write(body, record.attr_name);
+    journal_utils::Element<string>::write(body, record.values);
+
+    lock_guard<mutex> lock(_mutex);
+
+    // space for the length, the body, and the zero length that ends the journal
+    if (_write_offset + 2 * sizeof(uint32_t) + body.size() > _capacity)
+        return false;
+
+    auto offset = _write_offset;
+    memcpy(_map + offset + sizeof(uint32_t), body.data(), body.size());
+    writeLength(offset + sizeof(uint32_t) + body.size(), 0);
+
+    // publishing the length last makes the record visible
+    writeLength(offset, static_cast<uint32_t>(body.size()));
+
+    _write_offset = offset + sizeof(uint32_t) + body.size();
+    _records++;
+    return true;
+}
+
+//=============================================================================
+//=============================================================================
+vector<JournalRecord> EventJournal::beginReplay(size_t max_records)
+{
+    vector<JournalRecord> records;
+    lock_guard<mutex> lock(_mutex);
+
+    if (_replaying)
+        return records;
+
+    auto offset = _read_offset;
+    JournalRecord record;
+    _replay_ends.clear();
+
+    for (size_t next; records.size() < max_records && offset < _write_offset && readRecord(offset, record, next);
+         offset = next)
+    {
+        records.push_back(move(record));
+        _replay_ends.push_back(next);
+    }
+
+    _replaying = !records.empty();
+    return records;
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::endReplay(bool consumed)
+{
+    lock_guard<mutex> lock(_mutex);
+    endReplayLocked(consumed ? _replay_ends.size() : 0);
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::endReplay(size_t consumed)
+{
+    lock_guard<mutex> lock(_mutex);
+    endReplayLocked(consumed);
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::endReplayLocked(size_t consumed)
+{
+    if (!_replaying)
+        return;
+
+    _replaying = false;
+    consumed = min(consumed, _replay_ends.size());
+
+    if (consumed == 0)
+        return;
+
+    _read_offset = _replay_ends[consumed - 1];
+    _records -= consumed;
+
+    // once everything has been replayed start again from the beginning, the
+    // zero length at the start ends the journal should we crash before the
+    // read offset is updated
+    if (_read_offset == _write_offset)
+    {
+        writeLength(HeaderSize, 0);
+        _read_offset = HeaderSize;
+        _write_offset = HeaderSize;
+    }
+
+    writeReadOffset(_read_offset);
+    msync(_map, HeaderSize, MS_ASYNC);
+}
+
+//=============================================================================
+//=============================================================================
+size_t EventJournal::size() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _records;
+}
+
+//=============================================================================
+//=============================================================================
+bool EventJournal::readRecord(size_t offset, JournalRecord &record, size_t &next) const
+{
+    if (offset + sizeof(uint32_t) > _capacity)
+        return false;
+
+    auto length = readLength(offset);
+
+    if (length < RecordFixedSize || offset + sizeof(uint32_t) + length > _capacity)
+        return false;
+
+    string body(_map + offset + sizeof(uint32_t), length);
+    size_t pos = 4;
+
+    record.traits = AttributeTraits(static_cast<Tango::AttrWriteType>(static_cast<uint8_t>(body[0])),
+        static_cast<Tango::AttrDataFormat>(static_cast<uint8_t>(body[1])),
+        static_cast<Tango::CmdArgType>(static_cast<uint8_t>(body[2])));
+
+    // the fixed fields fit in the body, but each variable length field is checked against
+    // what remains of it, and the values must end the body, a corrupt record ends the
+    // journal rather than being read past
+    auto end = body.size();
+
+    if (!journal_utils::Element<double>::read(body, pos, end, record.event_time) ||
+        !journal_utils::Element<int32_t>::read(body, pos, end, record.quality) ||
+        !journal_utils::Element<string>::read(body, pos, end, record.attr_name) ||
+        !journal_utils::Element<string>::read(body, pos, end, record.values) || pos != end)
+    {
+        return false;
+    }
+
+    next = offset + sizeof(uint32_t) + length;
+    return true;
+}
+
+//=============================================================================
+//=============================================================================
+uint32_t EventJournal::readLength(size_t offset) const
+{
+    uint32_t length;
+    memcpy(&length, _map + offset, sizeof(length));
+    return length;
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::writeLength(size_t offset, uint32_t length)
+{
+    if (offset + sizeof(length) <= _capacity)
+        memcpy(_map + offset, &length, sizeof(length));
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::writeReadOffset(size_t offset)
+{
+    uint64_t read_offset = offset;
+    memcpy(_map + ReadOffsetPos, &read_offset, sizeof(read_offset));
+}
+
+//=============================================================================
+//=============================================================================
+void EventJournal::print(ostream &os) const noexcept
+{
+    lock_guard<mutex> lock(_mutex);
+
+    os << "EventJournal(_path: " << _path << ", "
+       << "_capacity: " << _capacity << ", "
+       << "_records: " << _records << ", "
+       << "_read_offset: " << _read_offset << ", "
+       << "_write_offset: " << _write_offset << ")";
+}
+} // namespace hdbpp_internal
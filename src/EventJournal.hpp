@@ -0,0 +1,278 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _EVENT_JOURNAL_HPP
+#define _EVENT_JOURNAL_HPP
+
+#include "AttributeTraits.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// A data event held in the journal. The attribute is kept by name rather than
+// database id, since events may be journaled by threads without access to a
+// connection. The values are encoded with journal_utils::appendValues()
+struct JournalRecord
+{
+    std::string attr_name;
+    AttributeTraits traits;
+    double event_time = 0;
+    int quality = 0;
+    std::string values;
+};
+
+// The EventJournal is an append-only, memory mapped file of data events that could not
+// be stored, either because the database was unreachable or because the write behind
+// queue overflowed. Records survive a restart of the process, and are handed out in
+// batches for replay once the database is back. The file is allocated to its full
+// capacity on creation, and once it is full further events are refused.
+//
+// Each record is a 32 bit length followed by the record body. The length is written
+// last, and the length word after the record is always zero, so a record interrupted
+// by a crash is never read back. The file header holds the offset replay has reached.
+//
+// All functions are thread safe.
+class EventJournal
+{
+public:
+    EventJournal(const std::string &path, std::size_t capacity);
+    ~EventJournal();
+
+    EventJournal(const EventJournal &) = delete;
+    EventJournal &operator=(const EventJournal &) = delete;
+
+    // add a record to the end of the journal, returns false if there is no space
+    bool append(const JournalRecord &record);
+
+    // Hand out up to max_records of the oldest records for replay. Only a single replay
+    // may be in progress, if another is running nothing is returned. Every call that
+    // returns records must be followed by endReplay(), consumed is true when the records
+    // are no longer required, otherwise they are handed out again on the next replay.
+    // Alternatively consumed is the number of records, oldest first, no longer required,
+    // and the rest are handed out again
+    std::vector<JournalRecord> beginReplay(std::size_t max_records);
+    void endReplay(bool consumed);
+    void endReplay(std::size_t consumed);
+
+    // number of records waiting to be replayed
+    std::size_t size() const;
+    bool empty() const { return size() == 0; }
+
+    std::size_t capacity() const noexcept { return _capacity; }
+    const std::string &path() const noexcept { return _path; }
+
+    void print(std::ostream &os) const noexcept;
+
+private:
+    void endReplayLocked(std::size_t consumed);
+    bool readRecord(std::size_t offset, JournalRecord &record, std::size_t &next) const;
+    std::uint32_t readLength(std::size_t offset) const;
+    void writeLength(std::size_t offset, std::uint32_t length);
+    void writeReadOffset(std::size_t offset);
+
+    std::string _path;
+    std::size_t _capacity;
+
+    int _fd = -1;
+    char *_map = nullptr;
+
+    mutable std::mutex _mutex;
+
+    // offset of the oldest record not yet replayed, and of the end of the last record
+    std::size_t _read_offset = 0;
+    std::size_t _write_offset = 0;
+    std::size_t _records = 0;
+
+    // when replaying, the offset following each record handed out
+    bool _replaying = false;
+    std::vector<std::size_t> _replay_ends;
+};
+
+// Encoding of the typed values in a journal record. Each value is a presence byte, and
+// when present, a 32 bit element count followed by the elements in host byte order.
+// Strings are written as a 32 bit length and their characters. Reads are bounded by an
+// end offset into the data, and fail rather than read past it, so a corrupt or torn
+// record is refused.
+namespace journal_utils
+{
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    struct Element
+    {
+        static void write(std::string &out, const T &value)
+        {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        static bool read(const std::string &in, std::size_t &pos, std::size_t end, T &value)
+        {
+            assert(end <= in.size());
+
+            if (pos > end || end - pos < sizeof(T))
+                return false;
+
+            std::memcpy(&value, in.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+    };
+
+    template<>
+    struct Element<bool>
+    {
+        static void write(std::string &out, bool value) { out += static_cast<char>(value ? 1 : 0); }
+
+        static bool read(const std::string &in, std::size_t &pos, std::size_t end, bool &value)
+        {
+            assert(end <= in.size());
+
+            if (pos >= end)
+                return false;
+
+            value = in[pos++] != 0;
+            return true;
+        }
+    };
+
+    template<>
+    struct Element<std::string>
+    {
+        static void write(std::string &out, const std::string &value)
+        {
+            Element<std::uint32_t>::write(out, static_cast<std::uint32_t>(value.size()));
+            out += value;
+        }
+
+        static bool read(const std::string &in, std::size_t &pos, std::size_t end, std::string &value)
+        {
+            std::uint32_t length = 0;
+
+            if (!Element<std::uint32_t>::read(in, pos, end, length) || length > end - pos)
+                return false;
+
+            value = in.substr(pos, length);
+            pos += length;
+            return true;
+        }
+    };
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T, typename TIter>
+    void appendValues(std::string &out, TIter begin, TIter end, std::size_t size)
+    {
+        if (size == 0)
+        {
+            out += '\0';
+            return;
+        }
+
+        out += '\1';
+        Element<std::uint32_t>::write(out, static_cast<std::uint32_t>(size));
+
+        // each element is copied out, so vector<bool> is handled by its conversion to bool
+        for (auto iter = begin; iter != end; ++iter)
+        {
+            T element = *iter;
+            Element<T>::write(out, element);
+        }
+    }
+
+    template<typename T>
+    void appendValues(std::string &out, const std::unique_ptr<std::vector<T>> &value)
+    {
+        if (!value)
+        {
+            out += '\0';
+            return;
+        }
+
+        appendValues<T>(out, value->begin(), value->end(), value->size());
+    }
+
+    //=============================================================================
+    //=============================================================================
+    // Read values written by appendValues(), null when they would overrun end, since the
+    // data is corrupt
+    template<typename T>
+    std::unique_ptr<std::vector<T>> readValues(const std::string &in, std::size_t &pos, std::size_t end)
+    {
+        auto value = std::make_unique<std::vector<T>>();
+        auto present = false;
+
+        if (!Element<bool>::read(in, pos, end, present))
+            return nullptr;
+
+        if (!present)
+            return value;
+
+        std::uint32_t count = 0;
+
+        // every element takes at least a byte, so a larger count can not be genuine, and
+        // must not size the vector
+        if (!Element<std::uint32_t>::read(in, pos, end, count) || count > end - pos)
+            return nullptr;
+
+        value->reserve(count);
+
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            T element {};
+
+            if (!Element<T>::read(in, pos, end, element))
+                return nullptr;
+
+            value->push_back(std::move(element));
+        }
+
+        return value;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    JournalRecord makeRecord(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        const std::unique_ptr<std::vector<T>> &value_r,
+        const std::unique_ptr<std::vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        JournalRecord record;
+        record.attr_name = full_attr_name;
+        record.traits = traits;
+        record.event_time = event_time;
+        record.quality = quality;
+
+        appendValues<T>(record.values, value_r);
+        appendValues<T>(record.values, value_w);
+        return record;
+    }
+} // namespace journal_utils
+} // namespace hdbpp_internal
+#endif // _EVENT_JOURNAL_HPP
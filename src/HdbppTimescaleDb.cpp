@@ -19,16 +19,24 @@
 
 #include "hdb++/HdbppTimescaleDb.hpp"
 
+#include "AttributeRegistry.hpp"
 #include "DbConnection.hpp"
 #include "HdbppTxDataEvent.hpp"
 #include "HdbppTxDataEventError.hpp"
 #include "HdbppTxHistoryEvent.hpp"
 #include "HdbppTxNewAttribute.hpp"
 #include "HdbppTxParameterEvent.hpp"
+#include "HdbppTxUpdateTtl.hpp"
+#include "JournalConnection.hpp"
 #include "LibUtils.hpp"
+#include "WriterPool.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <locale>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 using namespace std;
@@ -41,12 +49,65 @@ namespace hdbpp
 // in of different backends at a later point
 unique_ptr<pqxx_conn::DbConnection> Conn;
 
+// optional pool of write behind queues, when allocated it owns the connections and all
+// requests are run on its writer threads. Conn is not used in this case
+unique_ptr<WriterPool<pqxx_conn::DbConnection>> Writers;
+
+// attributes interned on first sight, data events are stored against the record of their
+// attribute rather than parsing its name for every event
+unique_ptr<AttributeRegistry> Registry;
+
+// queue capacity used for the pool when connection_pool_size is set but queue_capacity is not
+const unsigned long DefaultQueueCapacity = 1000;
+
+// optional journal for data events that can not be stored, shared by every connection. The
+// journal connection is used to spill data events from a full queue on the caller's thread
+shared_ptr<EventJournal> Journal;
+unique_ptr<JournalConnection> JournalConn;
+
+// journal size in megabytes used when journal_path is set but journal_size is not
+const unsigned long DefaultJournalSize = 1024;
+
+// time in milliseconds a request may spend reconnecting to the database
+const unsigned long DefaultReconnectBudget = 1000;
+
+// upper limits of the integer config parameters, well beyond any sensible setting, but
+// small enough that a mistyped value is refused rather than exhausting memory or time
+const unsigned long MaxBatchSize = 100000;
+const unsigned long MaxBatchMaxAge = 3600 * 1000;
+const unsigned long MaxQueueCapacity = 10000000;
+const unsigned long MaxConnectionPoolSize = 64;
+const unsigned long MaxReconnectBudget = 600 * 1000;
+const unsigned long MaxChunkTargetSize = 1024 * 1024;
+const unsigned long MaxCompressAfter = 24 * 365 * 10;
+const unsigned long MaxJournalSize = 1024 * 1024;
+
 // simple class to gather utility functions that were previously part of HdbppTimescaleDb,
 // removes them from the header and keeps it clean for includes
 struct HdbppTimescaleDbUtils
 {
     static string getConfigParam(const map<string, string> &conf, const string &param, bool mandatory);
     static map<string, string> extractConfig(vector<string> config, const string &separator);
+
+    // parse the value of an integer config parameter, throwing unless it is made only of
+    // digits and is within [min_value, max_value]
+    static unsigned long parseConfigInteger(
+        const string &param, const string &value, unsigned long min_value, unsigned long max_value);
+
+    // run the task against the connection, via the write behind queues when they are enabled,
+    // in which case the attribute name selects the writer. When wait is false the task may be
+    // queued and errors are not reported to the caller. The spill task is run instead of the
+    // task should it be removed from a full queue under the spill policy
+    static void dispatch(const string &fqdn_attr_name,
+        function<void(pqxx_conn::DbConnection &)> task,
+        bool wait,
+        function<void()> spill_task = nullptr);
+
+    // as above, for a registered attribute whose writer is already known
+    static void dispatch(const AttributeRecord &record,
+        function<void(pqxx_conn::DbConnection &)> task,
+        bool wait,
+        function<void()> spill_task = nullptr);
 };
 
 //=============================================================================
@@ -83,6 +144,84 @@ string HdbppTimescaleDbUtils::getConfigParam(const map<string, string> &conf, co
     return iter == conf.end() ? "" : (*iter).second;
 }
 
+//=============================================================================
+//=============================================================================
+unsigned long HdbppTimescaleDbUtils::parseConfigInteger(
+    const string &param, const string &value, unsigned long min_value, unsigned long max_value)
+{
+    unsigned long result = 0;
+
+    // stoul() accepts a sign and leading spaces, and wraps a negative value around
+    // to a huge one, so only digits are accepted
+    auto valid = !value.empty() && all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+
+    if (valid)
+    {
+        try
+        {
+            result = stoul(value);
+        }
+        catch (const out_of_range &)
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid || result < min_value || result > max_value)
+    {
+        std::string msg {"Configuration parsing error: " + param + ": " + value + " must be an integer from " +
+            to_string(min_value) + " to " + to_string(max_value)};
+
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    return result;
+}
+
+//=============================================================================
+//=============================================================================
+void HdbppTimescaleDbUtils::dispatch(const string &fqdn_attr_name,
+    function<void(pqxx_conn::DbConnection &)> task,
+    bool wait,
+    function<void()> spill_task)
+{
+    if (!Writers)
+    {
+        task(*Conn);
+        return;
+    }
+
+    // shard on the attribute name without the tango host, so differing forms of
+    // the host name still map to the same writer
+    AttributeName attr_name {fqdn_attr_name};
+    auto key = hash<string_view> {}(attr_name.fullAttributeName());
+
+    if (wait)
+        Writers->execute(key, move(task));
+    else
+        Writers->submit(key, move(task), move(spill_task));
+}
+
+//=============================================================================
+//=============================================================================
+void HdbppTimescaleDbUtils::dispatch(const AttributeRecord &record,
+    function<void(pqxx_conn::DbConnection &)> task,
+    bool wait,
+    function<void()> spill_task)
+{
+    if (!Writers)
+    {
+        task(*Conn);
+        return;
+    }
+
+    // the shard is the same hash of the attribute name the named dispatch uses
+    if (wait)
+        Writers->execute(record.shard, move(task));
+    else
+        Writers->submit(record.shard, move(task), move(spill_task));
+}
+
 //=============================================================================
 //=============================================================================
 HdbppTimescaleDb::HdbppTimescaleDb(const vector<string> &configuration)
@@ -146,11 +285,275 @@ HdbppTimescaleDb::HdbppTimescaleDb(const vector<string> &configuration)
     auto connection_string = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "connect_string", true);
     spdlog::info("Mandatory config parameter connect_string: {}", connection_string);
 
-    // allocate a connection to store data with
-    Conn = make_unique<pqxx_conn::DbConnection>(pqxx_conn::DbConnection::DbStoreMethod::PreparedStatement);
+    // store_method optional config parameter ----
+    auto store_method = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "store_method", false));
+    auto db_store_method = pqxx_conn::DbConnection::DbStoreMethod::PreparedStatement;
+
+    if (store_method == "insert_string")
+        db_store_method = pqxx_conn::DbConnection::DbStoreMethod::InsertString;
+    else if (store_method == "copy_stream")
+        db_store_method = pqxx_conn::DbConnection::DbStoreMethod::CopyStream;
+    else if (store_method == "copy_binary")
+        db_store_method = pqxx_conn::DbConnection::DbStoreMethod::CopyBinary;
+    else if (store_method == "pipeline")
+        db_store_method = pqxx_conn::DbConnection::DbStoreMethod::Pipeline;
+    else if (!store_method.empty() && store_method != "prepared_statement")
+    {
+        std::string msg {"Configuration parsing error: unknown store_method: " + store_method};
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    spdlog::info("Config parameter store_method: {}", store_method);
+
+    // batch_size and batch_max_age optional config parameters ----
+    auto batch_size = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "batch_size", false);
+    auto batch_max_age = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "batch_max_age", false);
+
+    unsigned long batch = 0;
+    unsigned long max_age = 1000;
+
+    if (!batch_size.empty())
+    {
+        batch = HdbppTimescaleDbUtils::parseConfigInteger("batch_size", batch_size, 0, MaxBatchSize);
+
+        if (!batch_max_age.empty())
+            max_age = HdbppTimescaleDbUtils::parseConfigInteger("batch_max_age", batch_max_age, 0, MaxBatchMaxAge);
+
+        spdlog::info("Config parameter batch_size: {}", batch_size);
+        spdlog::info("Config parameter batch_max_age: {}", batch_max_age);
+    }
+
+    // queue_capacity and queue_overflow_policy optional config parameters ----
+    auto queue_capacity = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "queue_capacity", false);
+    auto queue_overflow_policy =
+        param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "queue_overflow_policy", false));
+
+    unsigned long capacity = 0;
+    auto overflow_policy = WriterPool<pqxx_conn::DbConnection>::OverflowPolicy::Block;
+
+    if (!queue_capacity.empty())
+    {
+        capacity = HdbppTimescaleDbUtils::parseConfigInteger("queue_capacity", queue_capacity, 0, MaxQueueCapacity);
+
+        spdlog::info("Config parameter queue_capacity: {}", queue_capacity);
+    }
+
+    if (queue_overflow_policy == "drop_oldest")
+        overflow_policy = WriterPool<pqxx_conn::DbConnection>::OverflowPolicy::DropOldest;
+    else if (queue_overflow_policy == "spill")
+        overflow_policy = WriterPool<pqxx_conn::DbConnection>::OverflowPolicy::Spill;
+    else if (!queue_overflow_policy.empty() && queue_overflow_policy != "block")
+    {
+        std::string msg {"Configuration parsing error: unknown queue_overflow_policy: " + queue_overflow_policy};
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    spdlog::info("Config parameter queue_overflow_policy: {}", queue_overflow_policy);
+
+    // connection_pool_size optional config parameter ----
+    auto connection_pool_size = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "connection_pool_size", false);
+    unsigned long pool_size = 1;
+
+    if (!connection_pool_size.empty())
+    {
+        pool_size = HdbppTimescaleDbUtils::parseConfigInteger(
+            "connection_pool_size", connection_pool_size, 1, MaxConnectionPoolSize);
+
+        spdlog::info("Config parameter connection_pool_size: {}", connection_pool_size);
+    }
+
+    // reconnect_budget optional config parameter ----
+    auto reconnect_budget = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "reconnect_budget", false);
+    unsigned long budget = DefaultReconnectBudget;
+
+    if (!reconnect_budget.empty())
+    {
+        budget = HdbppTimescaleDbUtils::parseConfigInteger("reconnect_budget", reconnect_budget, 0, MaxReconnectBudget);
+
+        spdlog::info("Config parameter reconnect_budget: {}", reconnect_budget);
+    }
+
+    // deadband_filter optional config parameter ----
+    auto deadband_filter = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "deadband_filter", false));
+    spdlog::info("Config parameter deadband_filter: {}", deadband_filter);
+
+    // array_packing optional config parameter ----
+    auto array_packing = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "array_packing", false));
+    spdlog::info("Config parameter array_packing: {}", array_packing);
+
+    if (array_packing == "true" &&
+        (db_store_method != pqxx_conn::DbConnection::DbStoreMethod::PreparedStatement || batch > 0))
+    {
+        std::string msg {
+            "Configuration parsing error: array_packing requires the prepared_statement store_method without batching"};
+
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    // chunk_target_size, compress_after and ttl_retention optional config parameters ----
+    auto chunk_target_size = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "chunk_target_size", false);
+    auto compress_after = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "compress_after", false);
+    auto ttl_retention = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "ttl_retention", false));
+
+    unsigned long chunk_target_mb = 0;
+    unsigned long compress_after_hours = 0;
+
+    if (!chunk_target_size.empty())
+    {
+        chunk_target_mb = HdbppTimescaleDbUtils::parseConfigInteger(
+            "chunk_target_size", chunk_target_size, 1, MaxChunkTargetSize);
+
+        spdlog::info("Config parameter chunk_target_size: {}", chunk_target_size);
+    }
+
+    if (!compress_after.empty())
+    {
+        compress_after_hours =
+            HdbppTimescaleDbUtils::parseConfigInteger("compress_after", compress_after, 1, MaxCompressAfter);
+
+        spdlog::info("Config parameter compress_after: {}", compress_after);
+    }
+
+    spdlog::info("Config parameter ttl_retention: {}", ttl_retention);
+
+    // rollups optional config parameter ----
+    auto rollups = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "rollups", false));
+    spdlog::info("Config parameter rollups: {}", rollups);
+
+    // cache_warmup optional config parameter ----
+    auto cache_warmup = param_to_lower(HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "cache_warmup", false));
+    spdlog::info("Config parameter cache_warmup: {}", cache_warmup);
+
+    // journal_path and journal_size optional config parameters ----
+    auto journal_path = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "journal_path", false);
+    auto journal_size = HdbppTimescaleDbUtils::getConfigParam(libhdb_conf, "journal_size", false);
+    unsigned long journal_mb = DefaultJournalSize;
+
+    if (!journal_size.empty())
+    {
+        journal_mb = HdbppTimescaleDbUtils::parseConfigInteger("journal_size", journal_size, 1, MaxJournalSize);
+
+        spdlog::info("Config parameter journal_size: {}", journal_size);
+    }
+
+    if (!journal_path.empty())
+    {
+        spdlog::info("Config parameter journal_path: {}", journal_path);
+        Journal = make_shared<EventJournal>(journal_path, journal_mb * 1024 * 1024);
+        JournalConn = make_unique<JournalConnection>(Journal);
+    }
+    else if (overflow_policy == WriterPool<pqxx_conn::DbConnection>::OverflowPolicy::Spill)
+    {
+        std::string msg {"Configuration parsing error: queue_overflow_policy: spill requires a journal_path"};
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    // the pool is only of use with writer threads, so give it queues if none were asked for
+    if (pool_size > 1 && capacity == 0)
+    {
+        capacity = DefaultQueueCapacity;
+        spdlog::info("Connection pool enabled without a queue_capacity, using: {}", capacity);
+    }
+
+    // batched events are stored once too old by the writer threads, without a queue a quiet
+    // table would hold its events in memory until the next event. The copy methods always batch
+    auto batching = batch > 0 || db_store_method == pqxx_conn::DbConnection::DbStoreMethod::CopyStream ||
+        db_store_method == pqxx_conn::DbConnection::DbStoreMethod::CopyBinary;
+
+    if (batching && capacity == 0)
+    {
+        std::string msg {
+            "Configuration parsing error: batch_size, copy_stream and copy_binary require a queue_capacity"};
+
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    // the retention is run by the writer thread of the first connection, without a queue
+    // nothing would run it again after startup
+    if (ttl_retention == "true" && capacity == 0)
+    {
+        std::string msg {"Configuration parsing error: ttl_retention requires a queue_capacity"};
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    // new rollups are filled by the writer thread of the first connection in the same way
+    if (rollups == "true" && capacity == 0)
+    {
+        std::string msg {"Configuration parsing error: rollups requires a queue_capacity"};
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    Registry = make_unique<AttributeRegistry>();
+
+    // allocate and bring up the connections to store data with
+    vector<unique_ptr<pqxx_conn::DbConnection>> conns;
+
+    for (unsigned long i = 0; i < pool_size; i++)
+    {
+        auto conn = make_unique<pqxx_conn::DbConnection>(db_store_method);
+
+        if (!batch_size.empty())
+            conn->enableBatching(batch, chrono::milliseconds(max_age));
+
+        if (Journal)
+            conn->enableJournal(Journal);
+
+        conn->setReconnectBudget(chrono::milliseconds(budget));
+
+        if (deadband_filter == "true")
+            conn->enableDeadbandFilter();
+
+        if (array_packing == "true")
+            conn->enableArrayPacking();
+
+        if (rollups == "true")
+            conn->enableRollups();
+
+        if (cache_warmup == "true")
+            conn->enableCacheWarmup();
+
+        conn->connect(connection_string);
+        conns.push_back(move(conn));
+    }
+
+    // maintain the data tables on the first connection, before any events are stored
+    if (chunk_target_mb > 0)
+        conns.front()->resizeChunkIntervals(chunk_target_mb * 1024 * 1024);
+
+    if (compress_after_hours > 0)
+        conns.front()->enableCompression(chrono::hours(compress_after_hours));
+
+    // the retention is run every hour by the writer of the first connection, starting
+    // once it is running
+    if (ttl_retention == "true")
+        conns.front()->enableRetention();
+
+    // the archiver runs without the rollups rather than failing to start, createRollups()
+    // has already logged the cause
+    if (rollups == "true")
+    {
+        try
+        {
+            conns.front()->createRollups();
+        }
+        catch (const Tango::DevFailed &)
+        {
+            spdlog::warn("The rollups could not be created, continuing without them");
+        }
+    }
+
+    // hand the connections over to the writer threads, every second they store any batched
+    // events, so quiet tables are not left waiting for their next event
+    if (capacity > 0)
+    {
+        Writers = make_unique<WriterPool<pqxx_conn::DbConnection>>(
+            move(conns), capacity, overflow_policy, [](pqxx_conn::DbConnection &conn) { conn.flush(); });
+    }
+    else
+    {
+        Conn = move(conns.front());
+    }
 
-    // now bring up the connection
-    Conn->connect(connection_string);
     spdlog::info("Started libhdbpp-timescale shared library successfully");
 }
 
@@ -158,8 +561,25 @@ HdbppTimescaleDb::HdbppTimescaleDb(const vector<string> &configuration)
 //=============================================================================
 HdbppTimescaleDb::~HdbppTimescaleDb()
 {
-    if (Conn->isOpen())
+    // store everything still queued before taking the connections back
+    if (Writers)
+    {
+        for (auto &conn : Writers->shutdown())
+            if (conn->isOpen())
+                conn->disconnect();
+
+        Writers.reset();
+    }
+    else if (Conn->isOpen())
+    {
         Conn->disconnect();
+    }
+
+    JournalConn.reset();
+    Journal.reset();
+
+    // nothing queued refers to a record any longer
+    Registry.reset();
 
     LogConfigurator::shutdownLogging();
 }
@@ -172,6 +592,14 @@ void HdbppTimescaleDb::insert_Attr(Tango::EventData *event_data, HdbEventDataTyp
     assert(event_data->attr_value);
     spdlog::trace("Insert data event for attribute: {}", event_data->attr_name);
 
+    AttributeTraits traits {static_cast<Tango::AttrWriteType>(event_data_type.write_type),
+        static_cast<Tango::AttrDataFormat>(event_data_type.data_format),
+        static_cast<Tango::CmdArgType>(event_data_type.data_type)};
+
+    // the attribute is registered on its first event, from then on its record is found
+    // with a single lookup and the queued requests refer to it rather than copy its name
+    const auto *record = &Registry->acquire(event_data->attr_name, traits);
+
     // if there is an error, we store an error, since there will be no data passed in
     if (event_data->err)
     {
@@ -189,31 +617,52 @@ void HdbppTimescaleDb::insert_Attr(Tango::EventData *event_data, HdbEventDataTyp
         tango_tv.tv_usec = tv.tv_usec;
         tango_tv.tv_nsec = 0;
 
-        Conn->createTx<HdbppTxDataEventError>()
-            .withName(event_data->attr_name)
-            .withTraits(static_cast<Tango::AttrWriteType>(event_data_type.write_type),
-                static_cast<Tango::AttrDataFormat>(event_data_type.data_format),
-                static_cast<Tango::CmdArgType>(event_data_type.data_type))
-            .withError(string(event_data->errors[0].desc))
-            .withEventTime(tango_tv)
-            .withQuality(event_data->attr_value->get_quality())
-            .store();
+        auto error = string(event_data->errors[0].desc);
+        auto quality = event_data->attr_value->get_quality();
+
+        HdbppTimescaleDbUtils::dispatch(
+            *record,
+            [record, error, tango_tv, quality](pqxx_conn::DbConnection &conn) {
+                conn.createTx<HdbppTxDataEventError>()
+                    .withRecord(*record)
+                    .withError(error)
+                    .withEventTime(tango_tv)
+                    .withQuality(quality)
+                    .store();
+            },
+            false);
     }
     else
     {
         spdlog::trace("Event type is data for attribute: {}", event_data->attr_name);
 
         // build a data event request, this will store 0 or more data elements,
-        // pending on type, format and quality
-        Conn->createTx<HdbppTxDataEvent>()
-            .withName(event_data->attr_name)
-            .withTraits(static_cast<Tango::AttrWriteType>(event_data_type.write_type),
-                static_cast<Tango::AttrDataFormat>(event_data_type.data_format),
-                static_cast<Tango::CmdArgType>(event_data_type.data_type))
-            .withAttribute(event_data->attr_value)
-            .withEventTime(event_data->attr_value->get_date())
-            .withQuality(event_data->attr_value->get_quality())
-            .store();
+        // pending on type, format and quality. The event data is only valid for the
+        // duration of this call, so when the store is queued the writer thread is
+        // given its own copy of the device attribute
+        auto dev_attr = Writers ?
+            make_shared<Tango::DeviceAttribute>(*event_data->attr_value) :
+            shared_ptr<Tango::DeviceAttribute>(event_data->attr_value, [](Tango::DeviceAttribute *) {});
+
+        HdbppTimescaleDbUtils::dispatch(
+            *record,
+            [record, dev_attr](pqxx_conn::DbConnection &conn) {
+                conn.createTx<HdbppTxDataEvent>()
+                    .withRecord(*record)
+                    .withAttribute(dev_attr.get())
+                    .withEventTime(dev_attr->get_date())
+                    .withQuality(dev_attr->get_quality())
+                    .store();
+            },
+            false,
+            [record, dev_attr]() {
+                JournalConn->createTx<HdbppTxDataEvent>()
+                    .withRecord(*record)
+                    .withAttribute(dev_attr.get())
+                    .withEventTime(dev_attr->get_date())
+                    .withQuality(dev_attr->get_quality())
+                    .store();
+            });
     }
 }
 
@@ -225,30 +674,55 @@ void HdbppTimescaleDb::insert_param_Attr(
     assert(conf_event_data);
     spdlog::trace("Insert parameter event request for attribute: {}", conf_event_data->attr_name);
 
-    Conn->createTx<HdbppTxParameterEvent>()
-        .withName(conf_event_data->attr_name)
-        .withEventTime(conf_event_data->get_date())
-        .withAttrInfo(*(conf_event_data->attr_conf))
-        .store();
+    // the attribute info is copied, since the event data does not outlive this call
+    auto attr_name = conf_event_data->attr_name;
+    auto event_time = conf_event_data->get_date();
+    auto attr_conf = make_shared<Tango::AttributeInfoEx>(*(conf_event_data->attr_conf));
+
+    HdbppTimescaleDbUtils::dispatch(
+        attr_name,
+        [attr_name, event_time, attr_conf](pqxx_conn::DbConnection &conn) {
+            conn.createTx<HdbppTxParameterEvent>()
+                .withName(attr_name)
+                .withEventTime(event_time)
+                .withAttrInfo(*attr_conf)
+                .store();
+        },
+        false);
 }
 
 //=============================================================================
 //=============================================================================
 void HdbppTimescaleDb::configure_Attr(
-    std::string fqdn_attr_name, int type, int format, int write_type, unsigned int /* ttl */)
+    std::string fqdn_attr_name, int type, int format, int write_type, unsigned int ttl)
 {
     assert(!fqdn_attr_name.empty());
     spdlog::trace("Insert new attribute request for attribute: {}", fqdn_attr_name);
 
+    // register the attribute now, so its first data event does not wait on the name
+    // being resolved
+    Registry->acquire(fqdn_attr_name,
+        AttributeTraits {static_cast<Tango::AttrWriteType>(write_type),
+            static_cast<Tango::AttrDataFormat>(format),
+            static_cast<Tango::CmdArgType>(type)});
+
     // forgive the ugly casting, but for some reason we receive the enum values
     // already cast to ints, we cast them back to enums so they function as
     // enums again
-    Conn->createTx<HdbppTxNewAttribute>()
-        .withName(fqdn_attr_name)
-        .withTraits(static_cast<Tango::AttrWriteType>(write_type),
-            static_cast<Tango::AttrDataFormat>(format),
-            static_cast<Tango::CmdArgType>(type))
-        .store();
+    HdbppTimescaleDbUtils::dispatch(
+        fqdn_attr_name,
+        [fqdn_attr_name, type, format, write_type, ttl](pqxx_conn::DbConnection &conn) {
+            conn.createTx<HdbppTxNewAttribute>()
+                .withName(fqdn_attr_name)
+                .withTraits(static_cast<Tango::AttrWriteType>(write_type),
+                    static_cast<Tango::AttrDataFormat>(format),
+                    static_cast<Tango::CmdArgType>(type))
+                .store();
+
+            // the ttl of an attribute that is already configured is updated if it differs
+            conn.createTx<HdbppTxUpdateTtl>().withName(fqdn_attr_name).withTtl(ttl).store();
+        },
+        true);
 }
 
 //=============================================================================
@@ -257,8 +731,12 @@ void HdbppTimescaleDb::updateTTL_Attr(std::string fqdn_attr_name, unsigned int t
 {
     assert(!fqdn_attr_name.empty());
     spdlog::trace("TTL event request for attribute: {}, with ttl: {}", fqdn_attr_name, ttl);
-
-    // TODO implement
+    HdbppTimescaleDbUtils::dispatch(
+        fqdn_attr_name,
+        [fqdn_attr_name, ttl](pqxx_conn::DbConnection &conn) {
+            conn.createTx<HdbppTxUpdateTtl>().withName(fqdn_attr_name).withTtl(ttl).store();
+        },
+        true);
 }
 
 //=============================================================================
@@ -267,7 +745,12 @@ void HdbppTimescaleDb::event_Attr(std::string fqdn_attr_name, unsigned char even
 {
     assert(!fqdn_attr_name.empty());
     spdlog::trace("History event request for attribute: {}", fqdn_attr_name);
-    Conn->createTx<HdbppTxHistoryEvent>().withName(fqdn_attr_name).withEvent(event).store();
+    HdbppTimescaleDbUtils::dispatch(
+        fqdn_attr_name,
+        [fqdn_attr_name, event](pqxx_conn::DbConnection &conn) {
+            conn.createTx<HdbppTxHistoryEvent>().withName(fqdn_attr_name).withEvent(event).store();
+        },
+        true);
 }
 
 //=============================================================================
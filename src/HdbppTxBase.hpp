@@ -63,7 +63,14 @@ protected:
     // across all the different tx classes
     static std::string attrNameForStorage(AttributeName &attr_name)
     {
-        return "tango://" + attr_name.tangoHostWithDomain() + "/" + attr_name.fullAttributeName();
+        auto tango_host = attr_name.tangoHostWithDomain();
+        auto full_attr_name = attr_name.fullAttributeName();
+
+        std::string storage_name {"tango://"};
+        storage_name.reserve(storage_name.size() + tango_host.size() + 1 + full_attr_name.size());
+        storage_name.append(tango_host.data(), tango_host.size()).append("/");
+        storage_name.append(full_attr_name.data(), full_attr_name.size());
+        return storage_name;
     }
 
 private:
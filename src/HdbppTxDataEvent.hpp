@@ -21,9 +21,90 @@
 #define _HDBPP_TX_DATA_EVENT_HPP
 
 #include "HdbppTxDataEventBase.hpp"
+#include "PayloadPool.hpp"
+#include "ValueView.hpp"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 
 namespace hdbpp_internal
 {
+namespace data_event_utils
+{
+    // Maps a C++ type to the CORBA sequence Tango decodes its attribute values into. Only
+    // types whose sequence elements have the same layout as the C++ type can be borrowed,
+    // the others (bool, string, DevState) are always extracted into a vector
+    template<typename T>
+    struct TangoSequence
+    {
+        static const bool borrowable = false;
+    };
+
+    template<>
+    struct TangoSequence<int16_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarShortArray;
+    };
+
+    template<>
+    struct TangoSequence<int32_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarLongArray;
+    };
+
+    template<>
+    struct TangoSequence<int64_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarLong64Array;
+    };
+
+    template<>
+    struct TangoSequence<float>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarFloatArray;
+    };
+
+    template<>
+    struct TangoSequence<double>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarDoubleArray;
+    };
+
+    template<>
+    struct TangoSequence<uint8_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarCharArray;
+    };
+
+    template<>
+    struct TangoSequence<uint16_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarUShortArray;
+    };
+
+    template<>
+    struct TangoSequence<uint32_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarULongArray;
+    };
+
+    template<>
+    struct TangoSequence<uint64_t>
+    {
+        static const bool borrowable = true;
+        using type = Tango::DevVarULong64Array;
+    };
+} // namespace data_event_utils
+
 // Used to store data about an attribute in the database. This transaction class
 // will determine if the data exists and what data is to be stored based on the
 // attribute traits it is given. The HdbppTxDataEvent class also acts as the main
@@ -41,8 +122,8 @@ public:
     HdbppTxDataEvent<Conn> &withAttribute(Tango::DeviceAttribute *dev_attr)
     {
         // just set the pointer here, we will do a full event data extraction at
-        // point of storage, this reduces complexity but limits the functionality, i.e
-        // we can not safely queue these events until they have been stored
+        // point of storage, this reduces complexity but means the device attribute must
+        // outlive the transaction. Queued events are given a copy by their creator
         _dev_attr = dev_attr;
         return *this;
     }
@@ -59,6 +140,18 @@ private:
     template<typename T, typename ReadFunctor, typename WriteFunctor>
     void doStore(ReadFunctor extract_read, WriteFunctor extract_write);
 
+    // when both the connection and type allow it, take the decoded sequence from the
+    // device attribute and store views of its read and write values, this saves copying
+    // every value into a vector. Returns false when the values must be extracted instead
+    template<typename T>
+    bool doStoreView(std::false_type /* unused */)
+    {
+        return false;
+    }
+
+    template<typename T>
+    bool doStoreView(std::true_type /* unused */);
+
     // the device attribute to extract the value from
     Tango::DeviceAttribute *_dev_attr = nullptr;
 };
@@ -68,7 +161,7 @@ private:
 template<typename Conn>
 HdbppTxDataEvent<Conn> &HdbppTxDataEvent<Conn>::store()
 {
-    if (Base::attributeName().empty())
+    if (!Base::hasName())
     {
         std::string msg {"AttributeName is reporting empty. Unable to complete the transaction."};
         spdlog::error("Error: {}", msg);
@@ -77,21 +170,21 @@ HdbppTxDataEvent<Conn> &HdbppTxDataEvent<Conn>::store()
     else if (Base::attributeTraits().isInvalid())
     {
         std::string msg {"AttributeTraits are not set. Unable to complete the transaction."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
     else if (_dev_attr == nullptr)
     {
         std::string msg {"Device Attribute is not set. Unable to complete the transaction."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
     else if (HdbppTxBase<Conn>::connection().isClosed())
     {
         string msg {"The connection is reporting it is closed. Unable to store data event."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
@@ -148,7 +241,7 @@ HdbppTxDataEvent<Conn> &HdbppTxDataEvent<Conn>::store()
         default:
             std::string msg {
                 "HdbppTxDataEvent built for unsupported type: " + tangoEnumToString(Base::attributeTraits().type()) +
-                ", for attribute: [" + Base::attributeName().fqdnAttributeName() + "]"};
+                ", for attribute: [" + Base::fqdnAttributeName() + "]"};
 
             spdlog::error("Error: {}", msg);
             Tango::Except::throw_exception("Runtime Error", msg, LOCATION_INFO);
@@ -165,11 +258,18 @@ template<typename Conn>
 template<typename T, typename ReadFunctor, typename WriteFunctor>
 void HdbppTxDataEvent<Conn>::doStore(ReadFunctor extract_read, WriteFunctor extract_write)
 {
+    using Borrowable =
+        std::integral_constant<bool, StoresValueViews<Conn>::value && data_event_utils::TangoSequence<T>::borrowable>;
+
+    if (doStoreView<T>(Borrowable {}))
+        return;
+
     // this is the general extractor algorithm, it is primed for a means to do the
     // actual extraction, the split allows some variation in types to be dealt with.
     auto value = [this](auto extractor, bool has_data, const std::string &write_type) {
-        // this is the return, a unique ptr potentially with a vector in
-        auto value = make_unique<std::vector<T>>();
+        // this is the return, a unique ptr potentially with a vector in, recycled
+        // from an earlier event when possible
+        auto value = PayloadPool<T>::acquire();
 
         // its possible in some cases to get events that are empty or invalid,
         // we still store the event, but with no event data, so filter them
@@ -183,9 +283,8 @@ void HdbppTxDataEvent<Conn>::doStore(ReadFunctor extract_read, WriteFunctor extr
             {
                 std::stringstream msg;
 
-                msg << "Failed to extract the attribute data for attribute: ["
-                    << Base::attributeName().fullAttributeName() << "]. Traits: [" << Base::attributeTraits()
-                    << "], and read action [" << write_type << "]";
+                msg << "Failed to extract the attribute data for attribute: [" << Base::fqdnAttributeName()
+                    << "]. Traits: [" << Base::attributeTraits() << "], and read action [" << write_type << "]";
 
                 spdlog::error("Error: {}", msg.str());
                 Tango::Except::throw_exception("Runtime Error", msg.str(), LOCATION_INFO);
@@ -196,13 +295,13 @@ void HdbppTxDataEvent<Conn>::doStore(ReadFunctor extract_read, WriteFunctor extr
         {
             spdlog::debug("Quality is {} for attribute: [{}] (write type: {}), no data extracted",
                 Base::quality(),
-                Base::attributeName().fqdnAttributeName(),
+                Base::fqdnAttributeName(),
                 write_type);
         }
         else if (_dev_attr->is_empty())
         {
             spdlog::debug("Attribute [{}] (write type: {}), empty, no data extracted",
-                Base::attributeName().fqdnAttributeName(),
+                Base::fqdnAttributeName(),
                 write_type);
         }
 
@@ -213,7 +312,7 @@ void HdbppTxDataEvent<Conn>::doStore(ReadFunctor extract_read, WriteFunctor extr
     // attempt to store the error in the database, any exceptions are left to
     // propergate to the caller
     HdbppTxBase<Conn>::connection().template storeDataEvent<T>(
-        HdbppTxBase<Conn>::attrNameForStorage(Base::attributeName()),
+        Base::storageName(),
         Base::eventTime(),
         Base::quality(),
         std::move(value(extract_read, Base::attributeTraits().hasReadData(), "read")),
@@ -221,6 +320,76 @@ void HdbppTxDataEvent<Conn>::doStore(ReadFunctor extract_read, WriteFunctor extr
         Base::attributeTraits());
 }
 
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+template<typename T>
+bool HdbppTxDataEvent<Conn>::doStoreView(std::true_type /* unused */)
+{
+    using Sequence = typename data_event_utils::TangoSequence<T>::type;
+    using Element = typename std::remove_pointer<decltype(std::declval<const Sequence &>().get_buffer())>::type;
+
+    static_assert(sizeof(Element) == sizeof(T), "The sequence elements must have the layout of the stored type");
+
+    // owns the sequence the views refer to, so must outlive the store
+    std::unique_ptr<Sequence> sequence;
+    ValueView<T> value_r;
+    ValueView<T> value_w;
+
+    // as with doStore(), empty or invalid events are stored with no event data
+    if (!_dev_attr->is_empty() && Base::quality() != Tango::ATTR_INVALID)
+    {
+        // extracting to a sequence pointer hands over the sequence the attribute decoded,
+        // rather than copying it as extract_read() and extract_set() do
+        Sequence *raw = nullptr;
+
+        if (!((*_dev_attr) >> raw) || raw == nullptr)
+        {
+            std::stringstream msg;
+
+            msg << "Failed to extract the attribute data for attribute: [" << Base::fqdnAttributeName()
+                << "]. Traits: [" << Base::attributeTraits() << "]";
+
+            spdlog::error("Error: {}", msg.str());
+            Tango::Except::throw_exception("Runtime Error", msg.str(), LOCATION_INFO);
+        }
+
+        sequence.reset(raw);
+
+        const auto *data = reinterpret_cast<const T *>(sequence->get_buffer());
+        std::size_t length = sequence->length();
+        std::size_t nb_read = std::max(_dev_attr->get_nb_read(), 0);
+        std::size_t nb_written = std::max(_dev_attr->get_nb_written(), 0);
+
+        if (Base::attributeTraits().hasReadData())
+            value_r = ValueView<T>(data, std::min(nb_read, length));
+
+        // the set point follows the read value, unless the device sent the set
+        // point alone, as it does for write only attributes
+        if (Base::attributeTraits().hasWriteData())
+        {
+            auto offset = length >= nb_read + nb_written ? nb_read : 0;
+            value_w = ValueView<T>(data + offset, std::min(nb_written, length - offset));
+        }
+    }
+    else
+    {
+        spdlog::debug("Attribute [{}] is empty or has invalid quality ({}), no data extracted",
+            Base::fqdnAttributeName(),
+            Base::quality());
+    }
+
+    HdbppTxBase<Conn>::connection().template storeDataEventView<T>(
+        Base::storageName(),
+        Base::eventTime(),
+        Base::quality(),
+        value_r,
+        value_w,
+        Base::attributeTraits());
+
+    return true;
+}
+
 //=============================================================================
 //=============================================================================
 template<typename Conn>
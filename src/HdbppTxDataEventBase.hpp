@@ -21,6 +21,7 @@
 #define _HDBPP_TX_DATA_EVENT_BASE_HPP
 
 #include "AttributeName.hpp"
+#include "AttributeRegistry.hpp"
 #include "AttributeTraits.hpp"
 #include "HdbppTxBase.hpp"
 #include "LibUtils.hpp"
@@ -45,6 +46,18 @@ public:
     Derived<Conn> &withName(const std::string &fqdn_attr_name)
     {
         _attr_name = AttributeName {fqdn_attr_name};
+        _record = nullptr;
+        _storage_name.clear();
+        return static_cast<Derived<Conn> &>(*this);
+    }
+
+    // name and traits from a registered attribute, this saves parsing the name for every
+    // event. The record must outlive the transaction
+    Derived<Conn> &withRecord(const AttributeRecord &record)
+    {
+        _attr_name.clear();
+        _record = &record;
+        _traits = record.traits;
         return static_cast<Derived<Conn> &>(*this);
     }
 
@@ -78,13 +91,34 @@ public:
 
 protected:
     // release the private data safely for the derived classes
-    AttributeName &attributeName() { return _attr_name; }
+    bool hasName() const noexcept { return _record != nullptr || !_attr_name.empty(); }
+
+    const std::string &fqdnAttributeName() const noexcept
+    {
+        return _record != nullptr ? _record->fqdn_attr_name : _attr_name.fqdnAttributeName();
+    }
+
+    // the name the attribute is stored under, built once per transaction when the
+    // attribute was not given as a record
+    const std::string &storageName()
+    {
+        if (_record != nullptr)
+            return _record->storage_name;
+
+        if (_storage_name.empty())
+            _storage_name = HdbppTxBase<Conn>::attrNameForStorage(_attr_name);
+
+        return _storage_name;
+    }
+
     const AttributeTraits &attributeTraits() const { return _traits; }
     Tango::AttrQuality quality() const { return _quality; }
     double eventTime() const { return _event_time; }
 
 private:
     AttributeName _attr_name;
+    const AttributeRecord *_record = nullptr;
+    std::string _storage_name;
     AttributeTraits _traits;
     Tango::AttrQuality _quality = Tango::ATTR_INVALID;
 
@@ -104,7 +138,7 @@ void HdbppTxDataEventBase<Conn, Derived>::print(std::ostream &os) const noexcept
 
     os << ", "
        << "_event_time: " << _event_time << ", "
-       << "_attr_name: " << _attr_name << ", "
+       << "_attr_name: " << fqdnAttributeName() << ", "
        << "_traits: " << _traits << ", "
        << "_quality: " << _quality << ", "
        << "_event_time: " << _event_time << ")";
@@ -58,7 +58,7 @@ private:
 template<typename Conn>
 HdbppTxDataEventError<Conn> &HdbppTxDataEventError<Conn>::store()
 {
-    if (Base::attributeName().empty())
+    if (!Base::hasName())
     {
         std::string msg {"AttributeName is reporting empty. Unable to complete the transaction."};
         spdlog::error("Error: {}", msg);
@@ -67,28 +67,28 @@ HdbppTxDataEventError<Conn> &HdbppTxDataEventError<Conn>::store()
     else if (Base::attributeTraits().isInvalid())
     {
         std::string msg {"AttributeTraits are not set. Unable to complete the transaction."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
     else if (_error_msg.empty())
     {
         std::string msg {"Error message is not set. Unable to complete the transaction."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
     else if (HdbppTxBase<Conn>::connection().isClosed())
     {
         string msg {"The connection is reporting it is closed. Unable to store data event."};
-        msg += ". For attribute" + Base::attributeName().fqdnAttributeName();
+        msg += ". For attribute" + Base::fqdnAttributeName();
         spdlog::error("Error: {}", msg);
         Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
     }
 
     // attempt to store the error in the database, any exceptions are left to
     // propergate to the caller
-    HdbppTxBase<Conn>::connection().storeDataEventError(HdbppTxBase<Conn>::attrNameForStorage(Base::attributeName()),
+    HdbppTxBase<Conn>::connection().storeDataEventError(Base::storageName(),
         Base::eventTime(),
         Base::quality(),
         _error_msg,
@@ -162,11 +162,11 @@ HdbppTxNewAttribute<Conn> &HdbppTxNewAttribute<Conn>::store()
 
         // attempt to store the new attribute into the database for the first time
         HdbppTxBase<Conn>::connection().storeAttribute(prepared_attr_name,
-            _attr_name.tangoHostWithDomain(),
-            _attr_name.domain(),
-            _attr_name.family(),
-            _attr_name.member(),
-            _attr_name.name(),
+            _attr_name.tangoHostWithDomain().to_string(),
+            _attr_name.domain().to_string(),
+            _attr_name.family().to_string(),
+            _attr_name.member().to_string(),
+            _attr_name.name().to_string(),
             _traits);
 
         HdbppTxBase<Conn>::connection()
@@ -0,0 +1,106 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _HDBPP_TX_UPDATE_TTL_HPP
+#define _HDBPP_TX_UPDATE_TTL_HPP
+
+#include "HdbppTxBase.hpp"
+#include "LibUtils.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace hdbpp_internal
+{
+// Update the time to live of an attribute, in hours. Data older than the time to live
+// is deleted by the retention run, see DbConnection::applyRetention(), and a time to
+// live of 0 keeps the data forever
+template<typename Conn>
+class HdbppTxUpdateTtl : public HdbppTxBase<Conn>
+{
+public:
+    HdbppTxUpdateTtl(Conn &conn) : HdbppTxBase<Conn>(conn) {}
+
+    HdbppTxUpdateTtl<Conn> &withName(const std::string &fqdn_attr_name)
+    {
+        _attr_name = AttributeName {fqdn_attr_name};
+        return *this;
+    }
+
+    HdbppTxUpdateTtl<Conn> &withTtl(unsigned int ttl)
+    {
+        _ttl = ttl;
+        return *this;
+    }
+
+    // trigger the database storage routines
+    HdbppTxUpdateTtl<Conn> &store();
+
+    /// @brief Print the HdbppTxUpdateTtl object to the stream
+    void print(std::ostream &os) const noexcept override;
+
+private:
+    AttributeName _attr_name;
+    unsigned int _ttl = 0;
+};
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+HdbppTxUpdateTtl<Conn> &HdbppTxUpdateTtl<Conn>::store()
+{
+    if (_attr_name.empty())
+    {
+        std::string msg {"AttributeName is reporting empty. Unable to complete the transaction."};
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+    else if (HdbppTxBase<Conn>::connection().isClosed())
+    {
+        std::string msg {"The connection is reporting it is closed. Unable to store the ttl. For attribute" +
+            _attr_name.fqdnAttributeName()};
+
+        spdlog::error("Error: {}", msg);
+        Tango::Except::throw_exception("Invalid Argument", msg, LOCATION_INFO);
+    }
+
+    // attempt to store the ttl in the database, any exeptions are left to
+    // propergate to the caller
+    HdbppTxBase<Conn>::connection().storeAttributeTtl(HdbppTxBase<Conn>::attrNameForStorage(_attr_name), _ttl);
+
+    // success in running the store command, so set the result as true
+    HdbppTxBase<Conn>::setResult(true);
+    return *this;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void HdbppTxUpdateTtl<Conn>::print(std::ostream &os) const noexcept
+{
+    os << "HdbppTxUpdateTtl(base: ";
+    HdbppTxBase<Conn>::print(os);
+
+    os << ", "
+       << "_attr_name: " << _attr_name << ", "
+       << "_ttl: " << _ttl << ")";
+}
+
+} // namespace hdbpp_internal
+#endif // _HDBPP_TX_UPDATE_TTL_HPP
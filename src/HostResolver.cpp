@@ -0,0 +1,218 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "HostResolver.hpp"
+
+#include "LibUtils.hpp"
+
+#include <netdb.h>
+
+using namespace std;
+
+namespace hdbpp_internal
+{
+//=============================================================================
+//=============================================================================
+HostResolver::HostResolver(Resolve resolve, chrono::milliseconds ttl, chrono::milliseconds failure_ttl) :
+    _resolve(move(resolve)), _ttl(ttl), _failure_ttl(failure_ttl)
+{
+    _refresher = thread(&HostResolver::refresher, this);
+}
+
+//=============================================================================
+//=============================================================================
+HostResolver::~HostResolver()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _refresh_wanted.notify_all();
+
+    if (_refresher.joinable())
+        _refresher.join();
+}
+
+//=============================================================================
+//=============================================================================
+HostResolver &HostResolver::instance()
+{
+    static HostResolver resolver {HostResolver::resolveWithAddrInfo};
+    return resolver;
+}
+
+//=============================================================================
+//=============================================================================
+bool HostResolver::resolveWithAddrInfo(const string &host, string &canonical_name)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC; /*either IPV4 or IPV6*/
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_CANONNAME;
+
+    struct addrinfo *result;
+    const int status = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+
+    if (status != 0)
+    {
+        spdlog::error("Error: Unable to add domain to tango host: getaddrinfo failed with error: {}",
+            gai_strerror(status));
+
+        return false;
+    }
+
+    // only the first result carries the canonical name
+    auto found = result->ai_canonname != nullptr;
+
+    if (found)
+        canonical_name = result->ai_canonname;
+
+    freeaddrinfo(result); // all done with this structure
+    return found;
+}
+
+//=============================================================================
+//=============================================================================
+string HostResolver::canonicalName(const string &host)
+{
+    unique_lock<mutex> lock(_mutex);
+
+    auto iter = _entries.find(host);
+
+    if (iter == _entries.end())
+    {
+        // the first lookup of the host, resolved on this thread since there is no
+        // name to return yet. The lock is released so other hosts are not held up
+        _entries.emplace(host, Entry {});
+        lock.unlock();
+
+        string canonical_name;
+        auto resolved = _resolve(host, canonical_name);
+
+        lock.lock();
+
+        // entries are never erased, so the entry is still there
+        auto &entry = _entries.at(host);
+        update(entry, host, resolved, move(canonical_name));
+        entry.ready = true;
+
+        _resolved.notify_all();
+        return entry.canonical_name;
+    }
+
+    auto &entry = iter->second;
+
+    // another thread is making the first lookup of the host
+    _resolved.wait(lock, [&entry]() { return entry.ready; });
+
+    if (!entry.refreshing && chrono::steady_clock::now() >= entry.expires)
+    {
+        entry.refreshing = true;
+        _refresh_queue.push_back(host);
+        _refresh_wanted.notify_one();
+    }
+
+    return entry.canonical_name;
+}
+
+//=============================================================================
+//=============================================================================
+size_t HostResolver::size() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _entries.size();
+}
+
+//=============================================================================
+//=============================================================================
+void HostResolver::update(Entry &entry, const string &host, bool resolved, string canonical_name)
+{
+    auto now = chrono::steady_clock::now();
+
+    if (resolved)
+    {
+        // a name is only out of date once it has been returned
+        if (entry.ready && entry.canonical_name != canonical_name)
+        {
+            spdlog::info(
+                "Canonical name of host: {} changed from: {} to: {}", host, entry.canonical_name, canonical_name);
+
+            _generation++;
+        }
+
+        entry.canonical_name = move(canonical_name);
+        entry.resolved = true;
+        entry.expires = now + _ttl;
+    }
+    else
+    {
+        // keep the last resolved name, if there is one
+        if (!entry.resolved)
+            entry.canonical_name = host;
+
+        spdlog::debug("Unable to resolve host: {}, using: {} and retrying in: {}ms",
+            host,
+            entry.canonical_name,
+            _failure_ttl.count());
+
+        entry.expires = now + _failure_ttl;
+    }
+}
+
+//=============================================================================
+//=============================================================================
+void HostResolver::refresher()
+{
+    unique_lock<mutex> lock(_mutex);
+
+    while (true)
+    {
+        _refresh_wanted.wait(lock, [this]() { return _stopping || !_refresh_queue.empty(); });
+
+        if (_stopping)
+            return;
+
+        auto host = move(_refresh_queue.front());
+        _refresh_queue.pop_front();
+
+        // callers are given the cached name while the host is resolved
+        lock.unlock();
+
+        string canonical_name;
+        auto resolved = _resolve(host, canonical_name);
+
+        lock.lock();
+
+        auto &entry = _entries.at(host);
+        update(entry, host, resolved, move(canonical_name));
+        entry.refreshing = false;
+    }
+}
+
+//=============================================================================
+//=============================================================================
+void HostResolver::print(ostream &os) const noexcept
+{
+    lock_guard<mutex> lock(_mutex);
+    os << "HostResolver(hosts: " << _entries.size() << ", ttl: " << _ttl.count()
+       << "ms, failure_ttl: " << _failure_ttl.count() << "ms)";
+}
+
+} // namespace hdbpp_internal
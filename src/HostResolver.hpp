@@ -0,0 +1,119 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _HOST_RESOLVER_HPP
+#define _HOST_RESOLVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace hdbpp_internal
+{
+// The HostResolver caches the canonical, fully qualified, name of each host it is
+// asked for, so a host is resolved once rather than for every event stored against it.
+// Only the first lookup of a host waits on the resolver. Once an entry is older than
+// its time to live the cached name is still returned, and the host is resolved again
+// on a background thread. A host that can not be resolved is returned unchanged, and
+// retried after the shorter failure time to live. A host that fails to resolve on a
+// refresh keeps its last resolved name.
+//
+// The class is thread safe, and instance() returns a resolver shared by the whole
+// process.
+class HostResolver
+{
+public:
+    // resolves the host into its canonical name, returning false on failure. It must
+    // not throw
+    using Resolve = std::function<bool(const std::string &host, std::string &canonical_name)>;
+
+    HostResolver(Resolve resolve,
+        std::chrono::milliseconds ttl = std::chrono::minutes(5),
+        std::chrono::milliseconds failure_ttl = std::chrono::seconds(10));
+
+    ~HostResolver();
+
+    HostResolver(const HostResolver &) = delete;
+    HostResolver &operator=(const HostResolver &) = delete;
+
+    // the resolver shared by the process, resolving with getaddrinfo()
+    static HostResolver &instance();
+
+    // resolve the host with getaddrinfo()
+    static bool resolveWithAddrInfo(const std::string &host, std::string &canonical_name);
+
+    // the canonical name of host, or host itself when it can not be resolved
+    std::string canonicalName(const std::string &host);
+
+    // incremented each time the canonical name of a host already returned changes, so
+    // names built from canonical names can be checked for being out of date cheaply
+    std::uint64_t generation() const noexcept { return _generation.load(); }
+
+    // number of hosts cached
+    std::size_t size() const;
+
+    void print(std::ostream &os) const noexcept;
+
+private:
+    struct Entry
+    {
+        std::string canonical_name;
+        std::chrono::steady_clock::time_point expires;
+
+        // true once the host has been resolved successfully
+        bool resolved = false;
+
+        // false until the first lookup completes, other lookups of the host wait for it
+        bool ready = false;
+
+        // set while the host is queued for, or being, resolved on the background thread
+        bool refreshing = false;
+    };
+
+    // store the result of resolving a host in its entry
+    void update(Entry &entry, const std::string &host, bool resolved, std::string canonical_name);
+
+    void refresher();
+
+    Resolve _resolve;
+    std::chrono::milliseconds _ttl;
+    std::chrono::milliseconds _failure_ttl;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _resolved;
+    std::condition_variable _refresh_wanted;
+    std::unordered_map<std::string, Entry> _entries;
+    std::deque<std::string> _refresh_queue;
+    bool _stopping = false;
+
+    std::atomic<std::uint64_t> _generation {0};
+
+    std::thread _refresher;
+};
+
+} // namespace hdbpp_internal
+#endif // _HOST_RESOLVER_HPP
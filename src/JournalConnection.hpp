@@ -0,0 +1,76 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _JOURNAL_CONNECTION_HPP
+#define _JOURNAL_CONNECTION_HPP
+
+#include "AttributeTraits.hpp"
+#include "ConnectionBase.hpp"
+#include "EventJournal.hpp"
+#include "HdbppTxFactory.hpp"
+#include "PayloadPool.hpp"
+#include "spdlog/spdlog.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// The JournalConnection stores data events in an EventJournal rather than the database.
+// It allows the HdbppTxDataEvent transaction to extract and journal an event on any
+// thread, for example when a full write behind queue spills an event. Only data events
+// are supported. It holds no state of its own, so may be shared between threads.
+class JournalConnection : public ConnectionBase, public HdbppTxFactory<JournalConnection>
+{
+public:
+    JournalConnection(std::shared_ptr<EventJournal> journal) : _journal(std::move(journal)) {}
+
+    // connection API, there is nothing to connect to
+    void connect(const std::string & /* connect_string */) override {}
+    void disconnect() override {}
+    bool isOpen() const noexcept override { return _journal != nullptr; }
+    bool isClosed() const noexcept override { return !isOpen(); }
+
+    // storage API
+
+    template<typename T>
+    void storeDataEvent(const std::string &full_attr_name,
+        double event_time,
+        int quality,
+        std::unique_ptr<std::vector<T>> value_r,
+        std::unique_ptr<std::vector<T>> value_w,
+        const AttributeTraits &traits)
+    {
+        PayloadRecycler<T> recycler {value_r, value_w};
+
+        if (!_journal->append(
+                journal_utils::makeRecord<T>(full_attr_name, event_time, quality, value_r, value_w, traits)))
+        {
+            spdlog::error("Error: The event journal: {} is full. The attribute [{}] data event was not saved.",
+                _journal->path(),
+                full_attr_name);
+        }
+    }
+
+private:
+    std::shared_ptr<EventJournal> _journal;
+};
+} // namespace hdbpp_internal
+#endif // _JOURNAL_CONNECTION_HPP
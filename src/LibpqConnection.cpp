@@ -0,0 +1,347 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "LibpqConnection.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <libpq-fe.h>
+#include <poll.h>
+#include <pqxx/pqxx>
+
+using namespace std;
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    namespace
+    {
+        // data is sent to the server in pieces of this size, PQputCopyData
+        // takes an int length so very large batches can not be sent in one go
+        const string::size_type CopyChunkSize = 1024 * 1024;
+    } // namespace
+
+    //=============================================================================
+    //=============================================================================
+    LibpqConnection::~LibpqConnection() { disconnect(); }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::connect(const string &connect_string)
+    {
+        disconnect();
+
+        _conn = PQconnectdb(connect_string.c_str());
+
+        if (PQstatus(_conn) != CONNECTION_OK)
+        {
+            string msg {PQerrorMessage(_conn)};
+            disconnect();
+            throw pqxx::broken_connection(msg);
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::disconnect() noexcept
+    {
+        if (_conn != nullptr)
+        {
+            PQfinish(_conn);
+            _conn = nullptr;
+        }
+
+        // any results still pending are lost with the connection
+        _pending.clear();
+        _pending_error.clear();
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool LibpqConnection::isOpen() const noexcept { return _conn != nullptr && PQstatus(_conn) == CONNECTION_OK; }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::exec(const string &statement)
+    {
+        if (!isOpen())
+            throw pqxx::broken_connection("The libpq connection is not open");
+
+        auto *result = PQexec(_conn, statement.c_str());
+        auto status = PQresultStatus(result);
+        PQclear(result);
+
+        if (PQstatus(_conn) != CONNECTION_OK)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+
+        if (status != PGRES_COMMAND_OK)
+            throw pqxx::sql_error(PQerrorMessage(_conn), statement);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::copyIn(const string &statement, const string &data)
+    {
+        if (!isOpen())
+            throw pqxx::broken_connection("The libpq connection is not open");
+
+        auto *result = PQexec(_conn, statement.c_str());
+        auto status = PQresultStatus(result);
+        PQclear(result);
+
+        // a lost connection must not be mistaken for a refused statement
+        if (PQstatus(_conn) != CONNECTION_OK)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+
+        if (status != PGRES_COPY_IN)
+            throw pqxx::sql_error(PQerrorMessage(_conn), statement);
+
+        string::size_type sent = 0;
+
+        while (sent < data.size())
+        {
+            auto length = min(CopyChunkSize, data.size() - sent);
+
+            if (PQputCopyData(_conn, data.data() + sent, static_cast<int>(length)) != 1)
+                break;
+
+            sent += length;
+        }
+
+        // on a failed send, end the copy with an error so the server abandons it
+        string error;
+
+        if (sent < data.size())
+        {
+            error = PQerrorMessage(_conn);
+            PQputCopyEnd(_conn, "Failed to send copy data");
+        }
+        else if (PQputCopyEnd(_conn, nullptr) != 1)
+        {
+            error = PQerrorMessage(_conn);
+        }
+
+        // collect the results of the copy, there must be no results left
+        // pending before the connection can be used again
+        while ((result = PQgetResult(_conn)) != nullptr)
+        {
+            if (PQresultStatus(result) != PGRES_COMMAND_OK && error.empty())
+                error = PQresultErrorMessage(result);
+
+            PQclear(result);
+        }
+
+        if (PQstatus(_conn) != CONNECTION_OK)
+            throw pqxx::broken_connection(error);
+
+        if (!error.empty())
+            throw pqxx::sql_error(error, statement);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool LibpqConnection::pipelineSupported() const noexcept
+    {
+#ifdef LIBPQ_HAS_PIPELINING
+        return isOpen() && PQserverVersion(_conn) >= 140000;
+#else
+        return false;
+#endif
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::enterPipelineMode()
+    {
+        if (!isOpen())
+            throw pqxx::broken_connection("The libpq connection is not open");
+
+#ifdef LIBPQ_HAS_PIPELINING
+        if (PQsetnonblocking(_conn, 1) != 0 || PQenterPipelineMode(_conn) != 1)
+            throw pqxx::failure(PQerrorMessage(_conn));
+
+        _pending.clear();
+        _pending_error.clear();
+#else
+        throw pqxx::failure("The libpq library was built without pipeline mode support");
+#endif
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool LibpqConnection::inPipelineMode() const noexcept
+    {
+#ifdef LIBPQ_HAS_PIPELINING
+        return isOpen() && PQpipelineStatus(_conn) != PQ_PIPELINE_OFF;
+#else
+        return false;
+#endif
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::sendPrepare(const string &name, const string &statement, const string &tag)
+    {
+        checkPipeline();
+
+#ifdef LIBPQ_HAS_PIPELINING
+        if (PQsendPrepare(_conn, name.c_str(), statement.c_str(), 0, nullptr) != 1 || PQpipelineSync(_conn) != 1)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+
+        _pending.push_back(tag);
+        flushPipeline();
+#endif
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::sendPrepared(const string &name, const vector<const char *> &params, const string &tag)
+    {
+        checkPipeline();
+
+#ifdef LIBPQ_HAS_PIPELINING
+        // all params are text, so no lengths or formats are required
+        auto sent = PQsendQueryPrepared(
+            _conn, name.c_str(), static_cast<int>(params.size()), params.data(), nullptr, nullptr, 0);
+
+        if (sent != 1 || PQpipelineSync(_conn) != 1)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+
+        _pending.push_back(tag);
+        flushPipeline();
+#endif
+    }
+
+    //=============================================================================
+    //=============================================================================
+    vector<LibpqConnection::PipelineResult> LibpqConnection::collect(bool wait)
+    {
+        vector<PipelineResult> results;
+
+        if (_pending.empty())
+            return results;
+
+        checkPipeline();
+
+#ifdef LIBPQ_HAS_PIPELINING
+        // requests may still be queued on the client, they must reach the server
+        // before their results can be waited on
+        flushPipeline();
+
+        // read whatever has arrived so far, so PQisBusy() can tell us if a
+        // result is available without blocking
+        if (!wait && PQconsumeInput(_conn) != 1)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+
+        while (!_pending.empty())
+        {
+            if (PQisBusy(_conn) == 1)
+            {
+                if (!wait)
+                    break;
+
+                // wait for the result here rather than in PQgetResult(), which has no timeout
+                waitSocket(POLLIN);
+                continue;
+            }
+
+            // each request gives its results followed by a null, and then the
+            // result of its sync, which marks the request as complete
+            auto *result = PQgetResult(_conn);
+
+            if (result != nullptr)
+            {
+                auto status = PQresultStatus(result);
+
+                if (status == PGRES_PIPELINE_SYNC)
+                {
+                    results.push_back(PipelineResult {_pending.front(), _pending_error});
+                    _pending.pop_front();
+                    _pending_error.clear();
+                }
+                else if (status == PGRES_FATAL_ERROR && _pending_error.empty())
+                {
+                    _pending_error = PQresultErrorMessage(result);
+                }
+                else if (status == PGRES_PIPELINE_ABORTED && _pending_error.empty())
+                {
+                    _pending_error = "The request was aborted by an earlier error";
+                }
+
+                PQclear(result);
+            }
+
+            if (PQstatus(_conn) != CONNECTION_OK)
+                throw pqxx::broken_connection(PQerrorMessage(_conn));
+        }
+#endif
+
+        return results;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::checkPipeline()
+    {
+        if (!isOpen())
+            throw pqxx::broken_connection("The libpq connection is not open");
+
+        if (!inPipelineMode())
+            throw pqxx::failure("The libpq connection is not in pipeline mode");
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::flushPipeline()
+    {
+        int flushed;
+
+        // a return of one means the socket would block, so wait until it can take more
+        // data, or until results arrive to be read, and try again
+        while ((flushed = PQflush(_conn)) == 1)
+            waitSocket(POLLIN | POLLOUT);
+
+        if (flushed != 0)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+    }
+
+    //=============================================================================
+    //=============================================================================
+    void LibpqConnection::waitSocket(short events)
+    {
+        pollfd fd {PQsocket(_conn), events, 0};
+        auto ready = poll(&fd, 1, static_cast<int>(_timeout.count()));
+
+        if (ready < 0 && errno != EINTR)
+            throw pqxx::broken_connection("Failed to wait on the libpq connection socket");
+
+        // the server has stopped responding without the connection failing, so it is
+        // closed here to be reported as lost, its pending requests are lost with it
+        if (ready == 0)
+        {
+            disconnect();
+            throw pqxx::broken_connection("Timed out waiting on the libpq connection");
+        }
+
+        if ((fd.revents & POLLIN) != 0 && PQconsumeInput(_conn) != 1)
+            throw pqxx::broken_connection(PQerrorMessage(_conn));
+    }
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
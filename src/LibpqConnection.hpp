@@ -0,0 +1,122 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _LIBPQ_CONNECTION_HPP
+#define _LIBPQ_CONNECTION_HPP
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+// forward declare the libpq connection, so libpq-fe.h is not
+// dragged into every file including this header
+struct pg_conn;
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // A thin wrapper around a native libpq connection, used for the features libpqxx
+    // does not expose, such as binary COPY and pipeline mode. Errors are raised as the
+    // equivalent pqxx exceptions, so the caller can handle failures from either connection
+    // the same way.
+    class LibpqConnection
+    {
+    public:
+        // the result of a pipelined request, the tag is the one given when it was sent
+        // and the error is empty when the request succeeded
+        struct PipelineResult
+        {
+            std::string tag;
+            std::string error;
+        };
+
+        LibpqConnection() = default;
+        ~LibpqConnection();
+
+        LibpqConnection(const LibpqConnection &) = delete;
+        LibpqConnection &operator=(const LibpqConnection &) = delete;
+
+        void connect(const std::string &connect_string);
+        void disconnect() noexcept;
+        bool isOpen() const noexcept;
+
+        // run a statement that returns no rows, such as BEGIN or an INSERT
+        void exec(const std::string &statement);
+
+        // run the given COPY ... FROM STDIN statement and send the data to it,
+        // the data must already be fully encoded in the statement's format
+        void copyIn(const std::string &statement, const std::string &data);
+
+        // pipeline API
+
+        // pipeline mode requires both a libpq and a server of version 14 or later. The
+        // connection is made non blocking on entering it, so requests are sent without
+        // waiting on a server that is itself blocked sending results
+        bool pipelineSupported() const noexcept;
+        void enterPipelineMode();
+        bool inPipelineMode() const noexcept;
+
+        // Queue requests without waiting for their results. Each request is followed by
+        // a sync, so it runs in its own implicit transaction exactly as if it had been
+        // sent on its own, and a failure does not affect the requests around it. The
+        // tag is reported back should the request fail. Params are sent as text, a
+        // nullptr param is sent as a null
+        void sendPrepare(const std::string &name, const std::string &statement, const std::string &tag);
+
+        void sendPrepared(
+            const std::string &name, const std::vector<const char *> &params, const std::string &tag);
+
+        // reconcile the results of sent requests. When wait is false only results that
+        // have already arrived are read, otherwise this waits for every pending request.
+        // The results of the completed requests are returned in the order they were sent
+        std::vector<PipelineResult> collect(bool wait);
+
+        // number of requests sent whose results have not yet been collected
+        std::size_t pending() const noexcept { return _pending.size(); }
+
+        // the longest the pipeline waits on the server to take requests or return
+        // results, after which the connection is closed as lost
+        void setTimeout(std::chrono::milliseconds timeout) { _timeout = timeout; }
+
+    private:
+        void checkPipeline();
+
+        // send everything queued on the non blocking connection, reading any results
+        // that arrive meanwhile so the server is never left blocked on them
+        void flushPipeline();
+
+        // wait up to the timeout for the socket to be ready for events, reading any
+        // input that has arrived
+        void waitSocket(short events);
+
+        pg_conn *_conn = nullptr;
+
+        // tags of the pipelined requests waiting on a result, in the order sent
+        std::deque<std::string> _pending;
+
+        // first error seen for the request at the front of the pending queue
+        std::string _pending_error;
+
+        std::chrono::milliseconds _timeout {10000};
+    };
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _LIBPQ_CONNECTION_HPP
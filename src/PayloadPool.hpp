@@ -0,0 +1,118 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _PAYLOAD_POOL_HPP
+#define _PAYLOAD_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// The PayloadPool recycles the vectors data event values are extracted into. Every
+// event needs a read and a write vector, and without the pool both are allocated by
+// the transaction and freed once the connection has stored them. A released vector is
+// cleared and kept with its capacity, so the next event of a similar size is
+// extracted without touching the heap.
+//
+// Each thread has its own pool per type, so there is no locking, and vectors are
+// normally acquired and released on the same thread, the caller's or the writer
+// thread's. A vector released on another thread simply joins that thread's pool.
+// The pool is bounded in both the number of vectors and the size of each, so an
+// occasional large image does not stay allocated.
+template<typename T>
+class PayloadPool
+{
+public:
+    // most vectors kept per thread, and the largest capacity worth keeping
+    static const std::size_t MaxPooled = 8;
+    static const std::size_t MaxPooledBytes = 4 * 1024 * 1024;
+
+    // an empty vector, recycled when one is available
+    static std::unique_ptr<std::vector<T>> acquire()
+    {
+        auto &pool = threadPool();
+
+        if (pool.empty())
+            return std::make_unique<std::vector<T>>();
+
+        auto payload = std::move(pool.back());
+        pool.pop_back();
+        return payload;
+    }
+
+    // return a vector to the pool, it is freed instead when the pool is full or the
+    // vector is too large to keep
+    static void release(std::unique_ptr<std::vector<T>> payload) noexcept
+    {
+        if (!payload)
+            return;
+
+        auto &pool = threadPool();
+
+        if (pool.size() >= MaxPooled || payload->capacity() * sizeof(T) > MaxPooledBytes)
+            return;
+
+        payload->clear();
+        pool.push_back(std::move(payload));
+    }
+
+    // number of vectors waiting on the calling thread
+    static std::size_t size() noexcept { return threadPool().size(); }
+
+private:
+    static std::vector<std::unique_ptr<std::vector<T>>> &threadPool() noexcept
+    {
+        // reserved up front so release() never allocates
+        thread_local std::vector<std::unique_ptr<std::vector<T>>> pool = [] {
+            std::vector<std::unique_ptr<std::vector<T>>> p;
+            p.reserve(MaxPooled);
+            return p;
+        }();
+
+        return pool;
+    }
+};
+
+// Releases the values of a data event back to the PayloadPool when it goes out of
+// scope, whichever way the store completes
+template<typename T>
+class PayloadRecycler
+{
+public:
+    PayloadRecycler(std::unique_ptr<std::vector<T>> &value_r, std::unique_ptr<std::vector<T>> &value_w) :
+        _value_r(value_r), _value_w(value_w)
+    {}
+
+    ~PayloadRecycler()
+    {
+        PayloadPool<T>::release(std::move(_value_r));
+        PayloadPool<T>::release(std::move(_value_w));
+    }
+
+    PayloadRecycler(const PayloadRecycler &) = delete;
+    PayloadRecycler &operator=(const PayloadRecycler &) = delete;
+
+private:
+    std::unique_ptr<std::vector<T>> &_value_r;
+    std::unique_ptr<std::vector<T>> &_value_w;
+};
+} // namespace hdbpp_internal
+#endif // _PAYLOAD_POOL_HPP
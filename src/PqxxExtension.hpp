@@ -20,10 +20,14 @@
 #ifndef _PQXX_EXTENSION_HPP
 #define _PQXX_EXTENSION_HPP
 
-#include <algorithm>
+#include "ArrayParse.hpp"
+#include "TextFormat.hpp"
+
+#include <cstring>
 #include <iostream>
 #include <pqxx/pqxx>
 #include <pqxx/strconv>
+#include <type_traits>
 #include <vector>
 
 // why is it OmniORB (via Tango)) and Pqxx define these types in different ways? Perhaps
@@ -36,6 +40,24 @@
 
 #include <tango.h>
 
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // A single field of a COPY row that may be null. The text is the unescaped
+    // postgres text representation of the value, the pqxx COPY stream applies
+    // the COPY escaping itself when writing the row
+    struct CopyField
+    {
+        CopyField() = default;
+        explicit CopyField(std::string value) : null(false), text(std::move(value)) {}
+
+        bool null = true;
+        std::string text;
+    };
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+
 namespace pqxx
 {
 namespace internal
@@ -136,34 +158,14 @@ public:
         if (str == nullptr)
             internal::throw_null_conversion(name());
 
-        if (str[0] != '{' || str[strlen(str) - 1] != '}')
-            throw pqxx::conversion_error("Invalid array format");
-
-        value.clear();
-
-        // not the best solution right now, but we are using this for testing only
-        // currently. Copy the str into a std::string so we can work with it more easily.
-        std::string in(str + 1, str + (strlen(str) - 1));
+        auto length = strlen(str);
 
-        // count commas and add one to deduce elements in the string,
-        // note we reduce string size to remove the brace at each end
-        auto items = std::count(in.begin(), in.end(), ',');
-        value.clear();
-
-        // preallocate all the items in the vector, we can then
-        // simply set each in turn
-        value.resize(items + 1);
-
-        auto element = 0;
-        std::string::size_type comma = 0;
+        if (length < 2 || str[0] != '{' || str[length - 1] != '}')
+            throw pqxx::conversion_error("Invalid array format");
 
-        // loop and copy out each value from between the separators
-        while ((comma = in.find_first_not_of(',', comma)) != std::string::npos)
-        {
-            auto next_comma = in.find_first_of(',', comma);
-            string_traits<T>::from_string(in.substr(comma, next_comma - comma).c_str(), value[element++]);
-            comma = next_comma;
-        }
+        // the elements are parsed in place, between the braces
+        if (!hdbpp_internal::pqxx_conn::array_parse::parseArray(str + 1, str + length - 1, value))
+            throw pqxx::conversion_error("Invalid array element for type " + std::string(name()));
     }
 
     static std::string to_string(const std::vector<T> &value)
@@ -171,7 +173,23 @@ public:
         if (value.empty())
             return {};
 
-        // simply use the pqxx utilities for this, rather than reinvent the wheel...
+        return to_string(value, std::is_arithmetic<T> {});
+    }
+
+private:
+    // numbers are formatted directly into a buffer sized from the element count, this
+    // is both quicker than the pqxx per element conversion and gives the shortest text
+    // that round trips floating point values
+    static std::string to_string(const std::vector<T> &value, std::true_type /* unused */)
+    {
+        std::string result;
+        hdbpp_internal::pqxx_conn::text_format::appendArray(result, value);
+        return result;
+    }
+
+    // anything else, for example DevState, uses the pqxx utilities
+    static std::string to_string(const std::vector<T> &value, std::false_type /* unused */)
+    {
         return "{" + separated_list(",", value.begin(), value.end()) + "}";
     }
 };
@@ -232,8 +250,8 @@ public:
 };
 
 // This specialisation is for bool, since it is not a normal container class, but
-// rather some kind of alien bitfield. We have to adjust the from_string to take into
-// account we can not use container element access
+// rather some kind of alien bitfield. Its elements are also written as true and false
+// rather than as the numbers the arithmetic types are formatted to
 template<>
 struct string_traits<std::vector<bool>>
 {
@@ -248,32 +266,15 @@ public:
         if (str == nullptr)
             internal::throw_null_conversion(name());
 
-        if (str[0] != '{' || str[strlen(str) - 1] != '}')
-            throw pqxx::conversion_error("Invalid array format");
-
-        value.clear();
-
-        // not the best solution right now, but we are using this for
-        // testing only. Copy the str into a std::string so we can work
-        // with it more easily.
-        std::string in(str + 1, str + (strlen(str) - 1));
-        std::string::size_type comma = 0;
+        auto length = strlen(str);
 
-        // loop and copy out each value from between the separators
-        while ((comma = in.find_first_not_of(',', comma)) != std::string::npos)
-        {
-            auto next_comma = in.find_first_of(',', comma);
-
-            // we can not pass an element of the vector, since vector<bool> is not
-            // in fact a container, but some kind of bit field. In this case, we
-            // have to create a local variable to read the value into, then push this
-            // back onto the vector
-            bool field;
-            string_traits<bool>::from_string(in.substr(comma, next_comma - comma).c_str(), field);
-            value.push_back(field);
+        if (length < 2 || str[0] != '{' || str[length - 1] != '}')
+            throw pqxx::conversion_error("Invalid array format");
 
-            comma = next_comma;
-        }
+        // vector<bool> is parsed as any other vector, since elements are only ever
+        // pushed onto it, never accessed as references
+        if (!hdbpp_internal::pqxx_conn::array_parse::parseArray(str + 1, str + length - 1, value))
+            throw pqxx::conversion_error("Invalid array element for type " + std::string(name()));
     }
 
     static std::string to_string(const std::vector<bool> &value)
@@ -286,6 +287,28 @@ public:
     }
 };
 
+// Allows a CopyField to be written by pqxx::stream_to, a null field is written
+// as the COPY null marker rather than as text
+template<>
+struct string_traits<hdbpp_internal::pqxx_conn::CopyField>
+{
+public:
+    static constexpr const char *name() noexcept { return "CopyField"; }
+    static constexpr bool has_null() noexcept { return true; }
+    static bool is_null(const hdbpp_internal::pqxx_conn::CopyField &field) { return field.null; }
+    static hdbpp_internal::pqxx_conn::CopyField null() { return {}; }
+
+    static void from_string(const char str[], hdbpp_internal::pqxx_conn::CopyField &value)
+    {
+        if (str == nullptr)
+            internal::throw_null_conversion(name());
+
+        value = hdbpp_internal::pqxx_conn::CopyField(str);
+    }
+
+    static std::string to_string(const hdbpp_internal::pqxx_conn::CopyField &field) { return field.text; }
+};
+
 // Specialization for unsigned char, which was not included in pqxx,
 // this becomes an int16_t in the database
 template<>
@@ -19,6 +19,8 @@
 
 #include "QueryBuilder.hpp"
 
+#include <cmath>
+#include <ctime>
 #include <map>
 #include <vector>
 
@@ -110,6 +112,51 @@ namespace pqxx_conn
         {
             return is_array ? "int4[]" : "int4";
         }
+
+        //=============================================================================
+        //=============================================================================
+        std::string interval(std::chrono::seconds duration)
+        {
+            return "INTERVAL '" + to_string(duration.count()) + " seconds'";
+        }
+
+        //=============================================================================
+        //=============================================================================
+        std::string epochToTimestamp(double event_time)
+        {
+            // work in whole microseconds to avoid a rounding carry into the seconds
+            auto total_us = static_cast<int64_t>(std::llround(event_time * 1.0e6));
+            auto seconds = total_us / 1000000;
+            auto micro_seconds = total_us % 1000000;
+
+            // keep the fractional part positive for times before the epoch
+            if (micro_seconds < 0)
+            {
+                micro_seconds += 1000000;
+                seconds -= 1;
+            }
+
+            auto time = static_cast<time_t>(seconds);
+            struct tm utc
+            {};
+
+            gmtime_r(&time, &utc);
+
+            char buffer[64];
+
+            snprintf(buffer,
+                sizeof(buffer),
+                "%04d-%02d-%02d %02d:%02d:%02d.%06ld+00",
+                utc.tm_year + 1900,
+                utc.tm_mon + 1,
+                utc.tm_mday,
+                utc.tm_hour,
+                utc.tm_min,
+                utc.tm_sec,
+                static_cast<long>(micro_seconds));
+
+            return buffer;
+        }
     } // namespace query_utils
 
     //=============================================================================
@@ -128,6 +175,14 @@ namespace pqxx_conn
         return handleCache(_data_event_error_query_names, traits, StoreDataEventError);
     }
 
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::storeDataEventPackedName(const AttributeTraits &traits)
+    {
+        // generic check and emplace for new items
+        return handleCache(_data_event_packed_query_names, traits, StoreDataEventPacked);
+    }
+
     //=============================================================================
     //=============================================================================
     const string &QueryBuilder::storeAttributeStatement()
@@ -183,6 +238,8 @@ namespace pqxx_conn
     //=============================================================================
     const string &QueryBuilder::storeHistoryEventStatement()
     {
+        // the event name is not unique in the table, connections storing a new event
+        // at the same time may both insert it, so only ever take the first one
         // clang-format off
         static string query =
             "INSERT INTO " + schema::HistoryTableName + " (" + 
@@ -192,7 +249,8 @@ namespace pqxx_conn
                 "SELECT " +
                     "$1," + schema::HistoryEventColEventId + ",CURRENT_TIMESTAMP(6)" +
                 " FROM " + schema::HistoryEventTableName +
-                " WHERE " + schema::HistoryEventColEvent + " = $2";
+                " WHERE " + schema::HistoryEventColEvent + " = $2" +
+                " ORDER BY " + schema::HistoryEventColEventId + " LIMIT 1";
         // clang-format on
 
         return query;
@@ -260,14 +318,173 @@ namespace pqxx_conn
         return result->second;
     }
 
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::storeDataEventPackedStatement(const AttributeTraits &traits)
+    {
+        // search the cache for a previous entry
+        auto result = _data_event_packed_queries.find(traits);
+
+        if (result == _data_event_packed_queries.end())
+        {
+            auto param_number = 0;
+
+            auto query = "INSERT INTO " + QueryBuilder::tableName(traits) + " (" + schema::DatColId + "," +
+                schema::DatColDataTime;
+
+            if (traits.hasReadData())
+                query = query + "," + schema::DatColValueRPacked;
+
+            if (traits.hasWriteData())
+                query = query + "," + schema::DatColValueWPacked;
+
+            // split to ensure increments are in the correct order
+            query = query + "," + schema::DatColQuality + ") VALUES ($" + to_string(++param_number);
+            query = query + ",TO_TIMESTAMP($" + to_string(++param_number) + ")";
+
+            // the packed values are bound as binary, so need no cast
+            if (traits.hasReadData())
+                query = query + "," + "$" + to_string(++param_number);
+
+            if (traits.hasWriteData())
+                query = query + "," + "$" + to_string(++param_number);
+
+            query = query + "," + "$" + to_string(++param_number) + ")";
+
+            // cache the query string against the traits
+            _data_event_packed_queries.emplace(traits, query);
+
+            spdlog::debug("Built new packed data event query and cached it against traits: {}", traits);
+            spdlog::debug("New packed data event query is: {}", query);
+
+            // now return it (must dereference the map again to get the static version)
+            return _data_event_packed_queries[traits];
+        }
+
+        // return the previously cached example
+        return result->second;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::storeDataEventBatchStatement(const string &table_name)
+    {
+        // clang-format off
+        return "INSERT INTO " + table_name + " (" +
+            schema::DatColId + "," +
+            schema::DatColDataTime + "," +
+            schema::DatColValueR + "," +
+            schema::DatColValueW + "," +
+            schema::DatColQuality + ") VALUES ";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::storeDataEventStringPrefix(const AttributeTraits &traits)
+    {
+        auto result = _data_event_string_prefixes.find(traits);
+
+        if (result == _data_event_string_prefixes.end())
+        {
+            auto query = "INSERT INTO " + QueryBuilder::tableName(traits) + " (" + schema::DatColId + "," +
+                schema::DatColDataTime;
+
+            if (traits.hasReadData())
+                query = query + "," + schema::DatColValueR;
+
+            if (traits.hasWriteData())
+                query = query + "," + schema::DatColValueW;
+
+            query = query + "," + schema::DatColQuality + ") VALUES (";
+
+            result = _data_event_string_prefixes.emplace(traits, query).first;
+        }
+
+        return result->second;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::storeDataEventSkipStored()
+    {
+        static string clause = " ON CONFLICT (" + schema::DatColId + "," + schema::DatColDataTime + ") DO NOTHING";
+
+        return clause;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const vector<string> &QueryBuilder::storeDataEventCopyColumns()
+    {
+        static vector<string> columns {
+            schema::DatColId, schema::DatColDataTime, schema::DatColValueR, schema::DatColValueW, schema::DatColQuality};
+
+        return columns;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::storeDataEventCopyStatement(const string &table_name, bool binary)
+    {
+        auto &columns = storeDataEventCopyColumns();
+        auto query = "COPY " + table_name + " (" + columns[0];
+
+        for (auto iter = columns.begin() + 1; iter != columns.end(); ++iter)
+            query = query + "," + *iter;
+
+        query += ") FROM STDIN";
+
+        if (binary)
+            query += " (FORMAT binary)";
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::storeDataEventStagingTable(const string &table_name)
+    {
+        // the name must differ from the data table, a temporary table of the same
+        // name would hide it for the rest of the session
+        return table_name + "_staging";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::createStagingTableStatement(const string &table_name)
+    {
+        return "CREATE TEMP TABLE IF NOT EXISTS " + storeDataEventStagingTable(table_name) + " (LIKE " + table_name +
+            ") ON COMMIT DELETE ROWS";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::storeStagedDataEventsStatement(const string &table_name)
+    {
+        auto &columns = storeDataEventCopyColumns();
+        auto column_list = columns[0];
+
+        for (auto iter = columns.begin() + 1; iter != columns.end(); ++iter)
+            column_list = column_list + "," + *iter;
+
+        return "INSERT INTO " + table_name + " (" + column_list + ") SELECT " + column_list + " FROM " +
+            storeDataEventStagingTable(table_name) + storeDataEventSkipStored();
+    }
+
     //=============================================================================
     //=============================================================================
     const string &QueryBuilder::storeErrorStatement()
     {
+        // the conflict clause returns the existing id when another connection
+        // stored the same error message first
         // clang-format off
         static string query = 
             "INSERT INTO " + schema::ErrTableName + " (" +
-                schema::ErrColErrorDesc + ") VALUES ($1) RETURNING " + schema::ErrColId;
+                schema::ErrColErrorDesc + ") VALUES ($1) " +
+                "ON CONFLICT (" + schema::ErrColErrorDesc + ") DO UPDATE SET " +
+                schema::ErrColErrorDesc + " = EXCLUDED." + schema::ErrColErrorDesc +
+                " RETURNING " + schema::ErrColId;
         // clang-format on
 
         return query;
@@ -275,18 +492,381 @@ namespace pqxx_conn
 
     //=============================================================================
     //=============================================================================
-    const string QueryBuilder::fetchAllValuesStatement(
+    const string QueryBuilder::fetchValueStatement(
         const string &column_name, const string &table_name, const string &reference)
     {
-        return "SELECT " + column_name + ", " + reference + " " + "FROM " + table_name;
+        return "SELECT " + column_name + " " + "FROM " + table_name + " WHERE " + reference + "=$1";
     }
 
     //=============================================================================
     //=============================================================================
-    const string QueryBuilder::fetchValueStatement(
-        const string &column_name, const string &table_name, const string &reference)
+    string QueryBuilder::fetchDataEventsStatement(
+        const AttributeTraits &traits, int conf_id, double start_time, double end_time, bool packed)
     {
-        return "SELECT " + column_name + " " + "FROM " + table_name + " WHERE " + reference + "=$1";
+        // a row holds its values in either the array or the packed columns
+        auto packed_columns = packed ? "," + schema::DatColValueRPacked + "," + schema::DatColValueWPacked : "";
+
+        // the range matches the (att_conf_id, data_time) index of every data table, so
+        // only the requested events are read
+        // clang-format off
+        return "SELECT EXTRACT(EPOCH FROM " + schema::DatColDataTime + ")," +
+                schema::DatColValueR + "," +
+                schema::DatColValueW + "," +
+                schema::DatColQuality +
+                packed_columns +
+            " FROM " + tableName(traits) +
+            " WHERE " + schema::DatColId + "=" + to_string(conf_id) +
+            " AND " + schema::DatColDataTime + ">='" + query_utils::epochToTimestamp(start_time) + "'" +
+            " AND " + schema::DatColDataTime + "<'" + query_utils::epochToTimestamp(end_time) + "'" +
+            " ORDER BY " + schema::DatColDataTime + " ASC";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::storeAttributeTtlStatement()
+    {
+        // clang-format off
+        static string query =
+            "UPDATE " + schema::ConfTableName +
+                " SET " + schema::ConfColTtl + "=$1" +
+                " WHERE " + schema::ConfColId + "=$2" +
+                " AND " + schema::ConfColTtl + " IS DISTINCT FROM $1";
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchDataTablesStatement()
+    {
+        // the underscore after the format is escaped, since it matches any character in a LIKE pattern
+        auto pattern = [](const string &format) {
+            return "hypertable_name LIKE '" + schema::SchemaTablePrefix + format + "\\_%'";
+        };
+
+        // clang-format off
+        static string query =
+            "SELECT hypertable_name,compression_enabled" +
+            string(" FROM timescaledb_information.hypertables") +
+            " WHERE hypertable_schema=current_schema()" +
+            " AND (" + pattern(schema::TypeScalar) +
+                " OR " + pattern(schema::TypeArray) +
+                " OR " + pattern(schema::TypeImage) + ")" +
+            " ORDER BY hypertable_name";
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchPackedTablesStatement()
+    {
+        // clang-format off
+        static string query =
+            "SELECT table_name FROM information_schema.columns" +
+            string(" WHERE table_schema=current_schema()") +
+            " AND column_name='" + schema::DatColValueRPacked + "'";
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::fetchIngestRateStatement(const string &table_name)
+    {
+        // compressed chunks are excluded, since their size no longer reflects the rate
+        // they were written at, and the current chunk only counts up to now
+        // clang-format off
+        return "SELECT SUM(s.total_bytes)::float8/" +
+                string("NULLIF(EXTRACT(EPOCH FROM LEAST(MAX(c.range_end),now())-MIN(c.range_start)),0)") +
+            " FROM chunks_detailed_size('" + table_name + "') s" +
+            " JOIN timescaledb_information.chunks c" +
+            " ON c.chunk_schema=s.chunk_schema AND c.chunk_name=s.chunk_name" +
+            " WHERE NOT c.is_compressed AND c.range_end>now()-INTERVAL '30 days'";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::setChunkIntervalStatement(const string &table_name, std::chrono::seconds interval)
+    {
+        return "SELECT set_chunk_time_interval('" + table_name + "',INTERVAL '" + to_string(interval.count()) +
+            " seconds')";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::enableCompressionStatement(const string &table_name)
+    {
+        // clang-format off
+        return "ALTER TABLE " + table_name + " SET (" +
+            "timescaledb.compress," +
+            "timescaledb.compress_segmentby='" + schema::DatColId + "'," +
+            "timescaledb.compress_orderby='" + schema::DatColDataTime + " DESC')";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::removeCompressionPolicyStatement(const string &table_name)
+    {
+        return "SELECT remove_compression_policy('" + table_name + "',if_exists=>true)";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::addCompressionPolicyStatement(const string &table_name, std::chrono::hours compress_after)
+    {
+        return "SELECT add_compression_policy('" + table_name + "',INTERVAL '" + to_string(compress_after.count()) +
+            " hours')";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchAttributeTtlsStatement()
+    {
+        // clang-format off
+        static string query =
+            "SELECT " + schema::ConfColId + "," +
+                schema::ConfColTableName + "," +
+                schema::ConfColTtl +
+            " FROM " + schema::ConfTableName +
+            " WHERE " + schema::ConfColTtl + ">0" +
+            " ORDER BY " + schema::ConfColId;
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchTableTtlsStatement()
+    {
+        // clang-format off
+        static string query =
+            "SELECT " + schema::ConfColTableName + "," +
+                "min(COALESCE(" + schema::ConfColTtl + ",0))," +
+                "max(COALESCE(" + schema::ConfColTtl + ",0))" +
+            " FROM " + schema::ConfTableName +
+            " GROUP BY " + schema::ConfColTableName +
+            " ORDER BY " + schema::ConfColTableName;
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::dropExpiredChunksStatement(const string &table_name, int ttl)
+    {
+        return "SELECT drop_chunks('" + table_name + "',older_than=>INTERVAL '" + to_string(ttl) + " hours')";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchCompressedEndsStatement()
+    {
+        // clang-format off
+        static string query =
+            "SELECT hypertable_name,extract(epoch FROM max(range_end))::bigint" +
+            string(" FROM timescaledb_information.chunks") +
+            " WHERE hypertable_schema=current_schema() AND is_compressed" +
+            " GROUP BY hypertable_name";
+        // clang-format on
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::deleteExpiredEventsStatement(
+        const string &table_name, int conf_id, int ttl, int64_t uncompressed_from)
+    {
+        // the time to live is in hours
+        // clang-format off
+        auto query = "DELETE FROM " + table_name +
+            " WHERE " + schema::DatColId + "=" + to_string(conf_id) +
+            " AND " + schema::DatColDataTime + "<now()-INTERVAL '" + to_string(ttl) + " hours'";
+        // clang-format on
+
+        if (uncompressed_from != 0)
+            query += " AND " + schema::DatColDataTime + ">=to_timestamp(" + to_string(uncompressed_from) + ")";
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const vector<Rollup> &QueryBuilder::rollups()
+    {
+        // the refresh windows cover late events for a day, a week and a month, more recent
+        // buckets are aggregated from the data table as they are read
+        static const vector<Rollup> levels {
+            {"1m", chrono::minutes(1), chrono::hours(24), chrono::minutes(1), chrono::minutes(5)},
+            {"1h", chrono::hours(1), chrono::hours(24 * 7), chrono::hours(1), chrono::hours(1)},
+            {"1d", chrono::hours(24), chrono::hours(24 * 31), chrono::hours(24), chrono::hours(24)}};
+
+        return levels;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    bool QueryBuilder::hasRollups(const AttributeTraits &traits) noexcept
+    {
+        if (!traits.isScalar())
+            return false;
+
+        switch (traits.type())
+        {
+            case Tango::DEV_DOUBLE:
+            case Tango::DEV_FLOAT:
+            case Tango::DEV_LONG:
+            case Tango::DEV_ULONG:
+            case Tango::DEV_LONG64:
+            case Tango::DEV_ULONG64:
+            case Tango::DEV_SHORT:
+            case Tango::DEV_USHORT:
+            case Tango::DEV_UCHAR: return true;
+
+            default: return false;
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const Rollup *QueryBuilder::selectRollup(std::chrono::seconds resolution) noexcept
+    {
+        const Rollup *selected = nullptr;
+
+        for (const auto &rollup : rollups())
+            if (resolution.count() > 0 && resolution.count() % rollup.bucket.count() == 0)
+                selected = &rollup;
+
+        return selected;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::rollupName(const AttributeTraits &traits, const Rollup &rollup)
+    {
+        return tableName(traits) + "_" + rollup.suffix;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::createRollupStatement(const AttributeTraits &traits, const Rollup &rollup)
+    {
+        auto bucket = "time_bucket(" + query_utils::interval(rollup.bucket) + "," + schema::DatColDataTime + ")";
+
+        // real time aggregation is enabled, so buckets newer than the last refresh are
+        // still returned, it is no longer the default from TimescaleDB 2.13
+        // clang-format off
+        return "CREATE MATERIALIZED VIEW IF NOT EXISTS " + rollupName(traits, rollup) +
+            " WITH (timescaledb.continuous,timescaledb.materialized_only=false) AS" +
+            " SELECT " + schema::DatColId + "," +
+                bucket + " AS " + schema::RollupColBucket + "," +
+                "MIN(" + schema::DatColValueR + ") AS " + schema::RollupColMin + "," +
+                "MAX(" + schema::DatColValueR + ") AS " + schema::RollupColMax + "," +
+                "AVG(" + schema::DatColValueR + ") AS " + schema::RollupColAvg + "," +
+                "COUNT(" + schema::DatColValueR + ") AS " + schema::RollupColCount +
+            " FROM " + tableName(traits) +
+            " GROUP BY " + schema::DatColId + "," + bucket +
+            " WITH NO DATA";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::addRollupPolicyStatement(const AttributeTraits &traits, const Rollup &rollup)
+    {
+        // clang-format off
+        return "SELECT add_continuous_aggregate_policy('" + rollupName(traits, rollup) + "'," +
+            "start_offset=>" + query_utils::interval(rollup.start_offset) + "," +
+            "end_offset=>" + query_utils::interval(rollup.end_offset) + "," +
+            "schedule_interval=>" + query_utils::interval(rollup.schedule) + "," +
+            "if_not_exists=>true)";
+        // clang-format on
+    }
+
+    //=============================================================================
+    //=============================================================================
+    const string &QueryBuilder::fetchRollupNamesStatement()
+    {
+        static string query = "SELECT view_name FROM timescaledb_information.continuous_aggregates"
+                              " WHERE view_schema=current_schema()";
+
+        return query;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::fetchFirstEventStatement(const string &table_name)
+    {
+        return "SELECT extract(epoch FROM min(" + schema::DatColDataTime + "))::bigint FROM " + table_name;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::refreshRollupStatement(
+        const AttributeTraits &traits, const Rollup &rollup, std::int64_t start, std::int64_t end)
+    {
+        return "CALL refresh_continuous_aggregate('" + rollupName(traits, rollup) + "',TO_TIMESTAMP(" +
+            to_string(start) + "),TO_TIMESTAMP(" + to_string(end) + "))";
+    }
+
+    //=============================================================================
+    //=============================================================================
+    string QueryBuilder::fetchRollupStatement(const AttributeTraits &traits,
+        const Rollup *rollup,
+        int conf_id,
+        double start_time,
+        double end_time,
+        std::chrono::seconds resolution)
+    {
+        auto time = schema::DatColDataTime;
+        auto source = tableName(traits);
+        string aggregates;
+        string count;
+
+        // clang-format off
+        if (rollup != nullptr)
+        {
+            // a rollup's buckets are combined into those of the resolution, the average
+            // weighted by the number of values in each
+            time = schema::RollupColBucket;
+            source = rollupName(traits, *rollup);
+            count = "SUM(" + schema::RollupColCount + ")";
+
+            aggregates =
+                "MIN(" + schema::RollupColMin + ")::float8," +
+                "MAX(" + schema::RollupColMax + ")::float8," +
+                "(SUM(" + schema::RollupColAvg + "*" + schema::RollupColCount + ")/" + count + ")::float8," +
+                count + "::int8";
+        }
+        else
+        {
+            count = "COUNT(" + schema::DatColValueR + ")";
+
+            aggregates =
+                "MIN(" + schema::DatColValueR + ")::float8," +
+                "MAX(" + schema::DatColValueR + ")::float8," +
+                "AVG(" + schema::DatColValueR + ")::float8," +
+                count;
+        }
+
+        return "SELECT EXTRACT(EPOCH FROM time_bucket(" + query_utils::interval(resolution) + "," + time + "))," +
+                aggregates +
+            " FROM " + source +
+            " WHERE " + schema::DatColId + "=" + to_string(conf_id) +
+            " AND " + time + ">='" + query_utils::epochToTimestamp(start_time) + "'" +
+            " AND " + time + "<'" + query_utils::epochToTimestamp(end_time) + "'" +
+            " GROUP BY 1 HAVING " + count + ">0" +
+            " ORDER BY 1 ASC";
+        // clang-format on
     }
 
     //=============================================================================
@@ -337,6 +917,22 @@ namespace pqxx_conn
         return query;
     }
 
+    //=============================================================================
+    //=============================================================================
+    const std::string &QueryBuilder::fetchDomainOidsStatement()
+    {
+        // clang-format off
+        static string query =
+            "SELECT typname, oid FROM pg_type WHERE typname IN ('" +
+                schema::DomainUchar + "','" +
+                schema::DomainUshort + "','" +
+                schema::DomainUlong + "','" +
+                schema::DomainUlong64 + "')";
+        // clang-format on
+
+        return query;
+    }
+
     //=============================================================================
     //=============================================================================
     string QueryBuilder::tableName(const AttributeTraits &traits)
@@ -401,6 +997,35 @@ namespace pqxx_conn
         return result->second;
     }
 
+    //=============================================================================
+    //=============================================================================
+    std::map<std::string, std::string> QueryBuilder::preparedStatements() const
+    {
+        std::map<std::string, std::string> statements {{StoreAttribute, storeAttributeStatement()},
+            {StoreHistoryEvent, storeHistoryEventStatement()},
+            {StoreHistoryString, storeHistoryStringStatement()},
+            {StoreParameterEvent, storeParameterEventStatement()},
+            {StoreErrorString, storeErrorStatement()},
+            {FetchLastHistoryEvent, fetchLastHistoryEventStatement()},
+            {FetchAttributeTraits, fetchAttributeTraitsStatement()}};
+
+        // the names and queries are cached separately, only those with both are complete
+        auto add_cached = [&statements](const auto &names, const auto &queries) {
+            for (auto &name : names)
+            {
+                auto query = queries.find(name.first);
+
+                if (query != queries.end())
+                    statements.emplace(name.second, query->second);
+            }
+        };
+
+        add_cached(_data_event_query_names, _data_event_queries);
+        add_cached(_data_event_error_query_names, _data_event_error_queries);
+        add_cached(_data_event_packed_query_names, _data_event_packed_queries);
+        return statements;
+    }
+
     //=============================================================================
     //=============================================================================
     void QueryBuilder::print(std::ostream &os) const noexcept
@@ -408,7 +1033,9 @@ namespace pqxx_conn
         os << "QueryBuilder(cached "
            << "data_event: name/query " << _data_event_query_names.size() << "/" << _data_event_queries.size() << ", "
            << "data_event_error: name/query " << _data_event_error_query_names.size() << "/"
-           << _data_event_error_queries.size() << ")";
+           << _data_event_error_queries.size() << ", "
+           << "data_event_packed: name/query " << _data_event_packed_query_names.size() << "/"
+           << _data_event_packed_queries.size() << ")";
     }
 } // namespace pqxx_conn
 } // namespace hdbpp_internal
@@ -23,11 +23,19 @@
 #include "AttributeTraits.hpp"
 #include "HdbppDefines.hpp"
 #include "PqxxExtension.hpp"
+#include "TextFormat.hpp"
 #include "TimescaleSchema.hpp"
 #include "spdlog/spdlog.h"
 
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace std
 {
@@ -61,76 +69,249 @@ namespace pqxx_conn
         template<typename T>
         std::string postgresCast(bool is_array);
 
-        // Convert the given data into a string suitable for storing in the database. These calls
-        // are used to build the string version of the insert command, they are required since we
-        // need to specialise for strings (to ensure we do not store escape characters) and bools
-        // (which are in fact a bitfield internally and wont convert in the via the pqxx routines )
+        // Append the text of a single value to a query. Numbers are formatted straight into
+        // the buffer, so building a query creates no temporary strings for them
+        template<typename T>
+        typename std::enable_if<std::is_arithmetic<T>::value>::type appendValue(std::string &out, T value)
+        {
+            text_format::appendNumber(out, value);
+        }
+
+        inline void appendValue(std::string &out, bool value) { out += value ? "true" : "false"; }
+        inline void appendValue(std::string &out, Tango::DevState value) { appendValue(out, static_cast<int>(value)); }
+        inline void appendValue(std::string &out, const std::string &value) { out += value; }
+
+        // Some scalars can not be written as a bare literal before a cast: postgres reads NaN and
+        // Infinity as column names, and applies the cast before a leading minus, so the smallest
+        // integers overflow. These values must be quoted in a query
+        template<typename T>
+        typename std::enable_if<std::is_floating_point<T>::value, bool>::type needsQuotes(T value)
+        {
+            return std::signbit(value) || !std::isfinite(value);
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type needsQuotes(
+            T value)
+        {
+            return value < 0;
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_floating_point<T>::value &&
+                !(std::is_integral<T>::value && std::is_signed<T>::value),
+            bool>::type
+        needsQuotes(T)
+        {
+            return false;
+        }
+
+        // Append the given data to a query as a string suitable for storing in the database. These
+        // calls are used to build the string version of the insert command, they are required since
+        // we need to specialise for strings (to ensure we do not store escape characters) and bools
+        // (which are in fact a bitfield internally and wont convert in the via the pqxx routines)
+        template<typename T>
+        struct AppendData
+        {
+            static void run(std::string &out, const std::vector<T> &value, const AttributeTraits &traits)
+            {
+                if (traits.isScalar())
+                {
+                    // a local copy removes the bitfield reference a vector<bool> returns
+                    T v = value[0];
+
+                    if (needsQuotes(v))
+                    {
+                        out += '\'';
+                        appendValue(out, v);
+                        out += '\'';
+                        return;
+                    }
+
+                    appendValue(out, v);
+                    return;
+                }
+
+                out += "'{";
+
+                for (auto iter = value.begin(); iter != value.end(); ++iter)
+                {
+                    if (iter != value.begin())
+                        out += ',';
+
+                    T v = *iter;
+                    appendValue(out, v);
+                }
+
+                out += "}'";
+            }
+        };
+
+        // This specialisation for strings uses the ARRAY syntax and dollar quoting to
+        // ensure arrays of strings are stored without escape characters
+        template<>
+        struct AppendData<std::string>
+        {
+            static void run(std::string &out, const std::vector<std::string> &value, const AttributeTraits &traits)
+            {
+                // arrays of strings need both the ARRAY keywords and dollar escaping, this is so we
+                // do not have to rely on the postgres escape functions that double and then store
+                // escaped characters. This is a mess when extracting the array of strings.
+                if (traits.isScalar())
+                {
+                    // use dollars to ensure it saves
+                    out += "$$";
+                    out += value[0];
+                    out += "$$";
+                    return;
+                }
+
+                out += "ARRAY[";
+
+                for (auto iter = value.begin(); iter != value.end(); ++iter)
+                {
+                    if (iter != value.begin())
+                        out += ',';
+
+                    out += "$$";
+                    out += *iter;
+                    out += "$$";
+                }
+
+                out += ']';
+            }
+        };
+
+        // Convert the given data into a string suitable for storing in the database, as
+        // AppendData but returning a new string
         template<typename T>
         struct DataToString
+        {
+            static std::string run(std::unique_ptr<std::vector<T>> &value, const AttributeTraits &traits)
+            {
+                std::string out;
+                AppendData<T>::run(out, *value, traits);
+                return out;
+            }
+        };
+
+        // Append a value field of a data event insert, the data with its cast, or NULL
+        // when there is no data
+        template<typename T>
+        void appendDataField(std::string &out,
+            bool has_data,
+            const std::unique_ptr<std::vector<T>> &value,
+            const AttributeTraits &traits)
+        {
+            if (!has_data || !value || value->empty())
+            {
+                out += "NULL";
+                return;
+            }
+
+            AppendData<T>::run(out, *value, traits);
+            out += "::";
+            out += postgresCast<T>(traits.isArray());
+        }
+
+        // Convert the given data into the postgres text representation of the value, as
+        // required by a COPY stream. Unlike DataToString no quoting or casts are added,
+        // since COPY takes each field as a literal for the column type
+        template<typename T>
+        struct DataToCopyString
         {
             static std::string run(std::unique_ptr<std::vector<T>> &value, const AttributeTraits &traits)
             {
                 if (traits.isScalar())
-                    return pqxx::to_string((*value)[0]);
+                {
+                    std::string result;
+                    appendValue(result, (*value)[0]);
+                    return result;
+                }
 
-                return "'" + pqxx::to_string(value) + "'";
+                return pqxx::to_string(*value);
             }
         };
 
-        // Convert a vector<bool> to a postgres array
+        // Convert a vector<bool> for a COPY stream, see DataToString<bool>
         template<>
-        struct DataToString<bool>
+        struct DataToCopyString<bool>
         {
             static std::string run(std::unique_ptr<std::vector<bool>> &value, const AttributeTraits &traits)
             {
-                // a vector<bool> is not actually a vector<bool>, rather its some kind of bitfield. When
-                // trying to return an element, we appear to get some kind of bitfield reference,
-                // so we return the value to a local variable to remove the reference to the bitfield and
-                // this ensure its actually a bool passed into the conversion framework
                 if (traits.isScalar())
                 {
                     bool v = (*value)[0];
                     return pqxx::to_string(v);
                 }
 
-                // handled by our own extensions in PqxxExtensions.hpp
-                return "'" + pqxx::to_string(value) + "'";
+                return pqxx::to_string(*value);
             }
         };
 
-        // This specialisation for strings uses the ARRAY syntax and dollar quoting to
-        // ensure arrays of strings are stored without escape characters
+        // Strings are taken as is for a scalar, but array elements must be double quoted
+        // and have any quotes or backslashes escaped to form a valid array literal
         template<>
-        struct DataToString<std::string>
+        struct DataToCopyString<std::string>
         {
             static std::string run(std::unique_ptr<std::vector<std::string>> &value, const AttributeTraits &traits)
             {
-                // arrays of strings need both the ARRAY keywords and dollar escaping, this is so we
-                // do not have to rely on the postgres escape functions that double and then store
-                // escaped characters. This is a mess when extracting the array of strings.
                 if (traits.isScalar())
+                    return (*value)[0];
+
+                std::string result = "{";
+
+                for (auto iter = value->begin(); iter != value->end(); ++iter)
                 {
-                    // use dollars to ensure it saves
-                    return "$$" + pqxx::to_string((*value)[0]) + "$$";
-                }
+                    if (iter != value->begin())
+                        result += ",";
 
-                auto iter = value->begin();
-                std::string result = "ARRAY[";
+                    result += "\"";
 
-                result = result + "$$" + pqxx::to_string((*iter)) + "$$";
+                    for (auto c : *iter)
+                    {
+                        if (c == '"' || c == '\\')
+                            result += '\\';
 
-                for (++iter; iter != value->end(); ++iter)
-                {
-                    result += ",";
-                    result += "$$" + pqxx::to_string((*iter)) + "$$";
+                        result += c;
+                    }
+
+                    result += "\"";
                 }
 
-                result += "]";
+                result += "}";
                 return result;
             }
         };
+
+        // Convert the event time, in seconds since the epoch, into a UTC timestamp string
+        // accurate to the microsecond. This is used where TO_TIMESTAMP() can not be, for
+        // example in a COPY stream
+        std::string epochToTimestamp(double event_time);
+
+        // Convert a duration into a postgres interval literal
+        std::string interval(std::chrono::seconds duration);
     }; // namespace query_utils
 
+    // a data event row ready to be written to a COPY stream, the fields match
+    // the columns given by QueryBuilder::storeDataEventCopyColumns()
+    using CopyRow = std::tuple<int, std::string, CopyField, CopyField, int>;
+
+    // A continuous aggregate kept of each numeric scalar data table, holding the minimum,
+    // maximum, average and count of the read values of each attribute per bucket. It is
+    // named after its data table with the suffix appended
+    struct Rollup
+    {
+        std::string suffix;
+        std::chrono::seconds bucket;
+
+        // the refresh policy, every schedule the buckets between start_offset and
+        // end_offset ago are brought up to date
+        std::chrono::seconds start_offset;
+        std::chrono::seconds end_offset;
+        std::chrono::seconds schedule;
+    };
+
     // these are used as transactions names for pqxx, some are used to as prepared
     // statement names, where the name required are simple. Anything that has to
     // generate a name uses an entry in QueryBuilder
@@ -140,9 +321,22 @@ namespace pqxx_conn
     const string StoreParameterEvent = "StoreParameterEvent";
     const string StoreDataEvent = "StoreDataEvent";
     const string StoreDataEventError = "StoreDataEventError";
+    const string StoreDataEventPacked = "StoreDataEventPacked";
+    const string StoreDataEventBatch = "StoreDataEventBatch";
+    const string StoreDataEventCopy = "StoreDataEventCopy";
+    const string FetchDomainOids = "FetchDomainOids";
     const string StoreErrorString = "StoreErrorString";
     const string FetchLastHistoryEvent = "FetchLastHistoryEvent";
     const string FetchAttributeTraits = "FetchAttributeTraits";
+    const string FetchDataEvents = "FetchDataEvents";
+    const string StoreAttributeTtl = "StoreAttributeTtl";
+    const string FetchDataTables = "FetchDataTables";
+    const string FetchPackedTables = "FetchPackedTables";
+    const string MaintainDataTable = "MaintainDataTable";
+    const string ApplyRetention = "ApplyRetention";
+    const string CreateRollup = "CreateRollup";
+    const string FillRollup = "FillRollup";
+    const string FetchRollup = "FetchRollup";
     const string FetchValue = "FetchKey";
     const string FetchAllValues = "FetchAllKeys";
 
@@ -163,12 +357,112 @@ namespace pqxx_conn
         static const std::string &storeErrorStatement();
         static const std::string &fetchLastHistoryEventStatement();
         static const std::string &fetchAttributeTraitsStatement();
+        static const std::string &fetchDomainOidsStatement();
 
         static const std::string fetchValueStatement(
             const std::string &column_name, const std::string &table_name, const std::string &reference);
 
-        static const std::string fetchAllValuesStatement(
-            const std::string &column_name, const std::string &table_name, const std::string &reference);
+        // Builds the query for the data events of an attribute from start_time up to, but
+        // not including, end_time, oldest first. The event time is returned in seconds
+        // since the epoch, followed by the read value, write value and quality, and when
+        // packed is set the packed read and write values. The values are in the query
+        // rather than parameters, so it can be declared as a cursor
+        static std::string fetchDataEventsStatement(
+            const AttributeTraits &traits, int conf_id, double start_time, double end_time, bool packed = false);
+
+        // Updates the time to live of an attribute, the row is only written when the
+        // time to live changes
+        static const std::string &storeAttributeTtlStatement();
+
+        // Table maintenance statements, these are run once at startup so the table names
+        // and values are in the query rather than parameters
+
+        // Lists the data hypertables, and whether each has compression enabled
+        static const std::string &fetchDataTablesStatement();
+
+        // Lists the data tables with the packed value columns added by db-schema/packed.sql
+        static const std::string &fetchPackedTablesStatement();
+
+        // The rate, in bytes per second, the uncompressed chunks of a data table have grown
+        // over the last 30 days. Null when it has no such chunks
+        static std::string fetchIngestRateStatement(const std::string &table_name);
+
+        // Sets the time interval of the chunks created from now on for a data table
+        static std::string setChunkIntervalStatement(const std::string &table_name, std::chrono::seconds interval);
+
+        // Enables compression of a data table, segmented by attribute so each attribute's
+        // events are compressed together in time order
+        static std::string enableCompressionStatement(const std::string &table_name);
+
+        // Replace any compression policy of a data table with one compressing chunks once
+        // they are older than compress_after
+        static std::string removeCompressionPolicyStatement(const std::string &table_name);
+        static std::string addCompressionPolicyStatement(
+            const std::string &table_name, std::chrono::hours compress_after);
+
+        // Lists the id, table and time to live of every attribute with a time to live
+        static const std::string &fetchAttributeTtlsStatement();
+
+        // Lists each data table with the smallest and largest time to live of its
+        // attributes, a smallest of 0 means an attribute keeps its events forever
+        static const std::string &fetchTableTtlsStatement();
+
+        // Drops the chunks of a data table holding only events older than ttl hours
+        static std::string dropExpiredChunksStatement(const std::string &table_name, int ttl);
+
+        // Lists each data table with compressed chunks, and the end of the newest of them
+        // in seconds since the epoch
+        static const std::string &fetchCompressedEndsStatement();
+
+        // Deletes the events of an attribute older than its time to live. When
+        // uncompressed_from is not 0, only events from that time on, in seconds since the
+        // epoch, are deleted, so compressed chunks before it are left alone
+        static std::string deleteExpiredEventsStatement(
+            const std::string &table_name, int conf_id, int ttl, std::int64_t uncompressed_from = 0);
+
+        // Rollup statements, see Rollup
+
+        // The rollups kept of each numeric scalar data table, finest first
+        static const std::vector<Rollup> &rollups();
+
+        // true when the attribute is stored in a table with rollups
+        static bool hasRollups(const AttributeTraits &traits) noexcept;
+
+        // The coarsest rollup whose bucket evenly divides resolution, so its buckets can be
+        // combined into buckets of the resolution exactly. Null when there is none
+        static const Rollup *selectRollup(std::chrono::seconds resolution) noexcept;
+
+        static std::string rollupName(const AttributeTraits &traits, const Rollup &rollup);
+
+        // Creates the rollup of the data table of traits, when it does not exist. It is
+        // created empty, since materializing the events already stored may take a long
+        // time, see refreshRollupStatement(). It can not be run in a transaction
+        static std::string createRollupStatement(const AttributeTraits &traits, const Rollup &rollup);
+        static std::string addRollupPolicyStatement(const AttributeTraits &traits, const Rollup &rollup);
+
+        // Lists the names of the continuous aggregates that exist
+        static const std::string &fetchRollupNamesStatement();
+
+        // The time of the first event of a data table in seconds since the epoch, NULL
+        // when the table is empty
+        static std::string fetchFirstEventStatement(const std::string &table_name);
+
+        // Materializes the buckets of the rollup from start up to end, in seconds since the
+        // epoch. It can not be run in a transaction
+        static std::string refreshRollupStatement(
+            const AttributeTraits &traits, const Rollup &rollup, std::int64_t start, std::int64_t end);
+
+        // Builds the query for the read values of an attribute from start_time up to, but
+        // not including, end_time, aggregated into buckets of resolution, oldest first.
+        // Each row is the bucket start in seconds since the epoch, then the minimum, maximum,
+        // average and count of the values. Buckets without a value are left out. The values
+        // are read from rollup, or the data table when it is null
+        static std::string fetchRollupStatement(const AttributeTraits &traits,
+            const Rollup *rollup,
+            int conf_id,
+            double start_time,
+            double end_time,
+            std::chrono::seconds resolution);
 
         // Non-static prepared statements
         // these builder functions cache the built queries, therefore they
@@ -176,20 +470,68 @@ namespace pqxx_conn
 
         const std::string &storeDataEventName(const AttributeTraits &traits);
         const std::string &storeDataEventErrorName(const AttributeTraits &traits);
+        const std::string &storeDataEventPackedName(const AttributeTraits &traits);
 
         // Builds a prepared statement for the given traits, the statement is cached
         // internally to improve execution time
         template<typename T>
         const std::string &storeDataEventStatement(const AttributeTraits &traits);
 
-        // A variant of storeDataEventStatement that builds a string based on the
-        // parameters, this is then passed back to the caller to be executed. No
-        // internal caching, so its less efficient, but can be chained in a pipe
-        // to batch data to the database.
+        // A variant of storeDataEventStatement that appends a complete insert statement,
+        // with the values in place of the parameters, to the given query. The query is
+        // normally a buffer reused between events, so once it has grown to the size of
+        // the largest event, building the statement does not allocate.
+        template<typename T>
+        void storeDataEventString(std::string &query,
+            int conf_id,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // Builds the leading part of a multi-row insert into the given data table, the
+        // caller appends one or more comma separated rows from storeDataEventValuesString()
+        static std::string storeDataEventBatchStatement(const std::string &table_name);
+
+        // Ends a data event insert so events already in the table are skipped rather than
+        // failing the statement, as happens when a batch is stored a second time
+        static const std::string &storeDataEventSkipStored();
+
+        // Appends a single row of values for a multi-row insert. Unlike storeDataEventString()
+        // both value columns are always present (NULL when there is no data), so rows for
+        // attributes of differing write types can be batched into the same table insert.
+        template<typename T>
+        void storeDataEventValuesString(std::string &row,
+            int conf_id,
+            double event_time,
+            int quality,
+            std::unique_ptr<vector<T>> &value_r,
+            std::unique_ptr<vector<T>> &value_w,
+            const AttributeTraits &traits);
+
+        // The data table columns written by a data event COPY stream, in CopyRow order
+        static const std::vector<std::string> &storeDataEventCopyColumns();
+
+        // Builds the COPY FROM STDIN statement for the copy columns of the given table,
+        // in either the text or binary format
+        static std::string storeDataEventCopyStatement(const std::string &table_name, bool binary);
+
+        // A COPY can not skip events already stored, so data events are copied into a
+        // temporary staging table with the columns of the data table, and moved from it
+        // into the data table with an insert that skips them. The staging table is
+        // emptied as each transaction commits.
+        static std::string storeDataEventStagingTable(const std::string &table_name);
+        static std::string createStagingTableStatement(const std::string &table_name);
+        static std::string storeStagedDataEventsStatement(const std::string &table_name);
+
+        // Builds a row for a COPY stream into the data table for the given traits. As
+        // with storeDataEventValuesString() both value fields are always present, and
+        // are null when there is no data.
         template<typename T>
-        const std::string storeDataEventString(const std::string &full_attr_name,
-            const std::string &event_time,
-            const std::string &quality,
+        CopyRow storeDataEventCopyRow(int conf_id,
+            double event_time,
+            int quality,
             std::unique_ptr<vector<T>> &value_r,
             std::unique_ptr<vector<T>> &value_w,
             const AttributeTraits &traits);
@@ -197,10 +539,21 @@ namespace pqxx_conn
         // Builds a prepared statement for data event errors
         const std::string &storeDataEventErrorStatement(const AttributeTraits &traits);
 
+        // Builds a prepared statement for data events with packed array values, the values
+        // are bound as bytea to the packed value columns
+        const std::string &storeDataEventPackedStatement(const AttributeTraits &traits);
+
+        // Every prepared statement built so far, mapped from its name to its
+        // statement, so they can be prepared again on a new connection
+        std::map<std::string, std::string> preparedStatements() const;
+
         // Utility
         void print(std::ostream &os) const noexcept;
 
     private:
+        // the statement storeDataEventString() builds up to the first value, cached per traits
+        const std::string &storeDataEventStringPrefix(const AttributeTraits &traits);
+
         // generic function to handle caching items into the cache maps
         const string &handleCache(
             std::map<AttributeTraits, std::string> &cache, const AttributeTraits &traits, const std::string &stub);
@@ -208,10 +561,13 @@ namespace pqxx_conn
         // cached query names, these are built from the traits object
         std::map<AttributeTraits, std::string> _data_event_query_names;
         std::map<AttributeTraits, std::string> _data_event_error_query_names;
+        std::map<AttributeTraits, std::string> _data_event_packed_query_names;
 
         // cached insert query strings built from the traits object
         std::map<AttributeTraits, std::string> _data_event_queries;
         std::map<AttributeTraits, std::string> _data_event_error_queries;
+        std::map<AttributeTraits, std::string> _data_event_packed_queries;
+        std::map<AttributeTraits, std::string> _data_event_string_prefixes;
     };
 
     //=============================================================================
@@ -267,59 +623,87 @@ namespace pqxx_conn
         return result->second;
     }
 
+    //=============================================================================
+    //=============================================================================
     template<typename T>
-    const std::string QueryBuilder::storeDataEventString(const std::string &full_attr_name,
-        const std::string &event_time,
-        const std::string &quality,
+    void QueryBuilder::storeDataEventString(std::string &query,
+        int conf_id,
+        double event_time,
+        int quality,
         std::unique_ptr<vector<T>> &value_r,
         std::unique_ptr<vector<T>> &value_w,
         const AttributeTraits &traits)
     {
-        auto query = "INSERT INTO " + QueryBuilder::tableName(traits) + " (" + schema::DatColId + "," +
-            schema::DatColDataTime;
-
-        if (traits.hasReadData())
-            query = query + "," + schema::DatColValueR;
-
-        if (traits.hasWriteData())
-            query = query + "," + schema::DatColValueW;
-
-        // split to ensure increments are in the correct order
-        query = query + "," + schema::DatColQuality + ") VALUES ('" + full_attr_name + "'";
-        query = query + ",TO_TIMESTAMP(" + event_time + ")";
+        query += storeDataEventStringPrefix(traits);
+        query_utils::appendValue(query, conf_id);
+        query += ",TO_TIMESTAMP(";
+        query_utils::appendValue(query, event_time);
+        query += ')';
 
-        // add the read parameter with cast
+        // the value columns are only present for the data the traits have
         if (traits.hasReadData())
         {
-            if (value_r->empty())
-            {
-                query = query + ",NULL";
-            }
-            else
-            {
-                query = query + "," + query_utils::DataToString<T>::run(value_r, traits) +
-                    "::" + query_utils::postgresCast<T>(traits.isArray());
-            }
+            query += ',';
+            query_utils::appendDataField(query, true, value_r, traits);
         }
 
-        // add the write parameter with cast
         if (traits.hasWriteData())
         {
-            if (value_w->empty())
-            {
-                query = query + ",NULL";
-            }
-            else
-            {
-                query = query + "," + query_utils::DataToString<T>::run(value_w, traits) +
-                    "::" + query_utils::postgresCast<T>(traits.isArray());
-            }
+            query += ',';
+            query_utils::appendDataField(query, true, value_w, traits);
         }
 
-        query = query + "," + quality + ")";
+        query += ',';
+        query_utils::appendValue(query, quality);
+        query += ')';
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    void QueryBuilder::storeDataEventValuesString(std::string &row,
+        int conf_id,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        row += '(';
+        query_utils::appendValue(row, conf_id);
+        row += ",TO_TIMESTAMP(";
+        query_utils::appendValue(row, event_time);
+        row += "),";
+        query_utils::appendDataField(row, traits.hasReadData(), value_r, traits);
+        row += ',';
+        query_utils::appendDataField(row, traits.hasWriteData(), value_w, traits);
+        row += ',';
+        query_utils::appendValue(row, quality);
+        row += ')';
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    CopyRow QueryBuilder::storeDataEventCopyRow(int conf_id,
+        double event_time,
+        int quality,
+        std::unique_ptr<vector<T>> &value_r,
+        std::unique_ptr<vector<T>> &value_w,
+        const AttributeTraits &traits)
+    {
+        auto value_field = [&traits](auto has_data, auto &value) {
+            if (!has_data || !value || value->empty())
+                return CopyField();
+
+            return CopyField(query_utils::DataToCopyString<T>::run(value, traits));
+        };
 
-        // now return the built query
-        return query;
+        return CopyRow {conf_id,
+            query_utils::epochToTimestamp(event_time),
+            value_field(traits.hasReadData(), value_r),
+            value_field(traits.hasWriteData(), value_w),
+            quality};
     }
 
 } // namespace pqxx_conn
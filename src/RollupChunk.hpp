@@ -0,0 +1,61 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _ROLLUP_CHUNK_HPP
+#define _ROLLUP_CHUNK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// A RollupChunk holds a run of aggregated read values of a single numeric scalar
+// attribute, in columns rather than rows. Row i of the chunk is the bucket starting at
+// element i of bucket. Buckets are ordered by time, and only those holding at least one
+// value are returned.
+struct RollupChunk
+{
+    // number of buckets in the chunk
+    std::size_t size() const noexcept { return bucket.size(); }
+    bool empty() const noexcept { return bucket.empty(); }
+
+    // empty every column, keeping their allocations for the next chunk
+    void clear() noexcept
+    {
+        bucket.clear();
+        min.clear();
+        max.clear();
+        avg.clear();
+        count.clear();
+    }
+
+    // bucket start times, in seconds since the epoch
+    std::vector<double> bucket;
+
+    // the values in each bucket, converted to double whatever the attribute's type
+    std::vector<double> min;
+    std::vector<double> max;
+    std::vector<double> avg;
+
+    // number of values in each bucket, events without a value are not counted
+    std::vector<int64_t> count;
+};
+} // namespace hdbpp_internal
+#endif // _ROLLUP_CHUNK_HPP
@@ -0,0 +1,178 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _STATEMENT_TABLE_HPP
+#define _STATEMENT_TABLE_HPP
+
+#include "AttributeTraits.hpp"
+#include "QueryBuilder.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // A data event prepared statement ready for use, and whether it has been
+    // registered on each connection it may be used with
+    struct StatementHandle
+    {
+        std::string name;
+        std::string statement;
+
+        // registered with the pqxx connection
+        bool registered = false;
+
+        // prepared on the native connection in pipeline mode
+        bool pipelined = false;
+    };
+
+    // The StatementTable holds a handle for the data event prepared statement of every
+    // supported combination of attribute traits. The table is dense and indexed directly
+    // by the traits enum values, so once built, finding the statement for an event is
+    // a single array access, with no string building or map lookups.
+    class StatementTable
+    {
+    public:
+        // build the handles for all supported traits, statements are taken from (and
+        // so cached in) the query builder
+        void build(QueryBuilder &query_builder);
+
+        bool empty() const noexcept { return _handles.empty(); }
+
+        // the traits must be one of the supported types, with a known format and write type
+        StatementHandle &handle(const AttributeTraits &traits) noexcept
+        {
+            assert(supported(traits));
+            return _handles[index(traits)];
+        }
+
+        bool supported(const AttributeTraits &traits) const noexcept
+        {
+            return index(traits) < _handles.size() && !_handles[index(traits)].name.empty();
+        }
+
+        // mark every statement as unregistered, used when the connections are replaced
+        void resetRegistration() noexcept;
+
+        // find the handle by statement name, this is a linear search for use on error paths
+        StatementHandle *find(const std::string &name) noexcept;
+
+        void print(std::ostream &os) const noexcept;
+
+    private:
+        // the Tango enums are small and contiguous, so each is a dimension of the table,
+        // anything outside the bounds maps past the end of the table
+        static const std::size_t TypeCount = 32;
+        static const std::size_t FormatCount = 3;
+        static const std::size_t WriteCount = 4;
+
+        static std::size_t index(const AttributeTraits &traits) noexcept
+        {
+            auto type = static_cast<std::size_t>(traits.type());
+            auto format = static_cast<std::size_t>(traits.formatType());
+            auto write = static_cast<std::size_t>(traits.writeType());
+
+            if (type >= TypeCount || format >= FormatCount || write >= WriteCount)
+                return TypeCount * FormatCount * WriteCount;
+
+            return (type * FormatCount + format) * WriteCount + write;
+        }
+
+        std::vector<StatementHandle> _handles;
+    };
+
+    //=============================================================================
+    //=============================================================================
+    inline void StatementTable::build(QueryBuilder &query_builder)
+    {
+        _handles.assign(TypeCount * FormatCount * WriteCount, StatementHandle {});
+
+        // the type is only used to select the template that builds the statement
+        auto build_type = [this, &query_builder](auto type, Tango::CmdArgType tango_type) {
+            using T = decltype(type);
+
+            for (auto format : {Tango::SCALAR, Tango::SPECTRUM, Tango::IMAGE})
+            {
+                for (auto write : {Tango::READ, Tango::WRITE, Tango::READ_WRITE, Tango::READ_WITH_WRITE})
+                {
+                    AttributeTraits traits {write, format, tango_type};
+                    auto &handle = _handles[index(traits)];
+
+                    handle.name = query_builder.storeDataEventName(traits);
+                    handle.statement = query_builder.storeDataEventStatement<T>(traits);
+                }
+            }
+        };
+
+        build_type(bool {}, Tango::DEV_BOOLEAN);
+        build_type(int16_t {}, Tango::DEV_SHORT);
+        build_type(int32_t {}, Tango::DEV_LONG);
+        build_type(int64_t {}, Tango::DEV_LONG64);
+        build_type(float {}, Tango::DEV_FLOAT);
+        build_type(double {}, Tango::DEV_DOUBLE);
+        build_type(uint8_t {}, Tango::DEV_UCHAR);
+        build_type(uint16_t {}, Tango::DEV_USHORT);
+        build_type(uint32_t {}, Tango::DEV_ULONG);
+        build_type(uint64_t {}, Tango::DEV_ULONG64);
+        build_type(std::string {}, Tango::DEV_STRING);
+        build_type(Tango::DevState {}, Tango::DEV_STATE);
+    }
+
+    //=============================================================================
+    //=============================================================================
+    inline void StatementTable::resetRegistration() noexcept
+    {
+        for (auto &handle : _handles)
+        {
+            handle.registered = false;
+            handle.pipelined = false;
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    inline StatementHandle *StatementTable::find(const std::string &name) noexcept
+    {
+        for (auto &handle : _handles)
+            if (handle.name == name)
+                return &handle;
+
+        return nullptr;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    inline void StatementTable::print(std::ostream &os) const noexcept
+    {
+        std::size_t statements = 0;
+
+        for (const auto &handle : _handles)
+            if (!handle.name.empty())
+                statements++;
+
+        os << "StatementTable(_handles: " << _handles.size() << ", statements: " << statements << ")";
+    }
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _STATEMENT_TABLE_HPP
@@ -0,0 +1,125 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _TEXT_FORMAT_HPP
+#define _TEXT_FORMAT_HPP
+
+#include "spdlog/fmt/fmt.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace hdbpp_internal
+{
+namespace pqxx_conn
+{
+    // This namespace formats numbers as the postgres text representation, appending
+    // straight into a caller's buffer. Floating point values are written with the
+    // fewest digits that read back to the identical value, so nothing is lost, and
+    // non finite values use the names postgres accepts. Formatting never depends on
+    // the locale.
+    namespace text_format
+    {
+        // the most characters a single value of the type can be formatted to, for
+        // sizing a buffer ahead of formatting an array
+        template<typename T>
+        struct MaxChars
+        {
+            // sign, digits, point and exponent for floating point, sign and digits otherwise
+            static const std::size_t value = std::is_floating_point<T>::value ?
+                std::numeric_limits<T>::max_digits10 + 8 :
+                std::numeric_limits<T>::digits10 + 3;
+        };
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value>::type appendNumber(std::string &out, T value)
+        {
+            auto text = fmt::format_int(value);
+            out.append(text.data(), text.size());
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type appendNumber(std::string &out, T value)
+        {
+            if (std::isnan(value))
+            {
+                out += "NaN";
+                return;
+            }
+
+            if (std::isinf(value))
+            {
+                out += value < 0 ? "-Infinity" : "Infinity";
+                return;
+            }
+
+#if FMT_VERSION >= 60000
+            // fmt formats the shortest representation that round trips by default
+            fmt::format_to(std::back_inserter(out), "{}", value);
+#else
+            // older fmt versions format via printf, so find the shortest of the two
+            // candidate precisions that round trips, then undo any locale decimal point
+            char buffer[MaxChars<T>::value + 1];
+
+            auto length = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::digits10, value);
+
+            if (static_cast<T>(std::strtod(buffer, nullptr)) != value)
+                length = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::max_digits10, value);
+
+            for (auto i = 0; i < length; i++)
+                if (buffer[i] == ',')
+                    buffer[i] = '.';
+
+            out.append(buffer, length);
+#endif
+        }
+
+        //=============================================================================
+        //=============================================================================
+        template<typename T>
+        void appendArray(std::string &out, const std::vector<T> &values)
+        {
+            // size the buffer once for the worst case so the elements never reallocate it
+            out.reserve(out.size() + 2 + values.size() * (MaxChars<T>::value + 1));
+            out += '{';
+
+            for (auto iter = values.begin(); iter != values.end(); ++iter)
+            {
+                if (iter != values.begin())
+                    out += ',';
+
+                appendNumber(out, *iter);
+            }
+
+            out += '}';
+        }
+    } // namespace text_format
+} // namespace pqxx_conn
+} // namespace hdbpp_internal
+#endif // _TEXT_FORMAT_HPP
@@ -50,6 +50,12 @@ namespace pqxx_conn
         const std::string TypeDevEncoded = "devencoded";
         const std::string TypeDevEnum = "devenum";
 
+        // domains used to store the unsigned types
+        const std::string DomainUchar = "uchar";
+        const std::string DomainUshort = "ushort";
+        const std::string DomainUlong = "ulong";
+        const std::string DomainUlong64 = "ulong64";
+
         // att_conf table
         const std::string ConfTableName = "att_conf";
         const std::string ConfColId = "att_conf_id";
@@ -126,6 +132,17 @@ namespace pqxx_conn
         const std::string DatColErrorDescId = "att_error_desc_id";
         const std::string DatColDetails = "details";
 
+        // optional fields for packed array values, see db-schema/packed.sql
+        const std::string DatColValueRPacked = "value_r_packed";
+        const std::string DatColValueWPacked = "value_w_packed";
+
+        // continuous aggregates of the numeric scalar data tables, see db-schema/rollup.sql
+        const std::string RollupColBucket = "bucket";
+        const std::string RollupColMin = "value_r_min";
+        const std::string RollupColMax = "value_r_max";
+        const std::string RollupColAvg = "value_r_avg";
+        const std::string RollupColCount = "value_r_count";
+
         // special fields for enums
         const std::string DatColDatColValueRLabel = "value_r_label";
         const std::string DatColDatColValueWLabel = "value_w_label";
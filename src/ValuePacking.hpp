@@ -0,0 +1,400 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _VALUE_PACKING_HPP
+#define _VALUE_PACKING_HPP
+
+#include "AttributeTraits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// This namespace packs the values of a numeric array into a compact, lossless blob for
+// a bytea column. Neighbouring elements of a waveform are usually close, so floating
+// point arrays are XOR encoded, as in Facebook's Gorilla, where an element identical to
+// the one before takes a single bit and a small change only its differing bits.
+// Integer arrays are delta of delta encoded, so an element on the same slope as the two
+// before it takes a single byte.
+//
+// A blob is a codec byte, the element count as a varint, then the encoded elements.
+// The decoder checks every read against the size of the blob, so a corrupt blob is
+// reported rather than read past.
+namespace value_packing
+{
+    // the codec byte at the start of every blob
+    const uint8_t CodecXor = 1;
+    const uint8_t CodecDeltaOfDelta = 2;
+
+    // numbers other than bool can be packed
+    template<typename T>
+    struct Packable : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>
+    {};
+
+    // true when the values of an attribute with the given traits are stored packed,
+    // only arrays are packed since a scalar gains nothing
+    template<typename T>
+    bool packable(const AttributeTraits &traits) noexcept
+    {
+        return Packable<T>::value && !traits.isScalar();
+    }
+
+    // Writes bits into a string, most significant first
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::string &out) : _out(out) {}
+
+        // write the count least significant bits of value
+        void write(uint64_t value, unsigned count)
+        {
+            while (count > 0)
+            {
+                if (_free == 0)
+                {
+                    _out.push_back(0);
+                    _free = 8;
+                }
+
+                auto bits = count < _free ? count : _free;
+                auto chunk = static_cast<uint8_t>((value >> (count - bits)) & ((1u << bits) - 1));
+
+                _out.back() = static_cast<char>(static_cast<uint8_t>(_out.back()) | (chunk << (_free - bits)));
+                _free -= bits;
+                count -= bits;
+            }
+        }
+
+    private:
+        std::string &_out;
+        unsigned _free = 0;
+    };
+
+    // Reads the bits written by a BitWriter, every read fails once the data is exhausted
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, std::size_t size) : _data(data), _bits(size * 8) {}
+
+        bool read(unsigned count, uint64_t &value)
+        {
+            if (_bits - _position < count)
+                return false;
+
+            value = 0;
+
+            while (count > 0)
+            {
+                auto offset = _position % 8;
+                auto bits = count < 8 - offset ? count : 8 - offset;
+                auto chunk = (_data[_position / 8] >> (8 - offset - bits)) & ((1u << bits) - 1);
+
+                value = (value << bits) | chunk;
+                _position += bits;
+                count -= bits;
+            }
+
+            return true;
+        }
+
+    private:
+        const uint8_t *_data;
+        std::size_t _bits;
+        std::size_t _position = 0;
+    };
+
+    //=============================================================================
+    //=============================================================================
+    inline void appendVarint(std::string &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<char>(value));
+    }
+
+    //=============================================================================
+    //=============================================================================
+    inline bool readVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value)
+    {
+        value = 0;
+
+        for (unsigned shift = 0; shift < 64 && data != end; shift += 7)
+        {
+            auto byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    // map signed values to unsigned, so small magnitudes of either sign are short varints
+    inline uint64_t zigzag(uint64_t value) noexcept
+    {
+        return (value << 1) ^ static_cast<uint64_t>(-static_cast<int64_t>(value >> 63));
+    }
+
+    inline uint64_t unzigzag(uint64_t value) noexcept { return (value >> 1) ^ (0 - (value & 1)); }
+
+    // the bits of a floating point value as an unsigned integer of the same width
+    template<typename T>
+    using FloatBits = typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type;
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type encode(
+        const std::vector<T> &values, std::string &out)
+    {
+        using Bits = FloatBits<T>;
+        const unsigned width = sizeof(Bits) * 8;
+
+        out.clear();
+        out.push_back(static_cast<char>(CodecXor));
+        appendVarint(out, values.size());
+
+        BitWriter writer {out};
+
+        Bits previous = 0;
+        unsigned previous_leading = width + 1;
+        unsigned previous_trailing = 0;
+
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            Bits bits;
+            std::memcpy(&bits, &values[i], sizeof(Bits));
+
+            if (i == 0)
+            {
+                writer.write(bits, width);
+                previous = bits;
+                continue;
+            }
+
+            Bits change = bits ^ previous;
+            previous = bits;
+
+            if (change == 0)
+            {
+                writer.write(0, 1);
+                continue;
+            }
+
+            writer.write(1, 1);
+
+            // the leading zero count is limited to fit its 5 bit field
+            auto leading = static_cast<unsigned>(__builtin_clzll(change)) - (64 - width);
+            auto trailing = static_cast<unsigned>(__builtin_ctzll(change));
+
+            if (leading > 31)
+                leading = 31;
+
+            if (previous_leading <= width && leading >= previous_leading && trailing >= previous_trailing)
+            {
+                // the changed bits fit within those of the previous change
+                writer.write(0, 1);
+                writer.write(change >> previous_trailing, width - previous_leading - previous_trailing);
+            }
+            else
+            {
+                auto significant = width - leading - trailing;
+
+                // a width of 64 does not fit the 6 bit field, and is written as 0
+                writer.write(1, 1);
+                writer.write(leading, 5);
+                writer.write(significant & 0x3f, 6);
+                writer.write(change >> trailing, significant);
+
+                previous_leading = leading;
+                previous_trailing = trailing;
+            }
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && Packable<T>::value>::type encode(
+        const std::vector<T> &values, std::string &out)
+    {
+        out.clear();
+        out.push_back(static_cast<char>(CodecDeltaOfDelta));
+        appendVarint(out, values.size());
+
+        // the arithmetic wraps in 64 bits, so is lossless for every type including uint64_t,
+        // signed values are sign extended so small negative deltas stay small
+        uint64_t previous = 0;
+        uint64_t previous_delta = 0;
+
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            auto value = std::is_signed<T>::value ? static_cast<uint64_t>(static_cast<int64_t>(values[i])) :
+                                                    static_cast<uint64_t>(values[i]);
+
+            auto delta = value - previous;
+            appendVarint(out, zigzag(i == 0 ? value : delta - previous_delta));
+
+            previous_delta = i == 0 ? 0 : delta;
+            previous = value;
+        }
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type decode(
+        const uint8_t *data, std::size_t size, std::vector<T> &values)
+    {
+        using Bits = FloatBits<T>;
+        const unsigned width = sizeof(Bits) * 8;
+
+        auto end = data + size;
+        uint64_t count = 0;
+
+        values.clear();
+
+        if (size == 0 || *data++ != CodecXor || !readVarint(data, end, count))
+            return false;
+
+        // every element takes at least a bit, so a count larger than that is corrupt
+        if (count > static_cast<uint64_t>(end - data) * 8)
+            return false;
+
+        values.reserve(count);
+
+        BitReader reader {data, static_cast<std::size_t>(end - data)};
+
+        uint64_t bits = 0;
+        unsigned leading = 0;
+        unsigned significant = 0;
+
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t flag = 0;
+
+            if (i == 0)
+            {
+                if (!reader.read(width, bits))
+                    return false;
+            }
+            else
+            {
+                if (!reader.read(1, flag))
+                    return false;
+
+                if (flag == 1)
+                {
+                    if (!reader.read(1, flag))
+                        return false;
+
+                    if (flag == 1)
+                    {
+                        uint64_t field = 0;
+
+                        if (!reader.read(5, field))
+                            return false;
+
+                        leading = static_cast<unsigned>(field);
+
+                        if (!reader.read(6, field))
+                            return false;
+
+                        significant = field == 0 ? 64 : static_cast<unsigned>(field);
+
+                        if (leading + significant > width)
+                            return false;
+                    }
+                    else if (significant == 0)
+                    {
+                        // the previous window is used before there is one
+                        return false;
+                    }
+
+                    uint64_t change = 0;
+
+                    if (!reader.read(significant, change))
+                        return false;
+
+                    bits ^= change << (width - leading - significant);
+                }
+            }
+
+            auto value_bits = static_cast<Bits>(bits);
+            T value;
+            std::memcpy(&value, &value_bits, sizeof(T));
+            values.push_back(value);
+        }
+
+        return true;
+    }
+
+    //=============================================================================
+    //=============================================================================
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && Packable<T>::value, bool>::type decode(
+        const uint8_t *data, std::size_t size, std::vector<T> &values)
+    {
+        auto end = data + size;
+        uint64_t count = 0;
+
+        values.clear();
+
+        if (size == 0 || *data++ != CodecDeltaOfDelta || !readVarint(data, end, count))
+            return false;
+
+        // every element takes at least a byte
+        if (count > static_cast<uint64_t>(end - data))
+            return false;
+
+        values.reserve(count);
+
+        uint64_t previous = 0;
+        uint64_t previous_delta = 0;
+
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t encoded = 0;
+
+            if (!readVarint(data, end, encoded))
+                return false;
+
+            auto value = i == 0 ? unzigzag(encoded) : previous + previous_delta + unzigzag(encoded);
+
+            previous_delta = i == 0 ? 0 : value - previous;
+            previous = value;
+
+            values.push_back(static_cast<T>(value));
+        }
+
+        return data == end;
+    }
+} // namespace value_packing
+} // namespace hdbpp_internal
+#endif // _VALUE_PACKING_HPP
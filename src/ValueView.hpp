@@ -0,0 +1,65 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _VALUE_VIEW_HPP
+#define _VALUE_VIEW_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace hdbpp_internal
+{
+// A ValueView refers to event values held elsewhere, typically the sequence a
+// Tango::DeviceAttribute was decoded into, so they can be encoded for the database
+// without first being copied into a vector. The view does not own the values, and
+// must not outlive them. An empty view means there is no data, as with an empty vector.
+template<typename T>
+class ValueView
+{
+public:
+    ValueView() = default;
+    ValueView(const T *data, std::size_t size) : _data(data), _size(size) {}
+
+    const T *data() const noexcept { return _data; }
+    std::size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+
+    const T *begin() const noexcept { return _data; }
+    const T *end() const noexcept { return _data + _size; }
+
+    const T &operator[](std::size_t index) const noexcept
+    {
+        assert(index < _size);
+        return _data[index];
+    }
+
+private:
+    const T *_data = nullptr;
+    std::size_t _size = 0;
+};
+
+// Connections that can store data events directly from a ValueView specialise this
+// to std::true_type, and provide a storeDataEventView() alongside storeDataEvent().
+// The HdbppTxDataEvent uses it to choose how the values are extracted.
+template<typename Conn>
+struct StoresValueViews : std::false_type
+{};
+} // namespace hdbpp_internal
+#endif // _VALUE_VIEW_HPP
@@ -0,0 +1,396 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _WRITE_BEHIND_QUEUE_HPP
+#define _WRITE_BEHIND_QUEUE_HPP
+
+#include "LibUtils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace hdbpp_internal
+{
+// The WriteBehindQueue takes ownership of a connection and hands it to a dedicated
+// writer thread. Callers submit tasks, which are run against the connection in the
+// order they were queued, so the caller no longer waits on the database. The queue is
+// bounded, and when it is full the overflow policy decides whether the caller waits
+// for space, the oldest queued task is discarded, or the oldest queued task is spilled
+// via a fallback supplied with it.
+//
+// Tasks submitted asynchronously can not report errors back to the caller, they are
+// logged and counted. Tasks run via execute() wait for the result and rethrow any
+// error on the calling thread, and are never dropped or spilled.
+template<typename Conn>
+class WriteBehindQueue
+{
+public:
+    using Task = std::function<void(Conn &)>;
+
+    // alternative to running the task, used by the spill policy when the queue is full
+    using SpillTask = std::function<void()>;
+
+    enum class OverflowPolicy
+    {
+        Block,
+        DropOldest,
+        Spill
+    };
+
+    // the idle task, if given, is run on the writer thread once every idle interval,
+    // between tasks when the queue is busy
+    WriteBehindQueue(std::unique_ptr<Conn> conn,
+        std::size_t capacity,
+        OverflowPolicy policy,
+        Task idle_task = nullptr,
+        std::chrono::milliseconds idle_interval = std::chrono::milliseconds(1000));
+
+    ~WriteBehindQueue();
+
+    WriteBehindQueue(const WriteBehindQueue &) = delete;
+    WriteBehindQueue &operator=(const WriteBehindQueue &) = delete;
+
+    // queue the task and return immediately, unless the queue is full and the
+    // overflow policy requires the caller to wait
+    void submit(Task task, SpillTask spill_task = nullptr);
+
+    // queue the task and wait for it to complete, any exception thrown by the
+    // task is rethrown here
+    void execute(Task task);
+
+    // stop accepting tasks, run everything queued, then stop the writer thread and
+    // return the connection to the caller
+    std::unique_ptr<Conn> shutdown();
+
+    std::size_t size() const;
+    std::size_t capacity() const noexcept { return _capacity; }
+    OverflowPolicy policy() const noexcept { return _policy; }
+
+    // counts of asynchronous tasks that were discarded, spilled, or failed
+    std::size_t dropped() const;
+    std::size_t spilled() const;
+    std::size_t failed() const;
+
+    void print(std::ostream &os) const noexcept;
+
+private:
+    struct Item
+    {
+        Task task;
+        SpillTask spill_task;
+
+        // only set for tasks run via execute()
+        std::shared_ptr<std::promise<void>> result;
+    };
+
+    void enqueue(Item item);
+    void run(Item &item);
+    void writer();
+
+    std::unique_ptr<Conn> _conn;
+    std::size_t _capacity;
+    OverflowPolicy _policy;
+    Task _idle_task;
+    std::chrono::milliseconds _idle_interval;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    std::deque<Item> _items;
+    bool _stopping = false;
+
+    std::size_t _dropped = 0;
+    std::size_t _spilled = 0;
+    std::size_t _failed = 0;
+
+    std::thread _writer;
+};
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+WriteBehindQueue<Conn>::WriteBehindQueue(std::unique_ptr<Conn> conn,
+    std::size_t capacity,
+    OverflowPolicy policy,
+    Task idle_task,
+    std::chrono::milliseconds idle_interval) :
+    _conn(std::move(conn)),
+    _capacity(capacity),
+    _policy(policy),
+    _idle_task(std::move(idle_task)),
+    _idle_interval(idle_interval)
+{
+    assert(_conn);
+    assert(_capacity > 0);
+
+    _writer = std::thread(&WriteBehindQueue<Conn>::writer, this);
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+WriteBehindQueue<Conn>::~WriteBehindQueue()
+{
+    if (_writer.joinable())
+        shutdown();
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::submit(Task task, SpillTask spill_task)
+{
+    enqueue(Item {std::move(task), std::move(spill_task), nullptr});
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::execute(Task task)
+{
+    auto result = std::make_shared<std::promise<void>>();
+    auto future = result->get_future();
+
+    enqueue(Item {std::move(task), nullptr, result});
+
+    // rethrows on this thread if the task failed
+    future.get();
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::unique_ptr<Conn> WriteBehindQueue<Conn>::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    // callers waiting on a full queue are woken too, to be refused
+    _not_empty.notify_all();
+    _not_full.notify_all();
+
+    if (_writer.joinable())
+        _writer.join();
+
+    spdlog::debug("Write behind queue shutdown, dropped: {}, spilled: {}, failed: {}", _dropped, _spilled, _failed);
+    return std::move(_conn);
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriteBehindQueue<Conn>::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _items.size();
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriteBehindQueue<Conn>::dropped() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriteBehindQueue<Conn>::spilled() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _spilled;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriteBehindQueue<Conn>::failed() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _failed;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::enqueue(Item item)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto check_stopping = [this]() {
+        if (_stopping)
+        {
+            std::string msg {"The write behind queue is shutting down. Unable to queue the task."};
+            spdlog::error("Error: {}", msg);
+            Tango::Except::throw_exception("Queue Error", msg, LOCATION_INFO);
+        }
+    };
+
+    check_stopping();
+
+    while (_items.size() >= _capacity)
+    {
+        // only asynchronous tasks may be discarded, execute() callers are waiting
+        // on their result. Spilling also requires the task to have a fallback
+        auto victim = _items.end();
+
+        if (_policy == OverflowPolicy::DropOldest)
+            victim = std::find_if(_items.begin(), _items.end(), [](const Item &i) { return !i.result; });
+        else if (_policy == OverflowPolicy::Spill)
+            victim = std::find_if(_items.begin(), _items.end(), [](const Item &i) { return !!i.spill_task; });
+
+        if (victim == _items.end())
+        {
+            _not_full.wait(lock);
+
+            // the queue may have been shut down while waiting, and the writer may already
+            // have exited, so the task would never be run
+            check_stopping();
+            continue;
+        }
+
+        if (_policy == OverflowPolicy::Spill)
+        {
+            // spill under the lock, so spilled tasks keep their relative order
+            try
+            {
+                victim->spill_task();
+                _spilled++;
+            }
+            catch (...)
+            {
+                _dropped++;
+                spdlog::error("Error: Failed to spill a task from the full write behind queue, it has been dropped");
+            }
+        }
+        else
+        {
+            _dropped++;
+
+            // do not flood the log when the database falls behind for a long period
+            if (_dropped % 1000 == 1)
+                spdlog::warn("Write behind queue is full, dropped the oldest task. Dropped so far: {}", _dropped);
+        }
+
+        _items.erase(victim);
+    }
+
+    _items.push_back(std::move(item));
+    lock.unlock();
+    _not_empty.notify_one();
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::run(Item &item)
+{
+    try
+    {
+        item.task(*_conn);
+
+        if (item.result)
+            item.result->set_value();
+    }
+    catch (...)
+    {
+        if (item.result)
+        {
+            item.result->set_exception(std::current_exception());
+        }
+        else
+        {
+            // the task has already logged the cause, all we can do is record it
+            std::lock_guard<std::mutex> lock(_mutex);
+            _failed++;
+            spdlog::error("Error: An asynchronous write failed. Failed so far: {}", _failed);
+        }
+    }
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::writer()
+{
+    // the idle task is due once the idle interval has elapsed, whether or not tasks
+    // arrived meanwhile, so a steady flow of tasks can not hold it off
+    auto next_idle = std::chrono::steady_clock::now() + _idle_interval;
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_empty.wait_until(lock, next_idle, [this]() { return _stopping || !_items.empty(); });
+
+        if (std::chrono::steady_clock::now() >= next_idle)
+        {
+            lock.unlock();
+
+            if (_idle_task)
+            {
+                Item idle {_idle_task, nullptr, nullptr};
+                run(idle);
+            }
+
+            next_idle = std::chrono::steady_clock::now() + _idle_interval;
+            continue;
+        }
+
+        // when stopping, keep going until the queue is drained
+        if (_items.empty())
+            break;
+
+        auto item = std::move(_items.front());
+        _items.pop_front();
+        lock.unlock();
+        _not_full.notify_one();
+
+        run(item);
+    }
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriteBehindQueue<Conn>::print(std::ostream &os) const noexcept
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    os << "WriteBehindQueue(size: " << _items.size() << ", "
+       << "_capacity: " << _capacity << ", "
+       << "_dropped: " << _dropped << ", "
+       << "_spilled: " << _spilled << ", "
+       << "_failed: " << _failed << ")";
+}
+} // namespace hdbpp_internal
+#endif // _WRITE_BEHIND_QUEUE_HPP
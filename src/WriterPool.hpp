@@ -0,0 +1,169 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _WRITER_POOL_HPP
+#define _WRITER_POOL_HPP
+
+#include "WriteBehindQueue.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hdbpp_internal
+{
+// The WriterPool spreads requests over a number of connections, each owned by its own
+// WriteBehindQueue and writer thread. Requests are sharded by a key, normally the
+// attribute name, so every request for an attribute is run by the same writer in the
+// order it was made, while different attributes are stored in parallel.
+template<typename Conn>
+class WriterPool
+{
+public:
+    using Queue = WriteBehindQueue<Conn>;
+    using Task = typename Queue::Task;
+    using SpillTask = typename Queue::SpillTask;
+    using OverflowPolicy = typename Queue::OverflowPolicy;
+
+    // one writer is started for each connection, each with its own queue of the
+    // given capacity
+    WriterPool(std::vector<std::unique_ptr<Conn>> conns,
+        std::size_t capacity,
+        OverflowPolicy policy,
+        Task idle_task = nullptr,
+        std::chrono::milliseconds idle_interval = std::chrono::milliseconds(1000));
+
+    // the writer that handles all requests for the key
+    Queue &writerFor(const std::string &key) { return writerFor(std::hash<std::string> {}(key)); }
+
+    // as above, for a key that has already been hashed
+    Queue &writerFor(std::size_t key_hash) { return *_writers[key_hash % _writers.size()]; }
+
+    template<typename Key>
+    void submit(const Key &key, Task task, SpillTask spill_task = nullptr)
+    {
+        writerFor(key).submit(std::move(task), std::move(spill_task));
+    }
+
+    template<typename Key>
+    void execute(const Key &key, Task task)
+    {
+        writerFor(key).execute(std::move(task));
+    }
+
+    // shutdown every writer, returning the connections to the caller once all
+    // queued requests are complete
+    std::vector<std::unique_ptr<Conn>> shutdown();
+
+    std::size_t size() const noexcept { return _writers.size(); }
+
+    // totals across all the writers
+    std::size_t dropped() const;
+    std::size_t spilled() const;
+    std::size_t failed() const;
+
+    void print(std::ostream &os) const noexcept;
+
+private:
+    std::vector<std::unique_ptr<Queue>> _writers;
+};
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+WriterPool<Conn>::WriterPool(std::vector<std::unique_ptr<Conn>> conns,
+    std::size_t capacity,
+    OverflowPolicy policy,
+    Task idle_task,
+    std::chrono::milliseconds idle_interval)
+{
+    assert(!conns.empty());
+
+    for (auto &conn : conns)
+        _writers.push_back(std::make_unique<Queue>(std::move(conn), capacity, policy, idle_task, idle_interval));
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::vector<std::unique_ptr<Conn>> WriterPool<Conn>::shutdown()
+{
+    std::vector<std::unique_ptr<Conn>> conns;
+
+    for (auto &writer : _writers)
+        conns.push_back(writer->shutdown());
+
+    return conns;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriterPool<Conn>::dropped() const
+{
+    std::size_t total = 0;
+
+    for (const auto &writer : _writers)
+        total += writer->dropped();
+
+    return total;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriterPool<Conn>::spilled() const
+{
+    std::size_t total = 0;
+
+    for (const auto &writer : _writers)
+        total += writer->spilled();
+
+    return total;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+std::size_t WriterPool<Conn>::failed() const
+{
+    std::size_t total = 0;
+
+    for (const auto &writer : _writers)
+        total += writer->failed();
+
+    return total;
+}
+
+//=============================================================================
+//=============================================================================
+template<typename Conn>
+void WriterPool<Conn>::print(std::ostream &os) const noexcept
+{
+    os << "WriterPool(writers: " << _writers.size() << ", "
+       << "dropped: " << dropped() << ", "
+       << "spilled: " << spilled() << ", "
+       << "failed: " << failed() << ")";
+}
+} // namespace hdbpp_internal
+#endif // _WRITER_POOL_HPP
@@ -0,0 +1,165 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "ArrayParse.hpp"
+#include "catch2/catch.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal::pqxx_conn;
+
+namespace array_parse_test
+{
+// parse the body of an array literal held in a string
+template<typename T>
+bool parse(const string &text, vector<T> &values)
+{
+    return array_parse::parseArray(text.data(), text.data() + text.size(), values);
+}
+} // namespace array_parse_test
+
+SCENARIO("Delimiters are found wherever they fall in the text", "[array-parse]")
+{
+    GIVEN("Text long enough to be searched in blocks")
+    {
+        THEN("A delimiter at every position is found, matching a simple search")
+        {
+            for (size_t length = 0; length < 100; length++)
+            {
+                for (size_t position = 0; position <= length; position++)
+                {
+                    string text(length, 'x');
+
+                    if (position < length)
+                        text[position] = ',';
+
+                    auto found = array_parse::findDelimiter(text.data(), text.data() + text.size(), ',');
+                    REQUIRE(static_cast<size_t>(found - text.data()) == position);
+                }
+            }
+        }
+        THEN("Every delimiter is counted")
+        {
+            string text;
+
+            for (auto i = 0; i < 100; i++)
+                text += i % 3 == 0 ? "," : "12";
+
+            REQUIRE(array_parse::countDelimiters(text.data(), text.data() + text.size(), ',') == 34);
+        }
+    }
+}
+
+SCENARIO("Arrays of integers are parsed with range checks", "[array-parse]")
+{
+    GIVEN("Valid arrays")
+    {
+        vector<int16_t> shorts;
+        vector<uint64_t> ulongs;
+        vector<int64_t> longs;
+
+        THEN("Every element is parsed, including the limits of the type")
+        {
+            REQUIRE(array_parse_test::parse("1,-32768,32767,+4", shorts));
+            REQUIRE(shorts == vector<int16_t> {1, -32768, 32767, 4});
+
+            REQUIRE(array_parse_test::parse("0,18446744073709551615", ulongs));
+            REQUIRE(ulongs == vector<uint64_t> {0, numeric_limits<uint64_t>::max()});
+
+            REQUIRE(array_parse_test::parse("-9223372036854775808", longs));
+            REQUIRE(longs == vector<int64_t> {numeric_limits<int64_t>::min()});
+        }
+    }
+    GIVEN("Invalid arrays")
+    {
+        vector<int16_t> shorts;
+        vector<uint8_t> uchars;
+
+        THEN("Out of range, signed unsigned, empty and non numeric elements are refused")
+        {
+            REQUIRE(!array_parse_test::parse("32768", shorts));
+            REQUIRE(!array_parse_test::parse("-32769", shorts));
+            REQUIRE(!array_parse_test::parse("256", uchars));
+            REQUIRE(!array_parse_test::parse("-1", uchars));
+            REQUIRE(!array_parse_test::parse("1,,2", shorts));
+            REQUIRE(!array_parse_test::parse("1,NULL", shorts));
+            REQUIRE(!array_parse_test::parse("1.5", shorts));
+        }
+    }
+    GIVEN("An empty array")
+    {
+        vector<int32_t> values {1, 2};
+
+        THEN("The result is empty")
+        {
+            REQUIRE(array_parse_test::parse("", values));
+            REQUIRE(values.empty());
+        }
+    }
+}
+
+SCENARIO("Arrays of floating point values are parsed", "[array-parse]")
+{
+    GIVEN("An array with finite and non finite values")
+    {
+        vector<double> values;
+
+        THEN("Each value is parsed exactly")
+        {
+            REQUIRE(array_parse_test::parse("0.1,-2.5e-300,1e+300,NaN,Infinity,-Infinity", values));
+            REQUIRE(values.size() == 6);
+            REQUIRE(values[0] == 0.1);
+            REQUIRE(values[1] == -2.5e-300);
+            REQUIRE(values[2] == 1e300);
+            REQUIRE(std::isnan(values[3]));
+            REQUIRE(values[4] == numeric_limits<double>::infinity());
+            REQUIRE(values[5] == -numeric_limits<double>::infinity());
+        }
+        THEN("Trailing text in an element is refused") { REQUIRE(!array_parse_test::parse("1.5x,2", values)); }
+    }
+    GIVEN("An array of floats")
+    {
+        vector<float> values;
+
+        THEN("Each value is parsed as a float")
+        {
+            REQUIRE(array_parse_test::parse("0.1,3.4028235e+38", values));
+            REQUIRE(values == vector<float> {0.1f, numeric_limits<float>::max()});
+        }
+    }
+}
+
+SCENARIO("Arrays of bools are parsed", "[array-parse]")
+{
+    GIVEN("An array in the postgres output format")
+    {
+        vector<bool> values;
+
+        THEN("Both the short and long forms are accepted")
+        {
+            REQUIRE(array_parse_test::parse("t,f,true,false", values));
+            REQUIRE(values == vector<bool> {true, false, true, false});
+            REQUIRE(!array_parse_test::parse("t,yes", values));
+        }
+    }
+}
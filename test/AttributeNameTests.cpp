@@ -148,7 +148,8 @@ SCENARIO("AttributeName supports fully qualified attribute name but no network d
         WHEN("Tango host with domain is requested")
         {
             string server_name_with_domain;
-            auto server_name = attribute_name.tangoHost().substr(0, attribute_name.tangoHost().find(':', 0));
+            auto tango_host = attribute_name.tangoHost().to_string();
+            auto server_name = tango_host.substr(0, tango_host.find(':', 0));
             struct addrinfo hints = {};
 
             hints.ai_family = AF_UNSPEC;
@@ -161,8 +162,7 @@ SCENARIO("AttributeName supports fully qualified attribute name but no network d
             REQUIRE(status == 0);
 
             for (rp = result; rp != nullptr; rp = rp->ai_next)
-                server_name_with_domain = string(rp->ai_canonname) +
-                    attribute_name.tangoHost().substr(attribute_name.tangoHost().find(':', 0));
+                server_name_with_domain = string(rp->ai_canonname) + tango_host.substr(tango_host.find(':', 0));
 
             freeaddrinfo(result);
 
@@ -293,3 +293,65 @@ SCENARIO("Unconfigured AttributeName objects throw errors", "[attribute-name]")
         }
     }
 }
+
+SCENARIO("AttributeName only throws for malformed names when the name elements are requested", "[attribute-name]")
+{
+    GIVEN("Attribute names missing one of their elements")
+    {
+        auto malformed = {"tango://localhost:10000/test-domain/test-family/test",
+            "tango://localhost:10000/test-domain/test-family/test-member/test/extra",
+            "tango://localhost:10000//test-family/test-member/test",
+            "tango://localhost:10000/test-domain//test-member/test",
+            "tango://localhost:10000/test-domain/test-family//test",
+            "tango://localhost:10000/test-domain/test-family/test-member/"};
+
+        for (const auto &fqdn : malformed)
+        {
+            AttributeName attribute_name {fqdn};
+
+            WHEN("Requesting the tango host and full attribute name of " + string(fqdn))
+            {
+                THEN("They are returned")
+                {
+                    REQUIRE(attribute_name.tangoHost() == "localhost:10000");
+                    REQUIRE(attribute_name.fullAttributeName() == string(fqdn).substr(24));
+                }
+            }
+            WHEN("Requesting the name elements of " + string(fqdn))
+            {
+                THEN("An exception is thrown")
+                {
+                    REQUIRE_THROWS(attribute_name.domain());
+                    REQUIRE_THROWS(attribute_name.family());
+                    REQUIRE_THROWS(attribute_name.member());
+                    REQUIRE_THROWS(attribute_name.name());
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("A copied AttributeName has the same elements as the original", "[attribute-name]")
+{
+    GIVEN("A copy of an AttributeName with a valid fqdn")
+    {
+        AttributeName original {TestAttrFQDName};
+        AttributeName copy {original};
+
+        WHEN("The original is set to another name")
+        {
+            original.set(TestAttrFQDNameNoDomain);
+
+            THEN("The copy still returns the elements of the first name")
+            {
+                REQUIRE(copy.fqdnAttributeName() == TestAttrFQDName);
+                REQUIRE(copy.tangoHost() == TestAttrTangoHost);
+                REQUIRE(copy.fullAttributeName() == TestAttrFullAttrName);
+                REQUIRE(copy.domain() == TestAttrDomain);
+                REQUIRE(copy.family() == TestAttrFamily);
+                REQUIRE(copy.member() == TestAttrMember);
+                REQUIRE(copy.name() == TestAttrName);
+            }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "AttributeName.hpp"
+#include "AttributeRegistry.hpp"
+#include "TestHelpers.hpp"
+#include "catch2/catch.hpp"
+
+#include <future>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+using namespace hdbpp_test::attr_name;
+
+SCENARIO("AttributeRegistry registers an attribute once", "[attribute-registry]")
+{
+    AttributeRegistry registry;
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    GIVEN("An attribute acquired for the first time")
+    {
+        const auto &record = registry.acquire(TestAttrFQDName, traits);
+
+        THEN("Its record holds the names and traits it is stored with")
+        {
+            REQUIRE(record.fqdn_attr_name == TestAttrFQDName);
+            REQUIRE(record.storage_name == TestAttrFinalName);
+            REQUIRE(record.shard == hash<string_view> {}(TestAttrFullAttrName));
+            REQUIRE(record.traits == traits);
+            REQUIRE(registry.size() == 1);
+        }
+        WHEN("The attribute is acquired again with the same traits")
+        {
+            const auto &again = registry.acquire(TestAttrFQDName, traits);
+
+            THEN("The same record is returned")
+            {
+                REQUIRE(&again == &record);
+                REQUIRE(again.handle == record.handle);
+                REQUIRE(registry.size() == 1);
+            }
+        }
+        WHEN("The attribute is looked up by its handle")
+        {
+            THEN("Its record is returned")
+            {
+                REQUIRE(&registry.record(record.handle) == &record);
+            }
+        }
+        WHEN("The attribute is acquired under a tango host without the domain")
+        {
+            const auto &other = registry.acquire(TestAttrFQDNameNoDomain, traits);
+
+            THEN("It is a separate record on the same writer shard")
+            {
+                REQUIRE(other.handle != record.handle);
+                REQUIRE(other.shard == record.shard);
+                REQUIRE(registry.size() == 2);
+            }
+        }
+        WHEN("The attribute is acquired with different traits")
+        {
+            AttributeTraits changed {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_LONG};
+            const auto &updated = registry.acquire(TestAttrFQDName, changed);
+
+            THEN("A new record is returned and the old one is left intact")
+            {
+                REQUIRE(updated.handle != record.handle);
+                REQUIRE(updated.traits == changed);
+                REQUIRE(record.traits == traits);
+                REQUIRE(record.storage_name == TestAttrFinalName);
+                REQUIRE(&registry.acquire(TestAttrFQDName, changed) == &updated);
+            }
+        }
+    }
+}
+
+SCENARIO("AttributeRegistry rejects empty names and unknown handles", "[attribute-registry]")
+{
+    AttributeRegistry registry;
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    GIVEN("An empty registry")
+    {
+        WHEN("An empty attribute name is acquired")
+        {
+            THEN("An exception is raised and nothing is registered")
+            {
+                REQUIRE_THROWS(registry.acquire("", traits));
+                REQUIRE(registry.size() == 0);
+            }
+        }
+        WHEN("An unknown handle is looked up")
+        {
+            THEN("An exception is raised")
+            {
+                REQUIRE_THROWS(registry.record(0));
+            }
+        }
+    }
+}
+
+TEST_CASE("AttributeRegistry gives concurrent first lookups a single record", "[attribute-registry]")
+{
+    AttributeRegistry registry;
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    vector<future<const AttributeRecord *>> lookups;
+
+    for (auto i = 0; i < 8; i++)
+        lookups.push_back(async(launch::async, [&registry, &traits]() {
+            const AttributeRecord *record = nullptr;
+
+            for (auto j = 0; j < 100; j++)
+                record = &registry.acquire(TestAttrFQDName, traits);
+
+            return record;
+        }));
+
+    const auto *first = lookups.front().get();
+
+    for (auto i = 1u; i < lookups.size(); i++)
+        REQUIRE(lookups[i].get() == first);
+
+    REQUIRE(registry.size() == 1);
+}
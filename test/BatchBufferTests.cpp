@@ -0,0 +1,141 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "BatchBuffer.hpp"
+#include "catch2/catch.hpp"
+
+#include <algorithm>
+
+using namespace std;
+using namespace hdbpp_internal;
+using namespace hdbpp_internal::pqxx_conn;
+
+namespace batch_buffer_test
+{
+const string TestTableA = "att_scalar_devdouble";
+const string TestTableB = "att_array_devfloat";
+const string TestRow = "(1,TO_TIMESTAMP(1),1.0,NULL,0)";
+} // namespace batch_buffer_test
+
+SCENARIO("BatchBuffer reports a batch is full when it reaches the batch size", "[batch-buffer]")
+{
+    GIVEN("A BatchBuffer with a batch size of 3")
+    {
+        BatchBuffer<string> buffer(3, chrono::milliseconds(1000));
+        REQUIRE(buffer.empty());
+
+        WHEN("Adding fewer rows than the batch size")
+        {
+            REQUIRE(buffer.add(batch_buffer_test::TestTableA, batch_buffer_test::TestRow) == false);
+            REQUIRE(buffer.add(batch_buffer_test::TestTableA, batch_buffer_test::TestRow) == false);
+
+            THEN("The rows are counted against the table")
+            {
+                REQUIRE(buffer.size(batch_buffer_test::TestTableA) == 2);
+                REQUIRE(buffer.size(batch_buffer_test::TestTableB) == 0);
+                REQUIRE(buffer.size() == 2);
+            }
+            AND_WHEN("Adding the final row")
+            {
+                THEN("The batch is reported full")
+                {
+                    REQUIRE(buffer.add(batch_buffer_test::TestTableA, batch_buffer_test::TestRow) == true);
+                }
+            }
+        }
+        WHEN("Adding rows to different tables")
+        {
+            REQUIRE(buffer.add(batch_buffer_test::TestTableA, batch_buffer_test::TestRow) == false);
+            REQUIRE(buffer.add(batch_buffer_test::TestTableB, batch_buffer_test::TestRow) == false);
+            REQUIRE(buffer.add(batch_buffer_test::TestTableB, batch_buffer_test::TestRow) == false);
+
+            THEN("Each table is batched independently")
+            {
+                auto tables = buffer.tables();
+                REQUIRE(tables.size() == 2);
+                REQUIRE(find(tables.begin(), tables.end(), batch_buffer_test::TestTableA) != tables.end());
+                REQUIRE(find(tables.begin(), tables.end(), batch_buffer_test::TestTableB) != tables.end());
+                REQUIRE(buffer.size() == 3);
+            }
+        }
+    }
+}
+
+SCENARIO("BatchBuffer rows can be taken for a table", "[batch-buffer]")
+{
+    GIVEN("A BatchBuffer with rows for two tables")
+    {
+        BatchBuffer<string> buffer(10, chrono::milliseconds(1000));
+        buffer.add(batch_buffer_test::TestTableA, "row1");
+        buffer.add(batch_buffer_test::TestTableA, "row2");
+        buffer.add(batch_buffer_test::TestTableB, "row3");
+
+        WHEN("Taking the rows for a table")
+        {
+            auto rows = buffer.take(batch_buffer_test::TestTableA);
+
+            THEN("The rows are returned in the order they were added")
+            {
+                REQUIRE(rows.size() == 2);
+                REQUIRE(rows[0] == "row1");
+                REQUIRE(rows[1] == "row2");
+            }
+            AND_THEN("Only the other table has rows remaining")
+            {
+                REQUIRE(buffer.size(batch_buffer_test::TestTableA) == 0);
+                REQUIRE(buffer.size(batch_buffer_test::TestTableB) == 1);
+                REQUIRE(buffer.tables().size() == 1);
+            }
+        }
+        WHEN("Taking the rows for a table with no rows")
+        {
+            THEN("Nothing is returned") { REQUIRE(buffer.take("att_scalar_devlong").empty()); }
+        }
+        WHEN("Clearing the buffer")
+        {
+            buffer.clear();
+
+            THEN("The buffer is empty") { REQUIRE(buffer.empty()); }
+        }
+    }
+}
+
+SCENARIO("BatchBuffer reports tables whose rows have waited longer than the max age", "[batch-buffer]")
+{
+    GIVEN("A BatchBuffer with a max age of 100ms and rows for a table")
+    {
+        BatchBuffer<string> buffer(10, chrono::milliseconds(100));
+        buffer.add(batch_buffer_test::TestTableA, batch_buffer_test::TestRow);
+
+        WHEN("Checking before the max age")
+        {
+            THEN("No tables are expired") { REQUIRE(buffer.expiredTables().empty()); }
+        }
+        WHEN("Checking after the max age")
+        {
+            auto expired = buffer.expiredTables(BatchBuffer<string>::Clock::now() + chrono::milliseconds(200));
+
+            THEN("The table is expired")
+            {
+                REQUIRE(expired.size() == 1);
+                REQUIRE(expired[0] == batch_buffer_test::TestTableA);
+            }
+        }
+    }
+}
@@ -0,0 +1,244 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "BinaryCopy.hpp"
+#include "catch2/catch.hpp"
+
+#include <initializer_list>
+#include <limits>
+
+using namespace std;
+using namespace hdbpp_internal;
+using namespace hdbpp_internal::pqxx_conn;
+using namespace hdbpp_internal::pqxx_conn::binary_copy;
+
+namespace binary_copy_test
+{
+// build a string from a list of bytes, to compare against encoded output
+string bytes(initializer_list<unsigned char> values)
+{
+    return string(values.begin(), values.end());
+}
+} // namespace binary_copy_test
+
+SCENARIO("Fixed size values are encoded in network byte order", "[binary-copy]")
+{
+    GIVEN("An empty output buffer")
+    {
+        string out;
+
+        WHEN("Encoding a double field")
+        {
+            appendField(out, 1.0);
+
+            THEN("The length and big endian value are written")
+            {
+                REQUIRE(out == binary_copy_test::bytes({0, 0, 0, 8, 0x3f, 0xf0, 0, 0, 0, 0, 0, 0}));
+            }
+        }
+        WHEN("Encoding an int16 field")
+        {
+            appendField(out, static_cast<int16_t>(-2));
+
+            THEN("The length and big endian value are written")
+            {
+                REQUIRE(out == binary_copy_test::bytes({0, 0, 0, 2, 0xff, 0xfe}));
+            }
+        }
+        WHEN("Encoding a null")
+        {
+            appendNull(out);
+
+            THEN("The length is -1") { REQUIRE(out == binary_copy_test::bytes({0xff, 0xff, 0xff, 0xff})); }
+        }
+        WHEN("Encoding a timestamp one and a half seconds after the postgres epoch")
+        {
+            appendTimestampField(out, PostgresEpochOffset + 1.5);
+
+            THEN("The value is in microseconds")
+            {
+                REQUIRE(out == binary_copy_test::bytes({0, 0, 0, 8, 0, 0, 0, 0, 0, 0x16, 0xe3, 0x60}));
+            }
+        }
+    }
+}
+
+SCENARIO("Unsigned values are encoded as numeric", "[binary-copy]")
+{
+    GIVEN("An empty output buffer")
+    {
+        string out;
+
+        WHEN("Encoding 12345678")
+        {
+            appendNumeric(out, 12345678);
+
+            THEN("Two base 10000 digits are written with weight 1")
+            {
+                REQUIRE(out == binary_copy_test::bytes({0, 2, 0, 1, 0, 0, 0, 0, 0x04, 0xd2, 0x16, 0x2e}));
+            }
+        }
+        WHEN("Encoding 10000")
+        {
+            appendNumeric(out, 10000);
+
+            THEN("The trailing zero digit is dropped")
+            {
+                REQUIRE(out == binary_copy_test::bytes({0, 1, 0, 1, 0, 0, 0, 0, 0, 1}));
+            }
+        }
+        WHEN("Encoding 0")
+        {
+            appendNumeric(out, 0);
+
+            THEN("No digits are written") { REQUIRE(out == binary_copy_test::bytes({0, 0, 0, 0, 0, 0, 0, 0})); }
+        }
+        WHEN("Encoding the maximum uint64")
+        {
+            appendNumeric(out, numeric_limits<uint64_t>::max());
+
+            THEN("Five digits are written, most significant first")
+            {
+                REQUIRE(out ==
+                    binary_copy_test::bytes(
+                        {0, 5, 0, 4, 0, 0, 0, 0, 0x07, 0x34, 0x1a, 0x58, 0x02, 0xe1, 0x03, 0xbb, 0x06, 0x4f}));
+            }
+        }
+    }
+}
+
+SCENARIO("Arrays are encoded in the postgres binary array format", "[binary-copy]")
+{
+    GIVEN("An empty output buffer and domain oids")
+    {
+        string out;
+        DomainOids oids;
+        oids.ulong = 5000;
+
+        WHEN("Encoding a bool array")
+        {
+            appendArrayField(out, vector<bool> {true, false}, oids);
+
+            THEN("The header carries the bool oid and each element is a field")
+            {
+                REQUIRE(out ==
+                    binary_copy_test::bytes({0, 0, 0, 0x1e, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0x10, 0, 0, 0, 2,
+                        0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0}));
+            }
+        }
+        WHEN("Encoding an unsigned array")
+        {
+            appendArrayField(out, vector<uint32_t> {1}, oids);
+
+            THEN("The header carries the domain oid")
+            {
+                REQUIRE(out.substr(12, 4) == binary_copy_test::bytes({0, 0, 0x13, 0x88}));
+            }
+        }
+    }
+}
+
+SCENARIO("Data event tuples contain all the copy columns", "[binary-copy]")
+{
+    GIVEN("A scalar read only attribute")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_STATE};
+        DomainOids oids;
+        auto value_r = make_unique<vector<Tango::DevState>>(1, Tango::OFF);
+        auto value_w = make_unique<vector<Tango::DevState>>();
+
+        WHEN("Encoding a data event tuple")
+        {
+            auto tuple = dataEventTuple<Tango::DevState>(3, PostgresEpochOffset, 0, value_r, value_w, traits, oids);
+
+            THEN("The tuple has five fields with a null write value")
+            {
+                REQUIRE(tuple ==
+                    binary_copy_test::bytes({0, 5, 0, 0, 0, 4, 0, 0, 0, 3, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0, 0, 0,
+                        0, 0, 0, 4, 0, 0, 0, 1, 0xff, 0xff, 0xff, 0xff, 0, 0, 0, 2, 0, 0}));
+            }
+        }
+    }
+}
+
+SCENARIO("Data event tuples encoded from views match those encoded from vectors", "[binary-copy]")
+{
+    GIVEN("A spectrum read write attribute, with its read and set values held in one buffer")
+    {
+        AttributeTraits traits {Tango::READ_WRITE, Tango::SPECTRUM, Tango::DEV_ULONG};
+        DomainOids oids;
+        oids.ulong = 5000;
+
+        vector<uint32_t> buffer {1, 20000, 3, 4, 50000};
+        auto value_r = make_unique<vector<uint32_t>>(buffer.begin(), buffer.begin() + 3);
+        auto value_w = make_unique<vector<uint32_t>>(buffer.begin() + 3, buffer.end());
+
+        WHEN("Encoding a data event tuple from views of the buffer")
+        {
+            string tuple;
+
+            appendDataEventTuple<uint32_t>(tuple,
+                3,
+                PostgresEpochOffset,
+                0,
+                ValueView<uint32_t>(buffer.data(), 3),
+                ValueView<uint32_t>(buffer.data() + 3, 2),
+                traits,
+                oids);
+
+            THEN("The tuple is the same as one built from vectors of the values")
+            {
+                REQUIRE(tuple == dataEventTuple<uint32_t>(3, PostgresEpochOffset, 0, value_r, value_w, traits, oids));
+            }
+        }
+        WHEN("Appending a second tuple to the same buffer")
+        {
+            string tuple;
+            ValueView<uint32_t> read(buffer.data(), 3);
+
+            appendDataEventTuple<uint32_t>(tuple, 3, PostgresEpochOffset, 0, read, {}, traits, oids);
+            auto first = tuple.size();
+            appendDataEventTuple<uint32_t>(tuple, 3, PostgresEpochOffset, 0, read, {}, traits, oids);
+
+            THEN("The first tuple is left in place")
+            {
+                REQUIRE(tuple.size() == first * 2);
+                REQUIRE(tuple.substr(0, first) == tuple.substr(first));
+            }
+        }
+    }
+    GIVEN("A scalar attribute with no data")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+        DomainOids oids;
+        auto value_r = make_unique<vector<double>>();
+        auto value_w = make_unique<vector<double>>();
+
+        WHEN("Encoding a data event tuple from empty views")
+        {
+            string tuple;
+            appendDataEventTuple<double>(tuple, 3, PostgresEpochOffset, 0, {}, {}, traits, oids);
+
+            THEN("Both value fields are null, as they are from empty vectors")
+            {
+                REQUIRE(tuple == dataEventTuple<double>(3, PostgresEpochOffset, 0, value_r, value_w, traits, oids));
+            }
+        }
+    }
+}
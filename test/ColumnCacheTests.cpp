@@ -21,8 +21,10 @@
 #include "TestHelpers.hpp"
 #include "catch2/catch.hpp"
 
+#include <chrono>
 #include <pqxx/pqxx>
 #include <string>
+#include <thread>
 
 using namespace std;
 using namespace hdbpp_internal;
@@ -86,6 +88,12 @@ SCENARIO("ColumnCache can access and retrieve data from the database", "[db-acce
             REQUIRE_NOTHROW(cache.fetchAll());
 
             THEN("Data is fetched and cache size 3") { REQUIRE(cache.size() == 3); }
+            THEN("Each reference has the value from its row")
+            {
+                REQUIRE(cache.value(Ref1) == 1);
+                REQUIRE(cache.value(Ref2) == 2);
+                REQUIRE(cache.value(Ref3) == 3);
+            }
             AND_WHEN("Request to fetch data again")
             {
                 REQUIRE_NOTHROW(cache.fetchAll());
@@ -223,6 +231,77 @@ SCENARIO("It is an error to request invalid values", "[db-access][column-cache]"
     conn->disconnect();
 }
 
+SCENARIO("ColumnCache remembers references missing from the database", "[db-access][column-cache]")
+{
+    auto conn = connectDb();
+
+    // the reference is added behind the cache's back, so only a database lookup can find it
+    auto add_new_value1 = [&conn]() {
+        pqxx::work tx {*conn};
+        tx.exec0("INSERT INTO " + TableName + "(" + ReferenceCol + ") VALUES (" + tx.quote(NewValue1) + ");");
+        tx.commit();
+    };
+
+    GIVEN("A ColumnCache that has looked up a missing reference")
+    {
+        ColumnCache<int, string> cache(conn, TableName, IdCol, ReferenceCol, 2, chrono::milliseconds(200));
+        REQUIRE_FALSE(cache.valueExists(NewValue1));
+        REQUIRE(cache.missingSize() == 1);
+
+        WHEN("The reference is added to the database and looked up again")
+        {
+            add_new_value1();
+
+            THEN("It is still reported missing without querying the database")
+            {
+                REQUIRE_FALSE(cache.valueExists(NewValue1));
+                REQUIRE_THROWS(cache.value(NewValue1));
+            }
+            AND_WHEN("The missing reference expires")
+            {
+                this_thread::sleep_for(chrono::milliseconds(250));
+
+                THEN("It is found in the database")
+                {
+                    REQUIRE(cache.valueExists(NewValue1));
+                    REQUIRE(cache.missingSize() == 0);
+                }
+            }
+            AND_WHEN("The missing reference is forgotten")
+            {
+                cache.forgetMissing(NewValue1);
+
+                THEN("It is found in the database") { REQUIRE(cache.valueExists(NewValue1)); }
+            }
+        }
+        WHEN("A value is cached for the reference")
+        {
+            REQUIRE_NOTHROW(cache.cacheValue(NewValue1Id, NewValue1));
+
+            THEN("It is no longer missing")
+            {
+                REQUIRE(cache.missingSize() == 0);
+                REQUIRE(cache.value(NewValue1) == NewValue1Id);
+            }
+        }
+        WHEN("The cache is cleared")
+        {
+            cache.clear();
+
+            THEN("The missing reference is forgotten") { REQUIRE(cache.missingSize() == 0); }
+        }
+        WHEN("More references are found missing than the cache holds")
+        {
+            REQUIRE_FALSE(cache.valueExists("Missing 2"));
+            REQUIRE_FALSE(cache.valueExists("Missing 3"));
+
+            THEN("The number remembered is bounded") { REQUIRE(cache.missingSize() == 2); }
+        }
+    }
+
+    conn->disconnect();
+}
+
 SCENARIO("Clearing the cache does not stop entries being cached again", "[db-access][column-cache]")
 {
     auto conn = connectDb();
@@ -237,6 +316,12 @@ SCENARIO("Clearing the cache does not stop entries being cached again", "[db-acc
             REQUIRE_NOTHROW(cache.fetchAll());
 
             THEN("Data is fetched and cache size 3") { REQUIRE(cache.size() == 3); }
+            THEN("Each reference has the value from its row")
+            {
+                REQUIRE(cache.value(Ref1) == 1);
+                REQUIRE(cache.value(Ref2) == 2);
+                REQUIRE(cache.value(Ref3) == 3);
+            }
             AND_WHEN("The cache is cleared")
             {
                 cache.clear();
@@ -0,0 +1,183 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "ColumnarSeries.hpp"
+#include "catch2/catch.hpp"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace columnar_series_test
+{
+// true when the buffer is on the alignment Arrow recommends
+bool isAligned(const void *buffer)
+{
+    return reinterpret_cast<uintptr_t>(buffer) % 64 == 0;
+}
+} // namespace columnar_series_test
+
+SCENARIO("A scalar ColumnarSeries holds one value slot per row", "[columnar-series]")
+{
+    GIVEN("A series of doubles with a valid, an invalid and an empty event")
+    {
+        ColumnarSeries<double> series {false};
+        series.append(1000, Tango::ATTR_VALID, {1.5});
+        series.append(2000, Tango::ATTR_INVALID, {2.5});
+        series.append(3000, Tango::ATTR_VALID, {});
+
+        THEN("Every row has a timestamp and a value slot")
+        {
+            REQUIRE(series.size() == 3);
+            REQUIRE(series.valueCount() == 3);
+            REQUIRE(!series.isList());
+            REQUIRE(series.offsets() == nullptr);
+            REQUIRE(series.valueOffsets() == nullptr);
+            REQUIRE(series.timestamps()[1] == 2000);
+            REQUIRE(string(series.valueFormat()) == "g");
+        }
+        AND_THEN("Only the valid event is valid in the bitmap")
+        {
+            REQUIRE(series.nullCount() == 2);
+            REQUIRE(series.validity()[0] == 0x01);
+            REQUIRE(series.isValid(0));
+            REQUIRE(!series.isValid(1));
+            REQUIRE(static_cast<const double *>(series.valueData())[0] == 1.5);
+        }
+        AND_THEN("The buffers are aligned")
+        {
+            REQUIRE(columnar_series_test::isAligned(series.timestamps()));
+            REQUIRE(columnar_series_test::isAligned(series.validity()));
+            REQUIRE(columnar_series_test::isAligned(series.valueData()));
+        }
+    }
+}
+
+SCENARIO("A spectrum ColumnarSeries holds a list per row", "[columnar-series]")
+{
+    GIVEN("A series of int32 lists with a null row between two valid rows")
+    {
+        ColumnarSeries<int32_t> series {true};
+        series.append(1000, Tango::ATTR_VALID, {1, 2, 3});
+        series.append(2000, Tango::ATTR_VALID, {});
+        series.append(3000, Tango::ATTR_ALARM, {4, 5});
+
+        THEN("The offsets mark the elements of each row")
+        {
+            REQUIRE(series.isList());
+            REQUIRE(series.size() == 3);
+            REQUIRE(series.valueCount() == 5);
+
+            vector<int32_t> offsets(series.offsets(), series.offsets() + series.size() + 1);
+            REQUIRE(offsets == vector<int32_t> {0, 3, 3, 5});
+
+            auto values = static_cast<const int32_t *>(series.valueData());
+            REQUIRE(vector<int32_t>(values, values + 5) == vector<int32_t> {1, 2, 3, 4, 5});
+        }
+        AND_THEN("The empty row is null")
+        {
+            REQUIRE(series.nullCount() == 1);
+            REQUIRE(series.validity()[0] == 0x05);
+        }
+    }
+}
+
+SCENARIO("Bools and strings use the Arrow layouts for their types", "[columnar-series]")
+{
+    GIVEN("A series of bools")
+    {
+        ColumnarSeries<bool> series {false};
+
+        for (auto i = 0; i < 10; i++)
+            series.append(i, Tango::ATTR_VALID, {i % 3 == 0});
+
+        THEN("The values are packed into a bitmap")
+        {
+            REQUIRE(string(series.valueFormat()) == "b");
+            REQUIRE(series.valueCount() == 10);
+
+            auto values = static_cast<const uint8_t *>(series.valueData());
+            REQUIRE(values[0] == 0x49);
+            REQUIRE(values[1] == 0x02);
+        }
+    }
+    GIVEN("A series of string lists")
+    {
+        ColumnarSeries<string> series {true};
+        series.append(1000, Tango::ATTR_VALID, {"ab", "", "cde"});
+        series.append(2000, Tango::ATTR_INVALID, {"lost"});
+        series.append(3000, Tango::ATTR_VALID, {"f"});
+
+        THEN("The strings are end to end with an offset for each")
+        {
+            REQUIRE(string(series.valueFormat()) == "u");
+            REQUIRE(series.valueCount() == 4);
+
+            vector<int32_t> string_offsets(series.valueOffsets(), series.valueOffsets() + 5);
+            REQUIRE(string_offsets == vector<int32_t> {0, 2, 2, 5, 6});
+            REQUIRE(memcmp(series.valueData(), "abcdef", 6) == 0);
+
+            vector<int32_t> offsets(series.offsets(), series.offsets() + 4);
+            REQUIRE(offsets == vector<int32_t> {0, 3, 3, 4});
+        }
+    }
+    GIVEN("A series of DevState")
+    {
+        ColumnarSeries<Tango::DevState> series {false};
+        series.append(1000, Tango::ATTR_VALID, {Tango::OFF});
+
+        THEN("The states are held as int32")
+        {
+            REQUIRE(string(series.valueFormat()) == "i");
+            REQUIRE(static_cast<const int32_t *>(series.valueData())[0] == static_cast<int32_t>(Tango::OFF));
+        }
+    }
+}
+
+SCENARIO("A ColumnarSeries is built from fetched DataEventChunks", "[columnar-series]")
+{
+    GIVEN("A chunk of events with read and write values")
+    {
+        DataEventChunk<float> chunk;
+        chunk.data_time = {1577836800.000001, 1577836801.5};
+        chunk.quality = {Tango::ATTR_VALID, Tango::ATTR_VALID};
+        chunk.value_r = {1.0f, 2.0f};
+        chunk.value_r_offsets = {0, 1, 2};
+        chunk.value_w = {4.0f};
+        chunk.value_w_offsets = {0, 0, 1};
+
+        WHEN("The write values are appended to a series")
+        {
+            ColumnarSeries<float> series {false};
+            series.append(chunk, true);
+
+            THEN("The times are converted to nanoseconds and the write values used")
+            {
+                REQUIRE(series.size() == 2);
+                REQUIRE(series.timestamps()[0] == 1577836800000001000);
+                REQUIRE(series.timestamps()[1] == 1577836801500000000);
+                REQUIRE(!series.isValid(0));
+                REQUIRE(static_cast<const float *>(series.valueData())[1] == 4.0f);
+            }
+        }
+    }
+}
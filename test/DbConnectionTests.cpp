@@ -26,6 +26,8 @@
 #include "catch2/catch.hpp"
 
 #include <cfloat>
+#include <chrono>
+#include <functional>
 #include <pqxx/pqxx>
 #include <string>
 #include <tuple>
@@ -816,6 +818,167 @@ TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
     SUCCEED("Passed");
 }
 
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "Storing batched event data for all Tango type combinations in the database",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    auto traits_array = getTraitsImplemented();
+
+    vector<DbConnection::DbStoreMethod> access_methods {DbConnection::DbStoreMethod::PreparedStatement,
+        DbConnection::DbStoreMethod::InsertString,
+        DbConnection::DbStoreMethod::CopyStream,
+        DbConnection::DbStoreMethod::CopyBinary};
+
+    for (auto access : access_methods)
+    {
+        REQUIRE_NOTHROW(clearTables());
+        resetDbAccess(access);
+
+        // large enough that nothing is stored until the flush
+        REQUIRE_NOTHROW(testConn().enableBatching(1000, chrono::milliseconds(60000)));
+        REQUIRE(testConn().isBatching());
+
+        vector<std::function<void()>> checks;
+
+        for (auto &traits : traits_array)
+        {
+            INFO("Inserting data for traits: " << traits);
+            auto name = storeAttributeByTraits(traits);
+
+            // store now, check after the flush
+            auto batch = [this, &checks, name, traits](auto data) {
+                checks.emplace_back([this, name, traits, data]() { checkStoreTestEventData(name, traits, data); });
+            };
+
+            switch (traits.type())
+            {
+                case Tango::DEV_BOOLEAN: batch(storeTestEventData<Tango::DEV_BOOLEAN>(name, traits)); break;
+                case Tango::DEV_SHORT: batch(storeTestEventData<Tango::DEV_SHORT>(name, traits)); break;
+                case Tango::DEV_LONG: batch(storeTestEventData<Tango::DEV_LONG>(name, traits)); break;
+                case Tango::DEV_LONG64: batch(storeTestEventData<Tango::DEV_LONG64>(name, traits)); break;
+                case Tango::DEV_FLOAT: batch(storeTestEventData<Tango::DEV_FLOAT>(name, traits)); break;
+                case Tango::DEV_DOUBLE: batch(storeTestEventData<Tango::DEV_DOUBLE>(name, traits)); break;
+                case Tango::DEV_UCHAR: batch(storeTestEventData<Tango::DEV_UCHAR>(name, traits)); break;
+                case Tango::DEV_USHORT: batch(storeTestEventData<Tango::DEV_USHORT>(name, traits)); break;
+                case Tango::DEV_ULONG: batch(storeTestEventData<Tango::DEV_ULONG>(name, traits)); break;
+                case Tango::DEV_ULONG64: batch(storeTestEventData<Tango::DEV_ULONG64>(name, traits)); break;
+                case Tango::DEV_STRING: batch(storeTestEventData<Tango::DEV_STRING>(name, traits)); break;
+                case Tango::DEV_STATE: batch(storeTestEventData<Tango::DEV_STATE>(name, traits)); break;
+                default: throw "Should not be here!";
+            }
+        }
+
+        REQUIRE_NOTHROW(testConn().flush());
+
+        for (auto &check : checks)
+            check();
+    }
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "Storing a batch holding an event already stored keeps the other events",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    // pipelined events are not batched, but a failed event in the pipeline must likewise
+    // leave the events sent around it stored, and is only logged
+    vector<DbConnection::DbStoreMethod> access_methods {DbConnection::DbStoreMethod::PreparedStatement,
+        DbConnection::DbStoreMethod::InsertString,
+        DbConnection::DbStoreMethod::CopyStream,
+        DbConnection::DbStoreMethod::CopyBinary,
+        DbConnection::DbStoreMethod::Pipeline};
+
+    auto store = [this, &traits](const string &name, double event_time) {
+        REQUIRE_NOTHROW(testConn().storeDataEvent(name,
+            event_time,
+            Tango::ATTR_VALID,
+            make_unique<std::vector<double>>(1, event_time),
+            make_unique<std::vector<double>>(),
+            traits));
+    };
+
+    for (auto access : access_methods)
+    {
+        REQUIRE_NOTHROW(clearTables());
+        resetDbAccess(access);
+        REQUIRE_NOTHROW(testConn().enableBatching(1000, chrono::milliseconds(60000)));
+
+        auto name = storeAttributeByTraits(traits);
+
+        store(name, 1000);
+        REQUIRE_NOTHROW(testConn().flush());
+
+        // the first event is stored a second time, alongside two new events
+        store(name, 1000);
+        store(name, 1001);
+        store(name, 1002);
+        REQUIRE_NOTHROW(testConn().flush());
+
+        {
+            pqxx::work tx {verifyConn()};
+            auto row = tx.exec1("SELECT COUNT(*) FROM " + QueryBuilder::tableName(traits));
+            tx.commit();
+
+            REQUIRE(row.at(0).as<int>() == 3);
+        }
+    }
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "Storing pipelined event data for all Tango type combinations in the database",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    auto traits_array = getTraitsImplemented();
+
+    REQUIRE_NOTHROW(clearTables());
+
+    // on a server older than 14 this falls back to prepared statements, and should
+    // give exactly the same results
+    resetDbAccess(DbConnection::DbStoreMethod::Pipeline);
+
+    vector<std::function<void()>> checks;
+
+    for (auto &traits : traits_array)
+    {
+        INFO("Inserting data for traits: " << traits);
+        auto name = storeAttributeByTraits(traits);
+
+        // store now, check once the results are collected
+        auto pipeline = [this, &checks, name, traits](auto data) {
+            checks.emplace_back([this, name, traits, data]() { checkStoreTestEventData(name, traits, data); });
+        };
+
+        switch (traits.type())
+        {
+            case Tango::DEV_BOOLEAN: pipeline(storeTestEventData<Tango::DEV_BOOLEAN>(name, traits)); break;
+            case Tango::DEV_SHORT: pipeline(storeTestEventData<Tango::DEV_SHORT>(name, traits)); break;
+            case Tango::DEV_LONG: pipeline(storeTestEventData<Tango::DEV_LONG>(name, traits)); break;
+            case Tango::DEV_LONG64: pipeline(storeTestEventData<Tango::DEV_LONG64>(name, traits)); break;
+            case Tango::DEV_FLOAT: pipeline(storeTestEventData<Tango::DEV_FLOAT>(name, traits)); break;
+            case Tango::DEV_DOUBLE: pipeline(storeTestEventData<Tango::DEV_DOUBLE>(name, traits)); break;
+            case Tango::DEV_UCHAR: pipeline(storeTestEventData<Tango::DEV_UCHAR>(name, traits)); break;
+            case Tango::DEV_USHORT: pipeline(storeTestEventData<Tango::DEV_USHORT>(name, traits)); break;
+            case Tango::DEV_ULONG: pipeline(storeTestEventData<Tango::DEV_ULONG>(name, traits)); break;
+            case Tango::DEV_ULONG64: pipeline(storeTestEventData<Tango::DEV_ULONG64>(name, traits)); break;
+            case Tango::DEV_STRING: pipeline(storeTestEventData<Tango::DEV_STRING>(name, traits)); break;
+            case Tango::DEV_STATE: pipeline(storeTestEventData<Tango::DEV_STATE>(name, traits)); break;
+            default: throw "Should not be here!";
+        }
+    }
+
+    REQUIRE_NOTHROW(testConn().flush());
+
+    for (auto &check : checks)
+        check();
+
+    SUCCEED("Passed");
+}
+
 TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
     "Storing event data for all Tango type combinations in the database (insert strings)",
     "[db-access][hdbpp-db-access][db-connection]")
@@ -1107,6 +1270,44 @@ TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
     SUCCEED("Passed");
 }
 
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "Storing event data after the database connection has been terminated",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+    storeTestEventData<Tango::DEV_DOUBLE>(name, traits);
+
+    {
+        // terminate every other backend, as a database restart would
+        work tx {verifyConn()};
+
+        REQUIRE_NOTHROW(tx.exec("SELECT pg_terminate_backend(pid) FROM pg_stat_activity WHERE datname = "
+                                "current_database() AND pid <> pg_backend_pid()"));
+
+        tx.commit();
+    }
+
+    // the loss may only be detected by the first request to use the connection
+    try
+    {
+        testConn().storeDataEvent(name,
+            1.0,
+            Tango::ATTR_VALID,
+            make_unique<vector<double>>(vector<double> {1.0}),
+            make_unique<vector<double>>(),
+            traits);
+    }
+    catch (const Tango::DevFailed &)
+    {
+    }
+
+    auto data = storeTestEventData<Tango::DEV_DOUBLE>(name, traits);
+    checkStoreTestEventData(name, traits, data);
+    SUCCEED("Passed");
+}
+
 TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
     "Fetching the last history event after it has just been stored",
     "[db-access][hdbpp-db-access][db-connection]")
@@ -1169,3 +1370,357 @@ TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
     REQUIRE(testConn().fetchAttributeTraits(attr_name::TestAttrFQDName) == traits);
     SUCCEED("Passed");
 }
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchDataEvents() returns the data events stored in a time range, in chunks",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    vector<double> times {1000.0, 1001.5, 1003.0, 1004.25};
+
+    for (auto i = 0u; i < times.size(); i++)
+    {
+        REQUIRE_NOTHROW(testConn().storeDataEvent<double>(name,
+            times[i],
+            Tango::ATTR_VALID,
+            make_unique<vector<double>>(1, i * 1.5),
+            make_unique<vector<double>>(1, i * 2.5),
+            traits));
+    }
+
+    vector<DataEventChunk<double>> chunks;
+    auto collect = [&chunks](const DataEventChunk<double> &chunk) { chunks.push_back(chunk); };
+
+    REQUIRE_NOTHROW(testConn().fetchDataEvents<double>(name, 1001.0, 1004.25, collect, 1));
+    REQUIRE(chunks.size() == 2);
+
+    for (auto i = 0u; i < chunks.size(); i++)
+    {
+        REQUIRE(chunks[i].size() == 1);
+        REQUIRE(pqxx_conn_test::compareData(chunks[i].data_time[0], times[i + 1]));
+        REQUIRE(chunks[i].value_r == vector<double> {(i + 1) * 1.5});
+        REQUIRE(chunks[i].value_w == vector<double> {(i + 1) * 2.5});
+        REQUIRE(chunks[i].value_r_offsets == vector<size_t> {0, 1});
+        REQUIRE(chunks[i].quality[0] == Tango::ATTR_VALID);
+    }
+
+    chunks.clear();
+    REQUIRE_NOTHROW(testConn().fetchDataEvents<double>(name, 0, 2000, collect));
+    REQUIRE(chunks.size() == 1);
+    REQUIRE(chunks[0].size() == times.size());
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchDataEvents() returns spectrum values and events without data",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_LONG};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    vector<int32_t> values {1, -2, 3};
+
+    REQUIRE_NOTHROW(testConn().storeDataEvent<int32_t>(name,
+        1000.0,
+        Tango::ATTR_VALID,
+        make_unique<vector<int32_t>>(values),
+        make_unique<vector<int32_t>>(),
+        traits));
+
+    REQUIRE_NOTHROW(testConn().storeDataEventError(name, 1001.0, Tango::ATTR_INVALID, "An error", traits));
+
+    DataEventChunk<int32_t> result;
+
+    REQUIRE_NOTHROW(testConn().fetchDataEvents<int32_t>(
+        name, 0, 2000, [&result](const DataEventChunk<int32_t> &chunk) { result = chunk; }));
+
+    REQUIRE(result.size() == 2);
+    REQUIRE(result.value_r == values);
+    REQUIRE(result.readCount(0) == values.size());
+    REQUIRE(result.writeCount(0) == 0);
+    REQUIRE(result.readCount(1) == 0);
+    REQUIRE(result.value_w.empty());
+    REQUIRE(result.quality[1] == Tango::ATTR_INVALID);
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchDataEvents() throws an exception when fetching as a type other than the archived one",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_LONG};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    REQUIRE_NOTHROW(testConn().storeDataEvent<int32_t>(name,
+        1000.0,
+        Tango::ATTR_VALID,
+        make_unique<vector<int32_t>>(1, 5),
+        make_unique<vector<int32_t>>(),
+        traits));
+
+    REQUIRE_THROWS_AS(
+        testConn().fetchDataEvents<double>(name, 0, 2000, [](const DataEventChunk<double> &) {}), Tango::DevFailed);
+
+    REQUIRE_THROWS_AS(
+        testConn().fetchDataEvents<int64_t>(name, 0, 2000, [](const DataEventChunk<int64_t> &) {}), Tango::DevFailed);
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchDataEvents() throws an exception when the attribute is not archived",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    REQUIRE_NOTHROW(clearTables());
+
+    REQUIRE_THROWS(testConn().fetchDataEvents<double>(
+        attr_name::TestAttrFQDName, 0, 2000, [](const DataEventChunk<double> &) {}));
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "storeAttributeTtl() stores the ttl of an attribute",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    auto fetch_ttl = [this, &name]() {
+        pqxx::work tx {verifyConn()};
+        auto row = tx.exec1("SELECT " + schema::ConfColTtl + " FROM " + schema::ConfTableName + " WHERE " +
+            schema::ConfColName + "=" + tx.quote(name));
+
+        tx.commit();
+        return row.at(0).as<int>();
+    };
+
+    REQUIRE_NOTHROW(testConn().storeAttributeTtl(name, 48));
+    REQUIRE(fetch_ttl() == 48);
+
+    REQUIRE_NOTHROW(testConn().storeAttributeTtl(name, 0));
+    REQUIRE(fetch_ttl() == 0);
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "storeAttributeTtl() throws an exception when the attribute is not archived",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    REQUIRE_NOTHROW(clearTables());
+    REQUIRE_THROWS_AS(testConn().storeAttributeTtl(attr_name::TestAttrFQDName, 1), Tango::DevFailed);
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "applyRetention() deletes only the expired events of attributes with a ttl",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    auto now = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+
+    for (auto event_time : {1000.0, now - 60})
+    {
+        REQUIRE_NOTHROW(testConn().storeDataEvent<double>(name,
+            event_time,
+            Tango::ATTR_VALID,
+            make_unique<vector<double>>(vector<double> {event_time}),
+            make_unique<vector<double>>(),
+            traits));
+    }
+
+    auto count_events = [this, &name]() {
+        size_t count = 0;
+
+        testConn().fetchDataEvents<double>(
+            name, 0, 1.0e10, [&count](const DataEventChunk<double> &chunk) { count += chunk.size(); });
+
+        return count;
+    };
+
+    WHEN("The attribute has no ttl")
+    {
+        REQUIRE_NOTHROW(testConn().applyRetention());
+
+        THEN("Its events are kept") { REQUIRE(count_events() == 2); }
+    }
+    WHEN("The attribute has a ttl of an hour")
+    {
+        REQUIRE_NOTHROW(testConn().storeAttributeTtl(name, 1));
+        REQUIRE_NOTHROW(testConn().applyRetention());
+
+        THEN("Only the recent event is kept") { REQUIRE(count_events() == 1); }
+    }
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchRollup() aggregates the read values of a time range into buckets",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_LONG};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    // two events in the first bucket, one in the second and an error in the third
+    vector<double> times {1000.0, 1005.0, 1010.0};
+    vector<int32_t> values {4, 7, -2};
+
+    for (auto i = 0u; i < times.size(); i++)
+    {
+        REQUIRE_NOTHROW(testConn().storeDataEvent<int32_t>(name,
+            times[i],
+            Tango::ATTR_VALID,
+            make_unique<vector<int32_t>>(1, values[i]),
+            make_unique<vector<int32_t>>(1, 100),
+            traits));
+    }
+
+    REQUIRE_NOTHROW(testConn().storeDataEventError(name, 1020.0, Tango::ATTR_INVALID, "An error", traits));
+
+    RollupChunk result;
+
+    REQUIRE_NOTHROW(testConn().fetchRollup(
+        name, 0, 2000, chrono::seconds(10), [&result](const RollupChunk &chunk) { result = chunk; }));
+
+    REQUIRE(result.size() == 2);
+    REQUIRE(pqxx_conn_test::compareData(result.bucket[0], 1000.0));
+    REQUIRE(result.min[0] == 4);
+    REQUIRE(result.max[0] == 7);
+    REQUIRE(result.avg[0] == Approx(5.5));
+    REQUIRE(result.count[0] == 2);
+    REQUIRE(pqxx_conn_test::compareData(result.bucket[1], 1010.0));
+    REQUIRE(result.min[1] == -2);
+    REQUIRE(result.count[1] == 1);
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "fetchRollup() throws an exception for an attribute without rollups",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_STRING};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    REQUIRE_THROWS_AS(testConn().fetchRollup(name, 0, 2000, chrono::minutes(1), [](const RollupChunk &) {}),
+        Tango::DevFailed);
+
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "createRollups() creates the rollups of every numeric scalar table once, and fills them from flush()",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    auto name = storeAttributeByTraits(traits);
+
+    // an event older than the window of every refresh policy, so only the fill materializes it
+    auto now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+    REQUIRE_NOTHROW(testConn().storeDataEvent<double>(name,
+        static_cast<double>(now - 40 * 24 * 3600),
+        Tango::ATTR_VALID,
+        make_unique<vector<double>>(1, 2.5),
+        make_unique<vector<double>>(),
+        traits));
+
+    {
+        pqxx::nontransaction tx {verifyConn()};
+
+        for (const auto &rollup : QueryBuilder::rollups())
+            tx.exec("DROP MATERIALIZED VIEW IF EXISTS " + QueryBuilder::rollupName(traits, rollup));
+    }
+
+    REQUIRE_NOTHROW(testConn().createRollups());
+    REQUIRE_NOTHROW(testConn().createRollups());
+
+    {
+        pqxx::work tx {verifyConn()};
+
+        auto row = tx.exec1(
+            "SELECT COUNT(*) FROM timescaledb_information.continuous_aggregates WHERE view_name LIKE '" +
+            schema::SchemaTablePrefix + schema::TypeScalar + "\\_%'");
+
+        REQUIRE(row.at(0).as<size_t>() == 9 * QueryBuilder::rollups().size());
+    }
+
+    // each flush fills a week of one rollup, far fewer than this are needed
+    for (auto i = 0; i < 100; i++)
+        REQUIRE_NOTHROW(testConn().flush());
+
+    {
+        // read only what has been materialized, real time aggregation would find the event anyway
+        pqxx::nontransaction tx {verifyConn()};
+        auto rollup = QueryBuilder::rollupName(traits, QueryBuilder::rollups().back());
+
+        tx.exec("ALTER MATERIALIZED VIEW " + rollup + " SET (timescaledb.materialized_only=true)");
+        auto row = tx.exec1("SELECT COALESCE(SUM(" + schema::RollupColCount + "),0) FROM " + rollup);
+        tx.exec("ALTER MATERIALIZED VIEW " + rollup + " SET (timescaledb.materialized_only=false)");
+
+        REQUIRE(row.at(0).as<int64_t>() == 1);
+    }
+
+    testConn().enableRollups();
+
+    REQUIRE_NOTHROW(testConn().fetchRollup(name, 0, 2000, chrono::hours(1), [](const RollupChunk &) {}));
+    SUCCEED("Passed");
+}
+
+TEST_CASE_METHOD(pqxx_conn_test::DbConnectionTestsFixture,
+    "A DbConnection with cache warm-up stores against the ids loaded on connect",
+    "[db-access][hdbpp-db-access][db-connection]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    REQUIRE_NOTHROW(clearTables());
+    REQUIRE_NOTHROW(storeAttribute(traits));
+    REQUIRE_NOTHROW(testConn().storeHistoryEvent(attr_name::TestAttrFQDName, events::PauseEvent));
+
+    DbConnection conn(DbConnection::DbStoreMethod::PreparedStatement);
+    conn.enableCacheWarmup();
+    REQUIRE_NOTHROW(conn.connect(postgres_db::HdbppConnectionString));
+
+    REQUIRE(conn.fetchAttributeArchived(attr_name::TestAttrFQDName));
+    REQUIRE_NOTHROW(conn.storeHistoryEvent(attr_name::TestAttrFQDName, events::PauseEvent));
+
+    {
+        pqxx::work tx {verifyConn()};
+        auto event_row(tx.exec1("SELECT * FROM " + schema::HistoryEventTableName));
+        auto history_rows(tx.exec_n(2, "SELECT * FROM " + schema::HistoryTableName));
+        tx.commit();
+
+        for (const auto &row : history_rows)
+        {
+            REQUIRE(
+                row.at(schema::HistoryColEventId).as<int>() == event_row.at(schema::HistoryEventColEventId).as<int>());
+        }
+    }
+
+    REQUIRE_NOTHROW(conn.disconnect());
+    SUCCEED("Passed");
+}
+
+TEST_CASE("chunkInterval() sizes chunks to the target within limits", "[db-connection]")
+{
+    const size_t gigabyte = 1024 * 1024 * 1024;
+
+    // 100 bytes a second fills a gigabyte in just over 124 days
+    REQUIRE(DbConnection::chunkInterval(100, gigabyte) == chrono::seconds(gigabyte / 100));
+
+    // the interval is at least an hour, and at most a year
+    REQUIRE(DbConnection::chunkInterval(1.0e9, gigabyte) == chrono::hours(1));
+    REQUIRE(DbConnection::chunkInterval(0.001, gigabyte) == chrono::hours(24 * 365));
+    REQUIRE(DbConnection::chunkInterval(0, gigabyte) == chrono::hours(24 * 365));
+}
@@ -0,0 +1,215 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "DeadbandFilter.hpp"
+#include "ValueView.hpp"
+#include "catch2/catch.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace deadband_filter_test
+{
+const string AttrName = "tango://localhost:10000/test/device/1/attr";
+const string NotSpecified = "Not specified";
+
+// store a read only event, returning whether the filter accepted it
+template<typename T>
+bool accept(DeadbandFilter &filter, double event_time, const vector<T> &value_r, int quality = 0)
+{
+    return filter.accept<T>(AttrName, event_time, quality, value_r, vector<T> {});
+}
+} // namespace deadband_filter_test
+
+using namespace deadband_filter_test;
+
+SCENARIO("The DeadbandFilter only filters attributes with archive thresholds", "[deadband-filter]")
+{
+    DeadbandFilter filter;
+
+    GIVEN("An attribute that has no parameter event")
+    {
+        THEN("Every event is accepted, including repeats")
+        {
+            REQUIRE(accept<double>(filter, 1, {1.0}));
+            REQUIRE(accept<double>(filter, 2, {1.0}));
+            REQUIRE(filter.size() == 0);
+        }
+    }
+    GIVEN("An attribute whose thresholds are not specified")
+    {
+        filter.configure(AttrName, NotSpecified, NotSpecified, "1000");
+
+        THEN("It is not filtered") { REQUIRE(filter.size() == 0); }
+    }
+    GIVEN("An attribute whose thresholds are removed")
+    {
+        filter.configure(AttrName, "1", NotSpecified, NotSpecified);
+        REQUIRE(filter.size() == 1);
+        filter.configure(AttrName, NotSpecified, NotSpecified, NotSpecified);
+
+        THEN("It is no longer filtered") { REQUIRE(filter.size() == 0); }
+    }
+}
+
+SCENARIO("The DeadbandFilter applies the absolute change", "[deadband-filter]")
+{
+    DeadbandFilter filter;
+
+    GIVEN("An attribute with a symmetric absolute change of 1")
+    {
+        filter.configure(AttrName, "1", NotSpecified, NotSpecified);
+        REQUIRE(accept<double>(filter, 1, {10.0}));
+
+        THEN("Repeats and smaller changes are dropped")
+        {
+            REQUIRE(!accept<double>(filter, 2, {10.0}));
+            REQUIRE(!accept<double>(filter, 3, {10.5}));
+            REQUIRE(!accept<double>(filter, 4, {9.5}));
+            REQUIRE(filter.dropped() == 3);
+        }
+        AND_THEN("Changes of at least the threshold from the last stored value are stored")
+        {
+            REQUIRE(!accept<double>(filter, 2, {10.6}));
+            REQUIRE(accept<double>(filter, 3, {11.0}));
+            REQUIRE(!accept<double>(filter, 4, {10.1}));
+            REQUIRE(accept<double>(filter, 5, {9.9}));
+        }
+        AND_THEN("A change in any element of a spectrum is stored")
+        {
+            REQUIRE(accept<double>(filter, 2, {10.0, 1.0}));
+            REQUIRE(!accept<double>(filter, 3, {10.0, 1.5}));
+            REQUIRE(accept<double>(filter, 4, {10.0, 2.5}));
+        }
+    }
+    GIVEN("An attribute with an asymmetric absolute change")
+    {
+        filter.configure(AttrName, "-2,1", NotSpecified, NotSpecified);
+        REQUIRE(accept<int32_t>(filter, 1, {10}));
+
+        THEN("Each direction uses its own threshold")
+        {
+            REQUIRE(!accept<int32_t>(filter, 2, {9}));
+            REQUIRE(accept<int32_t>(filter, 3, {11}));
+            REQUIRE(accept<int32_t>(filter, 4, {9}));
+        }
+    }
+}
+
+SCENARIO("The DeadbandFilter applies the relative change", "[deadband-filter]")
+{
+    DeadbandFilter filter;
+
+    GIVEN("An attribute with a relative change of 10 percent")
+    {
+        filter.configure(AttrName, NotSpecified, "10", NotSpecified);
+        REQUIRE(accept<float>(filter, 1, {100.0f}));
+
+        THEN("Changes are compared as a percentage of the last stored value")
+        {
+            REQUIRE(!accept<float>(filter, 2, {105.0f}));
+            REQUIRE(accept<float>(filter, 3, {90.0f}));
+            REQUIRE(accept<float>(filter, 4, {0.0f}));
+        }
+        AND_THEN("Any change from zero is stored")
+        {
+            REQUIRE(accept<float>(filter, 2, {0.0f}));
+            REQUIRE(accept<float>(filter, 3, {0.001f}));
+        }
+        AND_THEN("A change to or from NaN is stored, but a repeated NaN is not")
+        {
+            auto nan = numeric_limits<float>::quiet_NaN();
+            REQUIRE(accept<float>(filter, 2, {nan}));
+            REQUIRE(!accept<float>(filter, 3, {nan}));
+            REQUIRE(accept<float>(filter, 4, {100.0f}));
+        }
+    }
+}
+
+SCENARIO("The DeadbandFilter always stores quality changes and periodic events", "[deadband-filter]")
+{
+    DeadbandFilter filter;
+
+    GIVEN("An attribute with an absolute change and an archive period of 10 seconds")
+    {
+        filter.configure(AttrName, "1", NotSpecified, "10000");
+        REQUIRE(accept<double>(filter, 100, {1.0}));
+
+        THEN("A change of quality is stored, whatever the value")
+        {
+            REQUIRE(accept<double>(filter, 101, {1.0}, 1));
+            REQUIRE(accept<double>(filter, 102, {}, 2));
+            REQUIRE(!accept<double>(filter, 103, {}, 2));
+        }
+        AND_THEN("An event is stored once the archive period has passed since the last stored")
+        {
+            REQUIRE(!accept<double>(filter, 109, {1.0}));
+            REQUIRE(accept<double>(filter, 110, {1.0}));
+            REQUIRE(!accept<double>(filter, 115, {1.0}));
+        }
+        AND_THEN("The next event is stored after a reset")
+        {
+            filter.reset(AttrName);
+            REQUIRE(accept<double>(filter, 101, {1.0}));
+        }
+    }
+}
+
+SCENARIO("The DeadbandFilter drops exact repeats of values that are not numbers", "[deadband-filter]")
+{
+    DeadbandFilter filter;
+    filter.configure(AttrName, "1", NotSpecified, NotSpecified);
+
+    GIVEN("A string attribute")
+    {
+        REQUIRE(accept<string>(filter, 1, {"a", "bc"}));
+
+        THEN("Only a repeat is dropped")
+        {
+            REQUIRE(!accept<string>(filter, 2, {"a", "bc"}));
+            REQUIRE(accept<string>(filter, 3, {"ab", "c"}));
+        }
+    }
+    GIVEN("A bool attribute")
+    {
+        REQUIRE(accept<bool>(filter, 1, {true, false}));
+
+        THEN("Only a repeat is dropped")
+        {
+            REQUIRE(!accept<bool>(filter, 2, {true, false}));
+            REQUIRE(accept<bool>(filter, 3, {true, true}));
+        }
+    }
+    GIVEN("Values passed as a ValueView")
+    {
+        vector<int16_t> values {1, 2, 3};
+        REQUIRE(accept<int16_t>(filter, 1, values));
+
+        THEN("They are compared as a vector would be")
+        {
+            ValueView<int16_t> view {values.data(), values.size()};
+            REQUIRE(!filter.accept<int16_t>(AttrName, 2, 0, view, ValueView<int16_t> {}));
+        }
+    }
+}
@@ -0,0 +1,340 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "EventJournal.hpp"
+#include "catch2/catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace event_journal_test
+{
+const string JournalPath = "/tmp/hdbpp-event-journal-test.journal";
+const size_t JournalCapacity = 64 * 1024;
+
+JournalRecord makeRecord(int i)
+{
+    auto value_r = make_unique<vector<double>>(vector<double> {i * 1.5, i * 2.5});
+    auto value_w = make_unique<vector<double>>();
+
+    return journal_utils::makeRecord<double>("tango://localhost:10000/domain/family/member/attr" + to_string(i),
+        1000.0 + i,
+        0,
+        value_r,
+        value_w,
+        AttributeTraits {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE});
+}
+} // namespace event_journal_test
+
+SCENARIO("Values are encoded and decoded for the journal", "[event-journal]")
+{
+    GIVEN("Read and write values of strings")
+    {
+        auto value_r = make_unique<vector<string>>(vector<string> {"one", "", "three"});
+        auto value_w = make_unique<vector<string>>();
+
+        WHEN("They are encoded then decoded")
+        {
+            string data;
+            journal_utils::appendValues<string>(data, value_r);
+            journal_utils::appendValues<string>(data, value_w);
+
+            size_t pos = 0;
+            auto read_r = journal_utils::readValues<string>(data, pos, data.size());
+            auto read_w = journal_utils::readValues<string>(data, pos, data.size());
+
+            THEN("The values are unchanged, and all the data was read")
+            {
+                REQUIRE(*read_r == *value_r);
+                REQUIRE(read_w->empty());
+                REQUIRE(pos == data.size());
+            }
+        }
+    }
+    GIVEN("Values of bools")
+    {
+        auto value = make_unique<vector<bool>>(vector<bool> {true, false, true});
+
+        WHEN("They are encoded then decoded")
+        {
+            string data;
+            journal_utils::appendValues<bool>(data, value);
+
+            size_t pos = 0;
+            auto read = journal_utils::readValues<bool>(data, pos, data.size());
+
+            THEN("The values are unchanged") { REQUIRE(*read == *value); }
+        }
+    }
+    GIVEN("Values held in an array rather than a vector")
+    {
+        const double values[] = {1.5, -2.5, 3.5};
+
+        WHEN("They are encoded from the range then decoded")
+        {
+            string data;
+            journal_utils::appendValues<double>(data, begin(values), end(values), 3);
+
+            string from_vector;
+            journal_utils::appendValues<double>(from_vector, make_unique<vector<double>>(begin(values), end(values)));
+
+            size_t pos = 0;
+            auto read = journal_utils::readValues<double>(data, pos, data.size());
+
+            THEN("They are encoded as the same values in a vector")
+            {
+                REQUIRE(data == from_vector);
+                REQUIRE(*read == vector<double>(begin(values), end(values)));
+            }
+        }
+    }
+}
+
+SCENARIO("Corrupt values are refused rather than read past their end", "[event-journal]")
+{
+    GIVEN("Encoded values of doubles and strings")
+    {
+        string doubles;
+        journal_utils::appendValues<double>(doubles, make_unique<vector<double>>(vector<double> {1.5, 2.5}));
+
+        string strings;
+        journal_utils::appendValues<string>(strings, make_unique<vector<string>>(vector<string> {"one", "two"}));
+
+        WHEN("They are truncated")
+        {
+            THEN("Reading them fails at every truncation")
+            {
+                for (auto end = 0u; end < doubles.size(); end++)
+                {
+                    size_t pos = 0;
+                    REQUIRE(journal_utils::readValues<double>(doubles, pos, end) == nullptr);
+                }
+
+                for (auto end = 0u; end < strings.size(); end++)
+                {
+                    size_t pos = 0;
+                    REQUIRE(journal_utils::readValues<string>(strings, pos, end) == nullptr);
+                }
+            }
+        }
+        WHEN("The element count is larger than the data")
+        {
+            uint32_t count = 0xffffffff;
+            memcpy(&doubles[1], &count, sizeof(count));
+
+            size_t pos = 0;
+            auto read = journal_utils::readValues<double>(doubles, pos, doubles.size());
+
+            THEN("Reading them fails without sizing the vector") { REQUIRE(read == nullptr); }
+        }
+        WHEN("A string length is larger than the data")
+        {
+            uint32_t length = 1000;
+            memcpy(&strings[1 + sizeof(uint32_t)], &length, sizeof(length));
+
+            size_t pos = 0;
+            auto read = journal_utils::readValues<string>(strings, pos, strings.size());
+
+            THEN("Reading them fails") { REQUIRE(read == nullptr); }
+        }
+    }
+}
+
+SCENARIO("The EventJournal hands out records for replay in the order they were added", "[event-journal]")
+{
+    remove(event_journal_test::JournalPath.c_str());
+
+    GIVEN("An empty journal")
+    {
+        EventJournal journal(event_journal_test::JournalPath, event_journal_test::JournalCapacity);
+        REQUIRE(journal.empty());
+
+        WHEN("Records are appended")
+        {
+            for (auto i = 0; i < 10; i++)
+                REQUIRE(journal.append(event_journal_test::makeRecord(i)));
+
+            REQUIRE(journal.size() == 10);
+
+            THEN("A replay returns the oldest records unchanged")
+            {
+                auto records = journal.beginReplay(4);
+                REQUIRE(records.size() == 4);
+
+                for (auto i = 0; i < 4; i++)
+                {
+                    auto expected = event_journal_test::makeRecord(i);
+                    REQUIRE(records[i].attr_name == expected.attr_name);
+                    REQUIRE(records[i].traits == expected.traits);
+                    REQUIRE(records[i].event_time == expected.event_time);
+                    REQUIRE(records[i].quality == expected.quality);
+                    REQUIRE(records[i].values == expected.values);
+                }
+
+                AND_THEN("A second replay is refused while the first is running")
+                {
+                    REQUIRE(journal.beginReplay(4).empty());
+                    journal.endReplay(true);
+                }
+                AND_THEN("Consumed records are not returned again")
+                {
+                    journal.endReplay(true);
+                    REQUIRE(journal.size() == 6);
+
+                    auto next = journal.beginReplay(100);
+                    REQUIRE(next.size() == 6);
+                    REQUIRE(next.front().attr_name == event_journal_test::makeRecord(4).attr_name);
+
+                    journal.endReplay(true);
+                    REQUIRE(journal.empty());
+                }
+                AND_THEN("Records not consumed are returned again")
+                {
+                    journal.endReplay(false);
+                    REQUIRE(journal.size() == 10);
+
+                    auto next = journal.beginReplay(100);
+                    REQUIRE(next.size() == 10);
+                    REQUIRE(next.front().attr_name == records.front().attr_name);
+                    journal.endReplay(false);
+                }
+                AND_THEN("Only the records consumed are not returned again")
+                {
+                    journal.endReplay(size_t {3});
+                    REQUIRE(journal.size() == 7);
+
+                    auto next = journal.beginReplay(100);
+                    REQUIRE(next.size() == 7);
+                    REQUIRE(next.front().attr_name == records[3].attr_name);
+                    journal.endReplay(false);
+                }
+            }
+        }
+        WHEN("Records are appended until the journal is full")
+        {
+            size_t added = 0;
+
+            while (journal.append(event_journal_test::makeRecord(added)))
+                added++;
+
+            THEN("Further records are refused until space is made by a replay")
+            {
+                REQUIRE(added > 0);
+                REQUIRE(journal.size() == added);
+
+                auto records = journal.beginReplay(added);
+                REQUIRE(records.size() == added);
+                journal.endReplay(true);
+
+                REQUIRE(journal.empty());
+                REQUIRE(journal.append(event_journal_test::makeRecord(0)));
+            }
+        }
+    }
+
+    remove(event_journal_test::JournalPath.c_str());
+}
+
+SCENARIO("The EventJournal keeps records when it is reopened", "[event-journal]")
+{
+    remove(event_journal_test::JournalPath.c_str());
+
+    GIVEN("A journal with records, some of which have been replayed")
+    {
+        {
+            EventJournal journal(event_journal_test::JournalPath, event_journal_test::JournalCapacity);
+
+            for (auto i = 0; i < 10; i++)
+                journal.append(event_journal_test::makeRecord(i));
+
+            journal.beginReplay(3);
+            journal.endReplay(true);
+        }
+
+        WHEN("The journal is reopened")
+        {
+            EventJournal journal(event_journal_test::JournalPath, event_journal_test::JournalCapacity);
+
+            THEN("Only the records not yet replayed are returned")
+            {
+                REQUIRE(journal.size() == 7);
+
+                auto records = journal.beginReplay(100);
+                REQUIRE(records.size() == 7);
+                REQUIRE(records.front().attr_name == event_journal_test::makeRecord(3).attr_name);
+                REQUIRE(records.back().attr_name == event_journal_test::makeRecord(9).attr_name);
+                journal.endReplay(true);
+            }
+        }
+    }
+
+    remove(event_journal_test::JournalPath.c_str());
+}
+
+SCENARIO("The EventJournal stops at a corrupt record when it is reopened", "[event-journal]")
+{
+    remove(event_journal_test::JournalPath.c_str());
+
+    GIVEN("A journal whose third record has a name length running past its end")
+    {
+        {
+            EventJournal journal(event_journal_test::JournalPath, event_journal_test::JournalCapacity);
+
+            for (auto i = 0; i < 5; i++)
+                journal.append(event_journal_test::makeRecord(i));
+        }
+
+        // records are the length, 4 bytes of traits, the time, the quality, then the
+        // length prefixed name and values, and start after the 64 byte header
+        auto record = event_journal_test::makeRecord(0);
+        auto record_size = 3 * sizeof(uint32_t) + 4 + sizeof(double) + sizeof(int32_t) + record.attr_name.size() +
+            record.values.size();
+
+        auto name_length_pos = 64 + 2 * record_size + sizeof(uint32_t) + 4 + sizeof(double) + sizeof(int32_t);
+        uint32_t corrupt_length = 0xffffffff;
+
+        auto *file = fopen(event_journal_test::JournalPath.c_str(), "r+b");
+        REQUIRE(file != nullptr);
+        fseek(file, static_cast<long>(name_length_pos), SEEK_SET);
+        fwrite(&corrupt_length, sizeof(corrupt_length), 1, file);
+        fclose(file);
+
+        WHEN("The journal is reopened")
+        {
+            EventJournal journal(event_journal_test::JournalPath, event_journal_test::JournalCapacity);
+
+            THEN("Only the records before the corrupt one are returned")
+            {
+                REQUIRE(journal.size() == 2);
+
+                auto records = journal.beginReplay(100);
+                REQUIRE(records.size() == 2);
+                REQUIRE(records.back().attr_name == event_journal_test::makeRecord(1).attr_name);
+                journal.endReplay(true);
+            }
+        }
+    }
+
+    remove(event_journal_test::JournalPath.c_str());
+}
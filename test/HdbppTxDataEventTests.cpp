@@ -209,6 +209,28 @@ SCENARIO("Construct a valid HdbppTxDataEvent data event for storage", "[hdbpp-tx
                 REQUIRE(conn.data_size_w == 0);
             }
         }
+        WHEN("Configuring an HdbppTxDataEvent object from a registered attribute and storing")
+        {
+            AttributeRegistry registry;
+            const auto &record = registry.acquire(TestAttrFQDName, traits);
+
+            auto attr = hdbpp_data_event_test::createDeviceAttribute(traits);
+            auto tx = conn.createTx<HdbppTxDataEvent>();
+
+            REQUIRE_NOTHROW(tx.withRecord(record)
+                                .withEventTime(tango_tv)
+                                .withQuality(Tango::ATTR_VALID)
+                                .withAttribute(&attr));
+
+            REQUIRE_NOTHROW(tx.store());
+
+            THEN("The name and traits are taken from the record")
+            {
+                REQUIRE(conn.att_name == TestAttrFinalName);
+                REQUIRE(conn.att_traits == traits);
+                REQUIRE(conn.data_size_r == 1);
+            }
+        }
         WHEN("Configuring an HdbppTxDataEvent object as a spectrum data event")
         {
             auto attr = hdbpp_data_event_test::createDeviceAttribute(traits);
@@ -0,0 +1,181 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "HostResolver.hpp"
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace host_resolver_test
+{
+// stands in for the system resolver, adds a domain to each host and counts the
+// lookups. Lookups fail while failing is set
+struct MockResolver
+{
+    atomic<int> lookups {0};
+    atomic<bool> failing {false};
+    string domain {".esrf.fr"};
+
+    HostResolver::Resolve resolve()
+    {
+        return [this](const string &host, string &canonical_name) {
+            lookups++;
+
+            if (failing)
+                return false;
+
+            canonical_name = host + domain;
+            return true;
+        };
+    }
+};
+
+// wait for a background refresh to be made
+bool waitForLookups(const MockResolver &resolver, int lookups)
+{
+    for (auto i = 0; i < 500 && resolver.lookups < lookups; i++)
+        this_thread::sleep_for(chrono::milliseconds(2));
+
+    return resolver.lookups >= lookups;
+}
+} // namespace host_resolver_test
+
+using namespace host_resolver_test;
+
+SCENARIO("HostResolver resolves each host once while it is fresh", "[host-resolver]")
+{
+    MockResolver mock;
+    HostResolver resolver {mock.resolve()};
+
+    GIVEN("Repeated lookups of two hosts")
+    {
+        for (auto i = 0; i < 100; i++)
+        {
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+            REQUIRE(resolver.canonicalName("tango-db") == "tango-db.esrf.fr");
+        }
+
+        THEN("Each host was resolved once")
+        {
+            REQUIRE(mock.lookups == 2);
+            REQUIRE(resolver.size() == 2);
+        }
+    }
+    GIVEN("Concurrent first lookups of a host")
+    {
+        vector<future<string>> results;
+
+        for (auto i = 0; i < 8; i++)
+            results.push_back(async(launch::async, [&resolver]() { return resolver.canonicalName("archiver"); }));
+
+        THEN("Every caller gets the name from a single lookup")
+        {
+            for (auto &result : results)
+                REQUIRE(result.get() == "archiver.esrf.fr");
+
+            REQUIRE(mock.lookups == 1);
+        }
+    }
+}
+
+SCENARIO("HostResolver refreshes expired hosts in the background", "[host-resolver]")
+{
+    MockResolver mock;
+    HostResolver resolver {mock.resolve(), chrono::milliseconds(0), chrono::milliseconds(0)};
+
+    REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+
+    GIVEN("The host's domain changes")
+    {
+        mock.domain = ".example.org";
+
+        THEN("The cached name is returned while the host is resolved again")
+        {
+            auto generation = resolver.generation();
+
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+            REQUIRE(waitForLookups(mock, 2));
+
+            // the refresh is stored after the lookup returns
+            for (auto i = 0; i < 500 && resolver.canonicalName("archiver") != "archiver.example.org"; i++)
+                this_thread::sleep_for(chrono::milliseconds(2));
+
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.example.org");
+
+            AND_THEN("The change is reported by the generation")
+            {
+                REQUIRE(resolver.generation() > generation);
+            }
+        }
+    }
+    GIVEN("The resolver starts failing")
+    {
+        mock.failing = true;
+
+        THEN("The last resolved name is kept")
+        {
+            auto generation = resolver.generation();
+
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+            REQUIRE(waitForLookups(mock, 2));
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+            REQUIRE(resolver.generation() == generation);
+        }
+    }
+}
+
+SCENARIO("HostResolver returns a host it can not resolve unchanged", "[host-resolver]")
+{
+    MockResolver mock;
+    mock.failing = true;
+
+    HostResolver resolver {mock.resolve(), chrono::minutes(5), chrono::milliseconds(0)};
+
+    REQUIRE(resolver.canonicalName("archiver") == "archiver");
+
+    GIVEN("The resolver recovers")
+    {
+        mock.failing = false;
+
+        THEN("The host is retried in the background")
+        {
+            REQUIRE(resolver.canonicalName("archiver") == "archiver");
+
+            for (auto i = 0; i < 500 && resolver.canonicalName("archiver") != "archiver.esrf.fr"; i++)
+                this_thread::sleep_for(chrono::milliseconds(2));
+
+            REQUIRE(resolver.canonicalName("archiver") == "archiver.esrf.fr");
+        }
+    }
+}
+
+SCENARIO("The process wide HostResolver resolves with getaddrinfo", "[host-resolver]")
+{
+    auto &resolver = HostResolver::instance();
+
+    REQUIRE(&resolver == &HostResolver::instance());
+    REQUIRE(!resolver.canonicalName("localhost").empty());
+}
@@ -0,0 +1,180 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "PayloadPool.hpp"
+#include "catch2/catch.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace payload_pool_test
+{
+// empty the calling thread's pool, so each test starts from the same state
+template<typename T>
+void drain()
+{
+    while (PayloadPool<T>::size() > 0)
+        PayloadPool<T>::acquire();
+}
+} // namespace payload_pool_test
+
+SCENARIO("The PayloadPool recycles released vectors", "[payload-pool]")
+{
+    payload_pool_test::drain<double>();
+
+    GIVEN("A vector acquired from an empty pool")
+    {
+        auto payload = PayloadPool<double>::acquire();
+        REQUIRE(payload);
+        REQUIRE(payload->empty());
+
+        payload->assign(100, 1.0);
+        auto *address = payload.get();
+
+        WHEN("It is released and another is acquired")
+        {
+            PayloadPool<double>::release(move(payload));
+            REQUIRE(PayloadPool<double>::size() == 1);
+
+            auto next = PayloadPool<double>::acquire();
+
+            THEN("The same vector is returned empty, with its capacity kept")
+            {
+                REQUIRE(next.get() == address);
+                REQUIRE(next->empty());
+                REQUIRE(next->capacity() >= 100);
+                REQUIRE(PayloadPool<double>::size() == 0);
+            }
+        }
+    }
+    GIVEN("Vectors of strings")
+    {
+        payload_pool_test::drain<string>();
+
+        auto payload = PayloadPool<string>::acquire();
+        payload->assign(3, "a string long enough to need its own allocation");
+
+        WHEN("It is released")
+        {
+            PayloadPool<string>::release(move(payload));
+
+            THEN("The strings are destroyed") { REQUIRE(PayloadPool<string>::acquire()->empty()); }
+        }
+    }
+
+    payload_pool_test::drain<double>();
+}
+
+SCENARIO("The PayloadPool is bounded", "[payload-pool]")
+{
+    payload_pool_test::drain<double>();
+    size_t max_pooled = PayloadPool<double>::MaxPooled;
+
+    GIVEN("More vectors than the pool holds")
+    {
+        vector<unique_ptr<vector<double>>> payloads;
+
+        for (size_t i = 0; i < max_pooled + 4; i++)
+            payloads.push_back(PayloadPool<double>::acquire());
+
+        WHEN("They are all released")
+        {
+            for (auto &payload : payloads)
+                PayloadPool<double>::release(move(payload));
+
+            THEN("Only the maximum are kept") { REQUIRE(PayloadPool<double>::size() == max_pooled); }
+        }
+    }
+    GIVEN("A vector larger than the pool keeps")
+    {
+        auto payload = PayloadPool<double>::acquire();
+        payload->resize(PayloadPool<double>::MaxPooledBytes / sizeof(double) + 1);
+
+        WHEN("It is released")
+        {
+            PayloadPool<double>::release(move(payload));
+
+            THEN("It is freed rather than kept") { REQUIRE(PayloadPool<double>::size() == 0); }
+        }
+    }
+    GIVEN("A null vector")
+    {
+        WHEN("It is released")
+        {
+            PayloadPool<double>::release(nullptr);
+
+            THEN("Nothing is kept") { REQUIRE(PayloadPool<double>::size() == 0); }
+        }
+    }
+
+    payload_pool_test::drain<double>();
+}
+
+SCENARIO("Each thread has its own PayloadPool", "[payload-pool]")
+{
+    payload_pool_test::drain<int32_t>();
+
+    GIVEN("A vector released on this thread")
+    {
+        PayloadPool<int32_t>::release(PayloadPool<int32_t>::acquire());
+        REQUIRE(PayloadPool<int32_t>::size() == 1);
+
+        WHEN("Another thread inspects its pool")
+        {
+            size_t other_size = 1;
+            thread other([&other_size]() { other_size = PayloadPool<int32_t>::size(); });
+            other.join();
+
+            THEN("It is empty") { REQUIRE(other_size == 0); }
+        }
+    }
+
+    payload_pool_test::drain<int32_t>();
+}
+
+SCENARIO("The PayloadRecycler releases the values of an event", "[payload-pool]")
+{
+    payload_pool_test::drain<float>();
+
+    GIVEN("Read and write values")
+    {
+        auto value_r = PayloadPool<float>::acquire();
+        auto value_w = PayloadPool<float>::acquire();
+
+        WHEN("A recycler for them goes out of scope")
+        {
+            {
+                PayloadRecycler<float> recycler {value_r, value_w};
+            }
+
+            THEN("Both are returned to the pool")
+            {
+                REQUIRE(!value_r);
+                REQUIRE(!value_w);
+                REQUIRE(PayloadPool<float>::size() == 2);
+            }
+        }
+    }
+
+    payload_pool_test::drain<float>();
+}
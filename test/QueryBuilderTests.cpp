@@ -42,8 +42,8 @@ SCENARIO("storeDataEventString() returns the correct Value fields for the given
         {
             AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r, value_w_empty, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r, value_w_empty, traits);
 
             THEN("The result must include the schema::DatColValueR field only")
             {
@@ -56,8 +56,8 @@ SCENARIO("storeDataEventString() returns the correct Value fields for the given
         {
             AttributeTraits traits {Tango::WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r_empty, value_w, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r_empty, value_w, traits);
 
             THEN("The result must include the schema::DatColValueW field only")
             {
@@ -70,8 +70,8 @@ SCENARIO("storeDataEventString() returns the correct Value fields for the given
         {
             AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r, value_w, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r, value_w, traits);
 
             THEN("The result must include both the schema::DatColValueR and schema::DatColValueW field")
             {
@@ -85,8 +85,8 @@ SCENARIO("storeDataEventString() returns the correct Value fields for the given
         {
             AttributeTraits traits {Tango::READ_WITH_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r, value_w, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r, value_w, traits);
 
             THEN("The result must include both the schema::DatColValueR and schema::DatColValueW field")
             {
@@ -113,8 +113,8 @@ SCENARIO("storeDataEventString() adds a null when value is size zero", "[query-s
         {
             AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r, value_w_empty, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r, value_w_empty, traits);
 
             THEN("The result must include both the schema::DatColValueR and schema::DatColValueW field")
             {
@@ -128,8 +128,8 @@ SCENARIO("storeDataEventString() adds a null when value is size zero", "[query-s
         {
             AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
 
-            auto result = query_builder.storeDataEventString<double>(
-                TestAttrFQDName, string("0"), string("1"), value_r_empty, value_w, traits);
+            string result;
+            query_builder.storeDataEventString<double>(result, 0, 0, 1, value_r_empty, value_w, traits);
 
             THEN("The result must include both the schema::DatColValueR and schema::DatColValueW field")
             {
@@ -142,6 +142,297 @@ SCENARIO("storeDataEventString() adds a null when value is size zero", "[query-s
     }
 }
 
+SCENARIO("storeDataEventValuesString() always returns both value fields", "[query-string]")
+{
+    GIVEN("A query builder object with nothing cached")
+    {
+        QueryBuilder query_builder;
+        auto value_r = make_unique<vector<double>>(1.1, 2.2);
+        auto value_w = make_unique<vector<double>>(3.3, 4.4);
+
+        WHEN("Requesting a values string for traits configured for Tango::READ")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+            string result;
+            query_builder.storeDataEventValuesString<double>(result, 1, 0, 1, value_r, value_w, traits);
+
+            THEN("The read value is stored and the write value is NULL")
+            {
+                REQUIRE_THAT(result, StartsWith("(1,TO_TIMESTAMP(0)"));
+                REQUIRE_THAT(result, Contains(query_utils::DataToString<double>::run(value_r, traits)));
+                REQUIRE_THAT(result, !Contains(query_utils::DataToString<double>::run(value_w, traits)));
+                REQUIRE_THAT(result, EndsWith(",NULL,1)"));
+            }
+        }
+        WHEN("Requesting a values string for traits configured for Tango::READ_WRITE")
+        {
+            AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+            string result;
+            query_builder.storeDataEventValuesString<double>(result, 1, 0, 1, value_r, value_w, traits);
+
+            THEN("The result must include both values")
+            {
+                REQUIRE_THAT(result, Contains(query_utils::DataToString<double>::run(value_r, traits)));
+                REQUIRE_THAT(result, Contains(query_utils::DataToString<double>::run(value_w, traits)));
+                REQUIRE_THAT(result, !Contains("NULL"));
+            }
+        }
+        WHEN("Requesting the batch statement for the traits table")
+        {
+            AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
+            auto result = QueryBuilder::storeDataEventBatchStatement(QueryBuilder::tableName(traits));
+
+            THEN("The statement names both value columns")
+            {
+                REQUIRE_THAT(result, StartsWith("INSERT INTO " + QueryBuilder::tableName(traits)));
+                REQUIRE_THAT(result, Contains(schema::DatColValueR));
+                REQUIRE_THAT(result, Contains(schema::DatColValueW));
+                REQUIRE_THAT(result, EndsWith("VALUES "));
+            }
+        }
+        WHEN("Requesting the clause that skips events already stored")
+        {
+            auto result = QueryBuilder::storeDataEventSkipStored();
+
+            THEN("It ignores conflicts on the primary key of the data tables")
+            {
+                REQUIRE(result ==
+                    " ON CONFLICT (" + schema::DatColId + "," + schema::DatColDataTime + ") DO NOTHING");
+            }
+        }
+    }
+}
+
+SCENARIO("storeDataEventString() appends the statement to the given query", "[query-string]")
+{
+    GIVEN("A query builder object and a query buffer already holding text")
+    {
+        QueryBuilder query_builder;
+        string query = "existing;";
+
+        WHEN("Appending a statement for an array of longs")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_LONG};
+            auto value_r = make_unique<vector<int32_t>>(vector<int32_t> {1, -20, 300});
+            auto value_w = make_unique<vector<int32_t>>();
+
+            query_builder.storeDataEventString<int32_t>(query, 5, 0, 1, value_r, value_w, traits);
+
+            THEN("The existing text is kept and the statement follows it")
+            {
+                REQUIRE(query ==
+                    "existing;INSERT INTO att_array_devlong (att_conf_id,data_time,value_r,quality) "
+                    "VALUES (5,TO_TIMESTAMP(0),'{1,-20,300}'::int4[],1)");
+            }
+        }
+        WHEN("Appending a statement for an array of strings")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_STRING};
+            auto value_r = make_unique<vector<string>>(vector<string> {"one", "it's"});
+            auto value_w = make_unique<vector<string>>();
+
+            query.clear();
+            query_builder.storeDataEventString<string>(query, 5, 0, 1, value_r, value_w, traits);
+
+            THEN("The strings are dollar quoted in an ARRAY")
+            {
+                REQUIRE_THAT(query, Contains("ARRAY[$$one$$,$$it's$$]::text[]"));
+            }
+        }
+        WHEN("Appending a statement for an array of bools")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_BOOLEAN};
+            auto value_r = make_unique<vector<bool>>(vector<bool> {true, false});
+            auto value_w = make_unique<vector<bool>>();
+
+            query.clear();
+            query_builder.storeDataEventString<bool>(query, 5, 0, 1, value_r, value_w, traits);
+
+            THEN("The bools are written as an array literal")
+            {
+                REQUIRE_THAT(query, Contains("'{true,false}'::bool[]"));
+            }
+        }
+    }
+}
+
+SCENARIO("storeDataEventValuesString() rows can be joined into one statement", "[query-string]")
+{
+    GIVEN("A query builder object and the batch statement for a table")
+    {
+        QueryBuilder query_builder;
+        AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_USHORT};
+        auto value_r = make_unique<vector<uint16_t>>(1, 65535);
+        auto value_w = make_unique<vector<uint16_t>>(1, 7);
+        auto query = QueryBuilder::storeDataEventBatchStatement(QueryBuilder::tableName(traits));
+        auto prefix = query;
+
+        WHEN("Two rows are appended to it")
+        {
+            query_builder.storeDataEventValuesString<uint16_t>(query, 1, 0, 0, value_r, value_w, traits);
+            query += ',';
+            query_builder.storeDataEventValuesString<uint16_t>(query, 2, 0, 0, value_r, value_w, traits);
+
+            THEN("Both rows follow the statement")
+            {
+                REQUIRE(query ==
+                    prefix + "(1,TO_TIMESTAMP(0),65535::ushort,7::ushort,0)," +
+                        "(2,TO_TIMESTAMP(0),65535::ushort,7::ushort,0)");
+            }
+        }
+    }
+}
+
+SCENARIO("storeDataEventValuesString() quotes scalars postgres can not read bare", "[query-string]")
+{
+    GIVEN("A query builder object with nothing cached")
+    {
+        QueryBuilder query_builder;
+        auto value_w = make_unique<vector<double>>();
+
+        WHEN("Requesting values strings for non finite scalar doubles")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+            auto nan = make_unique<vector<double>>(1, numeric_limits<double>::quiet_NaN());
+            auto inf = make_unique<vector<double>>(1, numeric_limits<double>::infinity());
+            auto neg_inf = make_unique<vector<double>>(1, -numeric_limits<double>::infinity());
+
+            string query;
+            query_builder.storeDataEventValuesString<double>(query, 1, 0, 0, nan, value_w, traits);
+            query_builder.storeDataEventValuesString<double>(query, 1, 0, 0, inf, value_w, traits);
+            query_builder.storeDataEventValuesString<double>(query, 1, 0, 0, neg_inf, value_w, traits);
+
+            THEN("Each value is quoted before its cast")
+            {
+                REQUIRE_THAT(query, Contains("'NaN'::float8"));
+                REQUIRE_THAT(query, Contains("'Infinity'::float8"));
+                REQUIRE_THAT(query, Contains("'-Infinity'::float8"));
+            }
+        }
+        WHEN("Requesting values strings for the smallest scalar integers")
+        {
+            AttributeTraits short_traits {Tango::READ, Tango::SCALAR, Tango::DEV_SHORT};
+            AttributeTraits long_traits {Tango::READ, Tango::SCALAR, Tango::DEV_LONG64};
+            auto short_r = make_unique<vector<int16_t>>(1, numeric_limits<int16_t>::min());
+            auto short_w = make_unique<vector<int16_t>>();
+            auto long_r = make_unique<vector<int64_t>>(1, numeric_limits<int64_t>::min());
+            auto long_w = make_unique<vector<int64_t>>();
+
+            string query;
+            query_builder.storeDataEventValuesString<int16_t>(query, 1, 0, 0, short_r, short_w, short_traits);
+            query_builder.storeDataEventValuesString<int64_t>(query, 1, 0, 0, long_r, long_w, long_traits);
+
+            THEN("Each value is quoted so the cast applies to the negative number")
+            {
+                REQUIRE_THAT(query, Contains("'-32768'::int2"));
+                REQUIRE_THAT(query, Contains("'-9223372036854775808'::int8"));
+            }
+        }
+        WHEN("Requesting a values string for a positive scalar")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+            auto value_r = make_unique<vector<double>>(1, 1.5);
+
+            string query;
+            query_builder.storeDataEventValuesString<double>(query, 1, 0, 0, value_r, value_w, traits);
+
+            THEN("The value is not quoted")
+            {
+                REQUIRE_THAT(query, Contains(",1.5::float8,"));
+            }
+        }
+    }
+}
+
+SCENARIO("storeDataEventCopyRow() returns fields matching the copy columns", "[query-string]")
+{
+    GIVEN("A query builder object with nothing cached")
+    {
+        QueryBuilder query_builder;
+        auto value_r = make_unique<vector<double>>(2, 1.5);
+        auto value_w = make_unique<vector<double>>();
+
+        WHEN("Requesting a copy row for a scalar with no write value")
+        {
+            AttributeTraits traits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_DOUBLE};
+            auto row = query_builder.storeDataEventCopyRow<double>(10, 0.25, 1, value_r, value_w, traits);
+
+            THEN("The fields are converted, and the write field is null")
+            {
+                REQUIRE(QueryBuilder::storeDataEventCopyColumns().size() == tuple_size<CopyRow>::value);
+                REQUIRE(get<0>(row) == 10);
+                REQUIRE(get<1>(row) == "1970-01-01 00:00:00.250000+00");
+                REQUIRE(get<2>(row).null == false);
+                REQUIRE(get<2>(row).text == pqxx::to_string(1.5));
+                REQUIRE(get<3>(row).null == true);
+                REQUIRE(get<4>(row) == 1);
+            }
+        }
+        WHEN("Requesting a copy row for an array")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE};
+            auto row = query_builder.storeDataEventCopyRow<double>(10, 0, 1, value_r, value_w, traits);
+
+            THEN("The array is in postgres array format")
+            {
+                REQUIRE(get<2>(row).text == "{" + pqxx::to_string(1.5) + "," + pqxx::to_string(1.5) + "}");
+            }
+        }
+        WHEN("Requesting a copy row for a string array needing escapes")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_STRING};
+            auto str_r = make_unique<vector<string>>(vector<string> {"a,b", "say \"hi\"", "back\\slash"});
+            auto str_w = make_unique<vector<string>>();
+            auto row = query_builder.storeDataEventCopyRow<string>(10, 0, 1, str_r, str_w, traits);
+
+            THEN("Each element is quoted and escaped")
+            {
+                REQUIRE(get<2>(row).text == "{\"a,b\",\"say \\\"hi\\\"\",\"back\\\\slash\"}");
+            }
+        }
+    }
+}
+
+SCENARIO("The staging statements move copied events into their data table", "[query-string]")
+{
+    GIVEN("A data table")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+        auto table_name = QueryBuilder::tableName(traits);
+        auto staging_table = QueryBuilder::storeDataEventStagingTable(table_name);
+
+        THEN("The staging table does not hide the data table") { REQUIRE(staging_table != table_name); }
+        WHEN("Requesting the statement creating the staging table")
+        {
+            auto result = QueryBuilder::createStagingTableStatement(table_name);
+
+            THEN("It is a temporary copy of the data table emptied on commit")
+            {
+                REQUIRE_THAT(result, StartsWith("CREATE TEMP TABLE IF NOT EXISTS " + staging_table));
+                REQUIRE_THAT(result, Contains("LIKE " + table_name));
+                REQUIRE_THAT(result, EndsWith("ON COMMIT DELETE ROWS"));
+            }
+        }
+        WHEN("Requesting the statement storing the staged events")
+        {
+            auto result = QueryBuilder::storeStagedDataEventsStatement(table_name);
+
+            THEN("It selects the copy columns from the staging table and skips stored events")
+            {
+                REQUIRE_THAT(result, StartsWith("INSERT INTO " + table_name + " ("));
+                REQUIRE_THAT(result, Contains("FROM " + staging_table));
+
+                for (auto &column : QueryBuilder::storeDataEventCopyColumns())
+                    REQUIRE_THAT(result, Contains(column));
+
+                REQUIRE_THAT(result, EndsWith(QueryBuilder::storeDataEventSkipStored()));
+            }
+        }
+    }
+}
+
 SCENARIO("storeDataEventStatement() returns the correct Value fields for the given traits", "[query-string]")
 {
     GIVEN("A query builder object with nothing cached")
@@ -223,6 +514,319 @@ SCENARIO("Creating valid insert queries with storeDataEventErrorQuery()", "[quer
     }
 }
 
+SCENARIO("storeDataEventPackedStatement() binds the packed value columns", "[query-string]")
+{
+    QueryBuilder query_builder;
+
+    GIVEN("An AttributeTraits configured for a read write spectrum")
+    {
+        AttributeTraits traits {Tango::READ_WRITE, Tango::SPECTRUM, Tango::DEV_DOUBLE};
+
+        WHEN("Requesting the packed statement")
+        {
+            auto result = query_builder.storeDataEventPackedStatement(traits);
+
+            THEN("Both packed value columns are inserted without a cast")
+            {
+                REQUIRE_THAT(result, StartsWith("INSERT INTO " + QueryBuilder::tableName(traits) + " ("));
+                REQUIRE_THAT(result, Contains(schema::DatColValueRPacked + "," + schema::DatColValueWPacked));
+                REQUIRE_THAT(result, EndsWith("VALUES ($1,TO_TIMESTAMP($2),$3,$4,$5)"));
+            }
+            AND_THEN("It has its own name, and is returned with the prepared statements")
+            {
+                const auto &name = query_builder.storeDataEventPackedName(traits);
+
+                REQUIRE(name != query_builder.storeDataEventName(traits));
+                REQUIRE(query_builder.preparedStatements().at(name) == result);
+            }
+        }
+    }
+    GIVEN("An AttributeTraits configured for a read only spectrum")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_LONG};
+
+        WHEN("Requesting the packed statement")
+        {
+            auto result = query_builder.storeDataEventPackedStatement(traits);
+
+            THEN("Only the packed read column is inserted")
+            {
+                REQUIRE_THAT(result, Contains(schema::DatColValueRPacked));
+                REQUIRE_THAT(result, !Contains(schema::DatColValueWPacked));
+                REQUIRE_THAT(result, EndsWith("VALUES ($1,TO_TIMESTAMP($2),$3,$4)"));
+            }
+        }
+    }
+}
+
+SCENARIO("preparedStatements() returns every statement built so far", "[query-string]")
+{
+    QueryBuilder query_builder;
+
+    GIVEN("A QueryBuilder that has not built any data event statements")
+    {
+        WHEN("Requesting the prepared statements")
+        {
+            auto result = query_builder.preparedStatements();
+
+            THEN("Only the static statements are returned")
+            {
+                REQUIRE(result.size() == 7);
+                REQUIRE(result.at(StoreAttribute) == QueryBuilder::storeAttributeStatement());
+                REQUIRE(result.at(FetchLastHistoryEvent) == QueryBuilder::fetchLastHistoryEventStatement());
+            }
+        }
+    }
+    GIVEN("A QueryBuilder that has built a data event statement")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+        const auto &name = query_builder.storeDataEventName(traits);
+        const auto &statement = query_builder.storeDataEventStatement<double>(traits);
+
+        WHEN("Requesting the prepared statements")
+        {
+            auto result = query_builder.preparedStatements();
+
+            THEN("The data event statement is returned by its name")
+            {
+                REQUIRE(result.size() == 8);
+                REQUIRE(result.at(name) == statement);
+            }
+        }
+    }
+}
+
+SCENARIO("fetchDataEventsStatement() selects a time range of one attribute", "[query-string]")
+{
+    GIVEN("An Attribute traits configured for a spectrum")
+    {
+        AttributeTraits traits {Tango::READ_WRITE, Tango::SPECTRUM, Tango::DEV_LONG};
+
+        WHEN("Requesting the statement for a time range")
+        {
+            auto result = QueryBuilder::fetchDataEventsStatement(traits, 42, 1.5, 10.25);
+
+            THEN("The statement reads the attribute's table")
+            {
+                REQUIRE_THAT(result, StartsWith("SELECT EXTRACT(EPOCH FROM " + schema::DatColDataTime + ")"));
+                REQUIRE_THAT(result, Contains(" FROM " + QueryBuilder::tableName(traits) + " "));
+                REQUIRE_THAT(result, Contains(schema::DatColValueR));
+                REQUIRE_THAT(result, Contains(schema::DatColValueW));
+                REQUIRE_THAT(result, Contains(schema::DatColQuality));
+            }
+            AND_THEN("The range is restricted to the attribute and times, in time order")
+            {
+                REQUIRE_THAT(result, Contains(schema::DatColId + "=42 "));
+                REQUIRE_THAT(result,
+                    Contains(schema::DatColDataTime + ">='" + query_utils::epochToTimestamp(1.5) + "' AND " +
+                        schema::DatColDataTime + "<'" + query_utils::epochToTimestamp(10.25) + "'"));
+                REQUIRE_THAT(result, EndsWith(" ORDER BY " + schema::DatColDataTime + " ASC"));
+            }
+            AND_THEN("The packed value columns are not read")
+            {
+                REQUIRE_THAT(result, !Contains(schema::DatColValueRPacked));
+            }
+        }
+        WHEN("Requesting the statement for packed values")
+        {
+            auto result = QueryBuilder::fetchDataEventsStatement(traits, 42, 1.5, 10.25, true);
+
+            THEN("The packed value columns follow the quality")
+            {
+                REQUIRE_THAT(result,
+                    Contains(schema::DatColQuality + "," + schema::DatColValueRPacked + "," +
+                        schema::DatColValueWPacked + " FROM "));
+            }
+        }
+    }
+}
+
+SCENARIO("The table maintenance statements apply to the given data table", "[query-string]")
+{
+    GIVEN("A data table name")
+    {
+        AttributeTraits traits {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE};
+        auto table = QueryBuilder::tableName(traits);
+
+        THEN("The chunk interval is set in seconds")
+        {
+            REQUIRE(QueryBuilder::setChunkIntervalStatement(table, std::chrono::hours(2)) ==
+                "SELECT set_chunk_time_interval('" + table + "',INTERVAL '7200 seconds')");
+        }
+        AND_THEN("Compression is segmented by attribute and ordered by time")
+        {
+            auto result = QueryBuilder::enableCompressionStatement(table);
+
+            REQUIRE_THAT(result, StartsWith("ALTER TABLE " + table + " SET ("));
+            REQUIRE_THAT(result, Contains("timescaledb.compress_segmentby='" + schema::DatColId + "'"));
+            REQUIRE_THAT(result, Contains("timescaledb.compress_orderby='" + schema::DatColDataTime + " DESC'"));
+        }
+        AND_THEN("The compression policy is in hours")
+        {
+            REQUIRE(QueryBuilder::addCompressionPolicyStatement(table, std::chrono::hours(72)) ==
+                "SELECT add_compression_policy('" + table + "',INTERVAL '72 hours')");
+        }
+        AND_THEN("Expired events are deleted for one attribute by its ttl in hours")
+        {
+            auto result = QueryBuilder::deleteExpiredEventsStatement(table, 42, 24);
+
+            REQUIRE_THAT(result, StartsWith("DELETE FROM " + table + " "));
+            REQUIRE_THAT(result, Contains(schema::DatColId + "=42 "));
+            REQUIRE_THAT(result, EndsWith(schema::DatColDataTime + "<now()-INTERVAL '24 hours'"));
+        }
+        AND_THEN("Expired events are only deleted after the compressed chunks when there are any")
+        {
+            auto result = QueryBuilder::deleteExpiredEventsStatement(table, 42, 24, 1600000000);
+
+            REQUIRE_THAT(result, Contains(schema::DatColDataTime + "<now()-INTERVAL '24 hours'"));
+            REQUIRE_THAT(result, EndsWith(schema::DatColDataTime + ">=to_timestamp(1600000000)"));
+        }
+        AND_THEN("Chunks holding only expired events are dropped by the largest ttl in hours")
+        {
+            REQUIRE(QueryBuilder::dropExpiredChunksStatement(table, 72) ==
+                "SELECT drop_chunks('" + table + "',older_than=>INTERVAL '72 hours')");
+        }
+    }
+    GIVEN("The statement listing the data tables")
+    {
+        auto result = QueryBuilder::fetchDataTablesStatement();
+
+        THEN("Only the scalar, array and image tables are matched")
+        {
+            REQUIRE_THAT(result, Contains("LIKE '" + schema::SchemaTablePrefix + schema::TypeScalar + "\\_%'"));
+            REQUIRE_THAT(result, Contains("LIKE '" + schema::SchemaTablePrefix + schema::TypeArray + "\\_%'"));
+            REQUIRE_THAT(result, !Contains(schema::ParamTableName));
+        }
+    }
+    GIVEN("The statement listing the data tables with packed value columns")
+    {
+        auto result = QueryBuilder::fetchPackedTablesStatement();
+
+        THEN("The tables are found by their packed read value column")
+        {
+            REQUIRE_THAT(result, StartsWith("SELECT table_name FROM information_schema.columns"));
+            REQUIRE_THAT(result, EndsWith("column_name='" + schema::DatColValueRPacked + "'"));
+        }
+    }
+    GIVEN("The statement storing an attribute ttl")
+    {
+        auto result = QueryBuilder::storeAttributeTtlStatement();
+
+        THEN("The row is only updated when the ttl differs")
+        {
+            REQUIRE_THAT(result, StartsWith("UPDATE " + schema::ConfTableName + " SET " + schema::ConfColTtl + "=$1"));
+            REQUIRE_THAT(result, EndsWith(schema::ConfColTtl + " IS DISTINCT FROM $1"));
+        }
+    }
+}
+
+SCENARIO("The rollup statements aggregate numeric scalars", "[query-string]")
+{
+    AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+    auto table = QueryBuilder::tableName(traits);
+
+    GIVEN("Attribute traits")
+    {
+        THEN("Only numeric scalars have rollups")
+        {
+            REQUIRE(QueryBuilder::hasRollups(traits));
+            REQUIRE(QueryBuilder::hasRollups(AttributeTraits {Tango::READ_WRITE, Tango::SCALAR, Tango::DEV_UCHAR}));
+            REQUIRE(!QueryBuilder::hasRollups(AttributeTraits {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE}));
+            REQUIRE(!QueryBuilder::hasRollups(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_BOOLEAN}));
+            REQUIRE(!QueryBuilder::hasRollups(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_STRING}));
+            REQUIRE(!QueryBuilder::hasRollups(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_STATE}));
+        }
+    }
+    GIVEN("A resolution")
+    {
+        THEN("The coarsest rollup dividing it is selected")
+        {
+            auto suffix = [](std::chrono::seconds resolution) {
+                auto rollup = QueryBuilder::selectRollup(resolution);
+                return rollup != nullptr ? rollup->suffix : string {};
+            };
+
+            REQUIRE(suffix(std::chrono::minutes(1)) == "1m");
+            REQUIRE(suffix(std::chrono::minutes(90)) == "1m");
+            REQUIRE(suffix(std::chrono::hours(6)) == "1h");
+            REQUIRE(suffix(std::chrono::hours(24)) == "1d");
+            REQUIRE(suffix(std::chrono::hours(24 * 7)) == "1d");
+        }
+        AND_THEN("There is none for a resolution finer than a minute, or not of whole minutes")
+        {
+            REQUIRE(QueryBuilder::selectRollup(std::chrono::seconds(30)) == nullptr);
+            REQUIRE(QueryBuilder::selectRollup(std::chrono::seconds(3601)) == nullptr);
+            REQUIRE(QueryBuilder::selectRollup(std::chrono::seconds(0)) == nullptr);
+        }
+    }
+    GIVEN("A rollup")
+    {
+        const auto &rollup = QueryBuilder::rollups().front();
+        auto name = QueryBuilder::rollupName(traits, rollup);
+
+        THEN("It is named after the data table")
+        {
+            REQUIRE(name == table + "_1m");
+        }
+        AND_THEN("It is a continuous aggregate of the read values per attribute and bucket")
+        {
+            auto result = QueryBuilder::createRollupStatement(traits, rollup);
+
+            REQUIRE_THAT(result, StartsWith("CREATE MATERIALIZED VIEW IF NOT EXISTS " + name + " WITH ("));
+            REQUIRE_THAT(result, Contains("timescaledb.continuous"));
+            REQUIRE_THAT(result, Contains("MIN(" + schema::DatColValueR + ") AS " + schema::RollupColMin));
+            REQUIRE_THAT(result, Contains("COUNT(" + schema::DatColValueR + ") AS " + schema::RollupColCount));
+            REQUIRE_THAT(result, Contains(" FROM " + table + " "));
+            REQUIRE_THAT(result,
+                Contains("GROUP BY " + schema::DatColId + ",time_bucket(INTERVAL '60 seconds'," +
+                    schema::DatColDataTime + ")"));
+        }
+        AND_THEN("It is created empty, to be filled a slice at a time")
+        {
+            REQUIRE_THAT(QueryBuilder::createRollupStatement(traits, rollup), EndsWith(" WITH NO DATA"));
+
+            REQUIRE(QueryBuilder::refreshRollupStatement(traits, rollup, 3600, 7200) ==
+                "CALL refresh_continuous_aggregate('" + name + "',TO_TIMESTAMP(3600),TO_TIMESTAMP(7200))");
+
+            REQUIRE(QueryBuilder::fetchFirstEventStatement(table) ==
+                "SELECT extract(epoch FROM min(" + schema::DatColDataTime + "))::bigint FROM " + table);
+        }
+        AND_THEN("Its refresh policy is added once")
+        {
+            auto result = QueryBuilder::addRollupPolicyStatement(traits, rollup);
+
+            REQUIRE_THAT(result, StartsWith("SELECT add_continuous_aggregate_policy('" + name + "',"));
+            REQUIRE_THAT(result, EndsWith("if_not_exists=>true)"));
+        }
+        AND_THEN("Its buckets are combined into the resolution when fetched")
+        {
+            auto result =
+                QueryBuilder::fetchRollupStatement(traits, &rollup, 42, 1.5, 10.25, std::chrono::minutes(5));
+
+            REQUIRE_THAT(result,
+                StartsWith("SELECT EXTRACT(EPOCH FROM time_bucket(INTERVAL '300 seconds'," + schema::RollupColBucket +
+                    "))"));
+
+            REQUIRE_THAT(result, Contains(" FROM " + name + " WHERE " + schema::DatColId + "=42 "));
+            REQUIRE_THAT(result, Contains(schema::RollupColBucket + ">='1970-01-01 00:00:01.500000+00'"));
+            REQUIRE_THAT(result, Contains("SUM(" + schema::RollupColAvg + "*" + schema::RollupColCount + ")"));
+            REQUIRE_THAT(result, EndsWith("GROUP BY 1 HAVING SUM(" + schema::RollupColCount + ")>0 ORDER BY 1 ASC"));
+        }
+    }
+    GIVEN("No rollup")
+    {
+        auto result = QueryBuilder::fetchRollupStatement(traits, nullptr, 42, 1.5, 10.25, std::chrono::seconds(10));
+
+        THEN("The data table is aggregated")
+        {
+            REQUIRE_THAT(result, Contains("time_bucket(INTERVAL '10 seconds'," + schema::DatColDataTime + ")"));
+            REQUIRE_THAT(result, Contains("AVG(" + schema::DatColValueR + ")::float8"));
+            REQUIRE_THAT(result, Contains(" FROM " + table + " WHERE "));
+            REQUIRE_THAT(result, Contains(schema::DatColDataTime + "<'1970-01-01 00:00:10.250000+00'"));
+        }
+    }
+}
+
 TEST_CASE("Creating valid database table names for types", "[query-string]")
 {
     vector<Tango::CmdArgType> types {Tango::DEV_DOUBLE,
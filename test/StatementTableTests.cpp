@@ -0,0 +1,99 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "StatementTable.hpp"
+#include "catch2/catch.hpp"
+
+using namespace std;
+using namespace hdbpp_internal;
+using namespace hdbpp_internal::pqxx_conn;
+
+SCENARIO("The StatementTable holds a statement for every supported traits", "[statement-table]")
+{
+    QueryBuilder query_builder;
+    StatementTable statements;
+
+    GIVEN("A table that has not been built")
+    {
+        THEN("It is empty and supports no traits")
+        {
+            REQUIRE(statements.empty());
+            REQUIRE(!statements.supported(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE}));
+        }
+    }
+    GIVEN("A built table")
+    {
+        statements.build(query_builder);
+
+        WHEN("Looking up the handle for supported traits")
+        {
+            AttributeTraits traits {Tango::READ_WRITE, Tango::SPECTRUM, Tango::DEV_LONG64};
+            auto &handle = statements.handle(traits);
+
+            THEN("The handle matches the query builder, and is not registered")
+            {
+                REQUIRE(statements.supported(traits));
+                REQUIRE(handle.name == query_builder.storeDataEventName(traits));
+                REQUIRE(handle.statement == query_builder.storeDataEventStatement<int64_t>(traits));
+                REQUIRE(!handle.registered);
+                REQUIRE(!handle.pipelined);
+            }
+        }
+        WHEN("Looking up differing traits")
+        {
+            auto &scalar = statements.handle(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE});
+            auto &array = statements.handle(AttributeTraits {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE});
+            auto &write = statements.handle(AttributeTraits {Tango::WRITE, Tango::SCALAR, Tango::DEV_DOUBLE});
+
+            THEN("Each has its own handle")
+            {
+                REQUIRE(&scalar != &array);
+                REQUIRE(&scalar != &write);
+                REQUIRE(scalar.name != array.name);
+                REQUIRE(scalar.name != write.name);
+            }
+        }
+        WHEN("Checking unsupported traits")
+        {
+            THEN("They are not supported")
+            {
+                REQUIRE(!statements.supported(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_ENUM}));
+                REQUIRE(!statements.supported(AttributeTraits {Tango::READ, Tango::SCALAR, Tango::DEV_ENCODED}));
+                REQUIRE(!statements.supported(AttributeTraits {}));
+            }
+        }
+        WHEN("Registering a statement then resetting the registration")
+        {
+            AttributeTraits traits {Tango::READ, Tango::SCALAR, Tango::DEV_STRING};
+            statements.handle(traits).registered = true;
+            statements.handle(traits).pipelined = true;
+
+            auto *found = statements.find(query_builder.storeDataEventName(traits));
+            statements.resetRegistration();
+
+            THEN("The handle can be found by name, and is no longer registered")
+            {
+                REQUIRE(found == &statements.handle(traits));
+                REQUIRE(!found->registered);
+                REQUIRE(!found->pipelined);
+                REQUIRE(statements.find("NoSuchStatement") == nullptr);
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "TextFormat.hpp"
+#include "catch2/catch.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal::pqxx_conn;
+
+namespace text_format_test
+{
+template<typename T>
+string format(T value)
+{
+    string out;
+    text_format::appendNumber(out, value);
+    return out;
+}
+} // namespace text_format_test
+
+SCENARIO("Integers are formatted in full", "[text-format]")
+{
+    GIVEN("The limits of the integer types")
+    {
+        THEN("They are formatted as decimal text")
+        {
+            REQUIRE(text_format_test::format(numeric_limits<int16_t>::min()) == "-32768");
+            REQUIRE(text_format_test::format(numeric_limits<uint16_t>::max()) == "65535");
+            REQUIRE(text_format_test::format(numeric_limits<int32_t>::min()) == "-2147483648");
+            REQUIRE(text_format_test::format(numeric_limits<int64_t>::min()) == "-9223372036854775808");
+            REQUIRE(text_format_test::format(numeric_limits<uint64_t>::max()) == "18446744073709551615");
+            REQUIRE(text_format_test::format(static_cast<uint8_t>(255)) == "255");
+        }
+    }
+}
+
+SCENARIO("Floating point values are formatted with the shortest text that round trips", "[text-format]")
+{
+    GIVEN("Values with a short exact decimal form")
+    {
+        THEN("No extra digits are written")
+        {
+            REQUIRE(text_format_test::format(0.1) == "0.1");
+            REQUIRE(text_format_test::format(-2.5) == "-2.5");
+            REQUIRE(text_format_test::format(0.1f) == "0.1");
+        }
+    }
+    GIVEN("Values that are not finite")
+    {
+        THEN("The postgres names are written")
+        {
+            REQUIRE(text_format_test::format(numeric_limits<double>::quiet_NaN()) == "NaN");
+            REQUIRE(text_format_test::format(numeric_limits<double>::infinity()) == "Infinity");
+            REQUIRE(text_format_test::format(-numeric_limits<float>::infinity()) == "-Infinity");
+        }
+    }
+    GIVEN("Random doubles across the full range")
+    {
+        mt19937_64 generator(42);
+        uniform_int_distribution<uint64_t> bits;
+        size_t max_chars = text_format::MaxChars<double>::value;
+
+        THEN("Every finite value reads back unchanged")
+        {
+            for (auto i = 0; i < 10000; i++)
+            {
+                auto raw = bits(generator);
+                double value;
+                memcpy(&value, &raw, sizeof(value));
+
+                if (!isfinite(value))
+                    continue;
+
+                auto text = text_format_test::format(value);
+                REQUIRE(text.size() <= max_chars);
+                REQUIRE(strtod(text.c_str(), nullptr) == value);
+            }
+        }
+    }
+    GIVEN("The extremes of the float type")
+    {
+        THEN("They read back unchanged")
+        {
+            for (auto value : {numeric_limits<float>::max(),
+                     numeric_limits<float>::lowest(),
+                     numeric_limits<float>::min(),
+                     numeric_limits<float>::denorm_min()})
+            {
+                REQUIRE(strtof(text_format_test::format(value).c_str(), nullptr) == value);
+            }
+        }
+    }
+}
+
+SCENARIO("Arrays are formatted as postgres array literals", "[text-format]")
+{
+    GIVEN("An array of doubles")
+    {
+        vector<double> values {1.5, -0.25, 1e300};
+
+        WHEN("It is appended to a buffer already holding text")
+        {
+            string out = "value=";
+            text_format::appendArray(out, values);
+
+            THEN("The elements are comma separated in braces after the text")
+            {
+                REQUIRE(out == "value={1.5,-0.25,1e+300}");
+            }
+        }
+    }
+    GIVEN("An empty array")
+    {
+        WHEN("It is appended")
+        {
+            string out;
+            text_format::appendArray(out, vector<int32_t> {});
+
+            THEN("An empty array literal is written") { REQUIRE(out == "{}"); }
+        }
+    }
+}
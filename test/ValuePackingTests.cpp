@@ -0,0 +1,237 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "ValuePacking.hpp"
+#include "catch2/catch.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace value_packing_test
+{
+// pack then unpack the values, returning the packed size
+template<typename T>
+size_t roundTrip(const vector<T> &values, vector<T> &unpacked)
+{
+    string packed;
+    value_packing::encode(values, packed);
+
+    auto data = reinterpret_cast<const uint8_t *>(packed.data());
+    REQUIRE(value_packing::decode(data, packed.size(), unpacked));
+    return packed.size();
+}
+
+// floating point values are compared bit for bit, so NaN and -0.0 are checked exactly
+template<typename T>
+bool sameBits(const vector<T> &lhs, const vector<T> &rhs)
+{
+    return lhs.size() == rhs.size() && memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+}
+
+// a slowly varying waveform, as a spectrum attribute often is, sampled by a 16 bit
+// digitiser and scaled to volts
+vector<double> waveform(size_t size)
+{
+    vector<double> values;
+
+    for (size_t i = 0; i < size; i++)
+        values.push_back(std::round(32767.0 * std::sin(static_cast<double>(i) / 1000.0)) * 10.0 / 32768.0);
+
+    return values;
+}
+} // namespace value_packing_test
+
+using namespace value_packing_test;
+
+SCENARIO("Floating point arrays are packed without loss", "[value-packing]")
+{
+    GIVEN("Random doubles")
+    {
+        mt19937_64 random {42};
+        uniform_real_distribution<double> distribution {-1.0e6, 1.0e6};
+        vector<double> values;
+
+        for (auto i = 0; i < 1000; i++)
+            values.push_back(distribution(random));
+
+        THEN("They are unpacked exactly")
+        {
+            vector<double> unpacked;
+            roundTrip(values, unpacked);
+            REQUIRE(sameBits(values, unpacked));
+        }
+    }
+    GIVEN("Doubles with special values and repeats")
+    {
+        auto nan = numeric_limits<double>::quiet_NaN();
+        auto inf = numeric_limits<double>::infinity();
+        vector<double> values {0.0, -0.0, nan, nan, inf, -inf, 1.0, 1.0, numeric_limits<double>::denorm_min(),
+            numeric_limits<double>::max(), numeric_limits<double>::lowest(), 1.5};
+
+        THEN("Every bit is preserved")
+        {
+            vector<double> unpacked;
+            roundTrip(values, unpacked);
+            REQUIRE(sameBits(values, unpacked));
+        }
+    }
+    GIVEN("Floats")
+    {
+        vector<float> values {1.0f, 1.0f, 1.25f, -3.5f, numeric_limits<float>::quiet_NaN(), 0.1f, 0.2f};
+
+        THEN("They are unpacked exactly")
+        {
+            vector<float> unpacked;
+            roundTrip(values, unpacked);
+            REQUIRE(sameBits(values, unpacked));
+        }
+    }
+    GIVEN("A slowly varying waveform")
+    {
+        auto values = waveform(10000);
+
+        THEN("It packs to under a third of the size of the array")
+        {
+            vector<double> unpacked;
+            auto size = roundTrip(values, unpacked);
+
+            REQUIRE(sameBits(values, unpacked));
+            REQUIRE(size < values.size() * sizeof(double) / 3);
+        }
+    }
+    GIVEN("A constant array")
+    {
+        vector<double> values(8000, 3.25);
+
+        THEN("Each repeated element takes a single bit")
+        {
+            vector<double> unpacked;
+            REQUIRE(roundTrip(values, unpacked) < 1100);
+            REQUIRE(unpacked == values);
+        }
+    }
+}
+
+SCENARIO("Integer arrays are packed without loss", "[value-packing]")
+{
+    GIVEN("The extremes of each width")
+    {
+        vector<int64_t> longs {0, numeric_limits<int64_t>::max(), numeric_limits<int64_t>::min(), -1, 1};
+        vector<uint64_t> ulongs {numeric_limits<uint64_t>::max(), 0, numeric_limits<uint64_t>::max(), 7};
+        vector<int16_t> shorts {numeric_limits<int16_t>::min(), numeric_limits<int16_t>::max(), -5};
+        vector<uint8_t> chars {255, 0, 128, 1};
+
+        THEN("They are unpacked exactly")
+        {
+            vector<int64_t> unpacked_longs;
+            vector<uint64_t> unpacked_ulongs;
+            vector<int16_t> unpacked_shorts;
+            vector<uint8_t> unpacked_chars;
+
+            roundTrip(longs, unpacked_longs);
+            roundTrip(ulongs, unpacked_ulongs);
+            roundTrip(shorts, unpacked_shorts);
+            roundTrip(chars, unpacked_chars);
+
+            REQUIRE(unpacked_longs == longs);
+            REQUIRE(unpacked_ulongs == ulongs);
+            REQUIRE(unpacked_shorts == shorts);
+            REQUIRE(unpacked_chars == chars);
+        }
+    }
+    GIVEN("A ramp of int32")
+    {
+        vector<int32_t> values;
+
+        for (auto i = 0; i < 1000; i++)
+            values.push_back(1000000 + i * 37);
+
+        THEN("Each element after the first two takes a single byte")
+        {
+            vector<int32_t> unpacked;
+            REQUIRE(roundTrip(values, unpacked) < 1010);
+            REQUIRE(unpacked == values);
+        }
+    }
+}
+
+SCENARIO("Packed values are checked when they are unpacked", "[value-packing]")
+{
+    GIVEN("An empty array")
+    {
+        THEN("It is packed as a header alone")
+        {
+            vector<double> unpacked {1.0};
+            REQUIRE(roundTrip(vector<double> {}, unpacked) == 2);
+            REQUIRE(unpacked.empty());
+        }
+    }
+    GIVEN("Packed doubles")
+    {
+        string packed;
+        value_packing::encode(waveform(100), packed);
+        auto data = reinterpret_cast<const uint8_t *>(packed.data());
+
+        THEN("A truncated blob is rejected")
+        {
+            vector<double> unpacked;
+            REQUIRE(!value_packing::decode(data, packed.size() / 2, unpacked));
+            REQUIRE(!value_packing::decode(data, 0, unpacked));
+        }
+        AND_THEN("They can not be unpacked as another codec")
+        {
+            vector<int64_t> unpacked;
+            REQUIRE(!value_packing::decode(data, packed.size(), unpacked));
+        }
+    }
+    GIVEN("Packed integers")
+    {
+        string packed;
+        value_packing::encode(vector<int32_t> {1, 2, 3}, packed);
+
+        THEN("Trailing bytes are rejected")
+        {
+            packed.push_back(0);
+            auto data = reinterpret_cast<const uint8_t *>(packed.data());
+
+            vector<int32_t> unpacked;
+            REQUIRE(!value_packing::decode(data, packed.size(), unpacked));
+        }
+    }
+}
+
+SCENARIO("Only numeric arrays are packable", "[value-packing]")
+{
+    AttributeTraits spectrum {Tango::READ, Tango::SPECTRUM, Tango::DEV_DOUBLE};
+    AttributeTraits scalar {Tango::READ, Tango::SCALAR, Tango::DEV_DOUBLE};
+
+    REQUIRE(value_packing::packable<double>(spectrum));
+    REQUIRE(value_packing::packable<uint8_t>(spectrum));
+    REQUIRE(!value_packing::packable<double>(scalar));
+    REQUIRE(!value_packing::packable<bool>(spectrum));
+    REQUIRE(!value_packing::packable<string>(spectrum));
+    REQUIRE(!value_packing::packable<Tango::DevState>(spectrum));
+}
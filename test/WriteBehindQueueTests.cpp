@@ -0,0 +1,261 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "WriteBehindQueue.hpp"
+#include "catch2/catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace write_behind_queue_test
+{
+// stands in for the database connection, records the values it was given
+// and the thread it was given them on
+struct MockConnection
+{
+    vector<int> values;
+    thread::id writer_id;
+};
+
+using Queue = WriteBehindQueue<MockConnection>;
+
+// task to hold the writer thread until the gate is opened, so the queue
+// can be filled in a controlled way
+Queue::Task blockWriter(shared_future<void> gate)
+{
+    return [gate](MockConnection &) { gate.wait(); };
+}
+
+Queue::Task storeValue(int value)
+{
+    return [value](MockConnection &conn) {
+        conn.values.push_back(value);
+        conn.writer_id = this_thread::get_id();
+    };
+}
+} // namespace write_behind_queue_test
+
+SCENARIO("WriteBehindQueue runs tasks in order on its own thread", "[write-behind-queue]")
+{
+    GIVEN("A WriteBehindQueue with a block overflow policy")
+    {
+        write_behind_queue_test::Queue queue(
+            make_unique<write_behind_queue_test::MockConnection>(), 10, write_behind_queue_test::Queue::OverflowPolicy::Block);
+
+        WHEN("Submitting more tasks than the capacity")
+        {
+            for (auto i = 0; i < 100; i++)
+                queue.submit(write_behind_queue_test::storeValue(i));
+
+            auto conn = queue.shutdown();
+
+            THEN("All tasks were run in order on the writer thread")
+            {
+                REQUIRE(conn->values.size() == 100);
+
+                for (auto i = 0; i < 100; i++)
+                    REQUIRE(conn->values[i] == i);
+
+                REQUIRE(conn->writer_id != this_thread::get_id());
+                REQUIRE(queue.dropped() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("WriteBehindQueue reports errors from synchronous tasks to the caller", "[write-behind-queue]")
+{
+    GIVEN("A WriteBehindQueue")
+    {
+        write_behind_queue_test::Queue queue(
+            make_unique<write_behind_queue_test::MockConnection>(), 10, write_behind_queue_test::Queue::OverflowPolicy::Block);
+
+        WHEN("Executing a task that throws")
+        {
+            THEN("The exception is rethrown on the calling thread")
+            {
+                REQUIRE_THROWS_AS(queue.execute([](auto &) { throw runtime_error("failed"); }), runtime_error);
+            }
+        }
+        WHEN("Executing a task after asynchronous tasks")
+        {
+            queue.submit(write_behind_queue_test::storeValue(1));
+
+            size_t count = 0;
+            queue.execute([&count](auto &conn) { count = conn.values.size(); });
+
+            THEN("The earlier tasks have completed") { REQUIRE(count == 1); }
+        }
+        WHEN("Submitting a task that throws")
+        {
+            queue.submit([](auto &) { throw runtime_error("failed"); });
+            queue.submit(write_behind_queue_test::storeValue(1));
+            auto conn = queue.shutdown();
+
+            THEN("The failure is counted and later tasks still run")
+            {
+                REQUIRE(queue.failed() == 1);
+                REQUIRE(conn->values.size() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("WriteBehindQueue applies the overflow policy when full", "[write-behind-queue]")
+{
+    promise<void> gate;
+    shared_future<void> gate_future = gate.get_future().share();
+
+    GIVEN("A full WriteBehindQueue with a drop oldest policy")
+    {
+        write_behind_queue_test::Queue queue(make_unique<write_behind_queue_test::MockConnection>(),
+            2,
+            write_behind_queue_test::Queue::OverflowPolicy::DropOldest);
+
+        // wait for the writer to pick up the blocking task, so it does not count
+        // against the capacity
+        queue.submit(write_behind_queue_test::blockWriter(gate_future));
+
+        while (queue.size() != 0)
+            this_thread::yield();
+
+        queue.submit(write_behind_queue_test::storeValue(1));
+        queue.submit(write_behind_queue_test::storeValue(2));
+
+        WHEN("Submitting another task")
+        {
+            queue.submit(write_behind_queue_test::storeValue(3));
+            gate.set_value();
+            auto conn = queue.shutdown();
+
+            THEN("The oldest queued task was dropped")
+            {
+                REQUIRE(queue.dropped() == 1);
+                REQUIRE(conn->values == vector<int> {2, 3});
+            }
+        }
+    }
+    GIVEN("A full WriteBehindQueue with a spill policy")
+    {
+        write_behind_queue_test::Queue queue(
+            make_unique<write_behind_queue_test::MockConnection>(), 2, write_behind_queue_test::Queue::OverflowPolicy::Spill);
+
+        queue.submit(write_behind_queue_test::blockWriter(gate_future));
+
+        while (queue.size() != 0)
+            this_thread::yield();
+
+        vector<int> spilled;
+        queue.submit(write_behind_queue_test::storeValue(1), [&spilled]() { spilled.push_back(1); });
+        queue.submit(write_behind_queue_test::storeValue(2), [&spilled]() { spilled.push_back(2); });
+
+        WHEN("Submitting another task")
+        {
+            queue.submit(write_behind_queue_test::storeValue(3));
+            gate.set_value();
+            auto conn = queue.shutdown();
+
+            THEN("The oldest queued task was spilled instead of run")
+            {
+                REQUIRE(queue.spilled() == 1);
+                REQUIRE(spilled == vector<int> {1});
+                REQUIRE(conn->values == vector<int> {2, 3});
+            }
+        }
+    }
+}
+
+SCENARIO("WriteBehindQueue refuses callers waiting on a full queue when shut down", "[write-behind-queue]")
+{
+    promise<void> gate;
+    shared_future<void> gate_future = gate.get_future().share();
+
+    GIVEN("A full WriteBehindQueue with a block overflow policy")
+    {
+        write_behind_queue_test::Queue queue(
+            make_unique<write_behind_queue_test::MockConnection>(), 1, write_behind_queue_test::Queue::OverflowPolicy::Block);
+
+        queue.submit(write_behind_queue_test::blockWriter(gate_future));
+
+        while (queue.size() != 0)
+            this_thread::yield();
+
+        queue.submit(write_behind_queue_test::storeValue(1));
+
+        WHEN("The queue is shut down while a caller waits to submit")
+        {
+            auto waiting = async(launch::async, [&queue]() { queue.submit(write_behind_queue_test::storeValue(2)); });
+
+            // give the caller time to block on the full queue
+            this_thread::sleep_for(chrono::milliseconds(50));
+
+            auto stopped = async(launch::async, [&queue]() { return queue.shutdown(); });
+
+            THEN("The waiting caller is refused, and its task is never run")
+            {
+                REQUIRE_THROWS(waiting.get());
+
+                gate.set_value();
+                auto conn = stopped.get();
+
+                REQUIRE(conn->values == vector<int> {1});
+            }
+        }
+    }
+}
+
+SCENARIO("WriteBehindQueue runs the idle task on schedule while tasks keep arriving", "[write-behind-queue]")
+{
+    GIVEN("A WriteBehindQueue with an idle task counting its runs")
+    {
+        auto idle_runs = make_shared<atomic<int>>(0);
+
+        write_behind_queue_test::Queue queue(make_unique<write_behind_queue_test::MockConnection>(),
+            100,
+            write_behind_queue_test::Queue::OverflowPolicy::Block,
+            [idle_runs](write_behind_queue_test::MockConnection &) { (*idle_runs)++; },
+            chrono::milliseconds(20));
+
+        WHEN("Tasks are submitted more often than the idle interval for several intervals")
+        {
+            auto end = chrono::steady_clock::now() + chrono::milliseconds(200);
+
+            for (auto i = 0; chrono::steady_clock::now() < end; i++)
+            {
+                queue.submit(write_behind_queue_test::storeValue(i));
+                this_thread::sleep_for(chrono::milliseconds(2));
+            }
+
+            auto conn = queue.shutdown();
+
+            THEN("The idle task was still run between the tasks")
+            {
+                REQUIRE(*idle_runs > 0);
+                REQUIRE(!conn->values.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/* Copyright (C) : 2014-2019
+   European Synchrotron Radiation Facility
+   BP 220, Grenoble 38043, FRANCE
+
+   This file is part of libhdb++timescale.
+
+   libhdb++timescale is free software: you can redistribute it and/or modify
+   it under the terms of the Lesser GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   libhdb++timescale is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the Lesser
+   GNU General Public License for more details.
+
+   You should have received a copy of the Lesser GNU General Public License
+   along with libhdb++timescale.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include "WriterPool.hpp"
+#include "catch2/catch.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace hdbpp_internal;
+
+namespace writer_pool_test
+{
+// records which attribute values were stored through this connection
+struct MockConnection
+{
+    vector<pair<string, int>> values;
+};
+
+using Pool = WriterPool<MockConnection>;
+
+Pool makePool(size_t writers)
+{
+    vector<unique_ptr<MockConnection>> conns;
+
+    for (size_t i = 0; i < writers; i++)
+        conns.push_back(make_unique<MockConnection>());
+
+    return Pool(move(conns), 100, Pool::OverflowPolicy::Block);
+}
+
+const vector<string> TestAttributes = {"domain/family/member/attr1",
+    "domain/family/member/attr2",
+    "domain/family/member/attr3",
+    "domain/family/member/attr4",
+    "domain/family/member/attr5",
+    "domain/family/member/attr6",
+    "domain/family/member/attr7",
+    "domain/family/member/attr8"};
+} // namespace writer_pool_test
+
+SCENARIO("WriterPool pins each key to a single writer", "[writer-pool]")
+{
+    GIVEN("A WriterPool with 4 writers")
+    {
+        auto pool = writer_pool_test::makePool(4);
+        REQUIRE(pool.size() == 4);
+
+        WHEN("Looking up the writer for a key more than once")
+        {
+            auto *first = &pool.writerFor(writer_pool_test::TestAttributes[0]);
+            auto *second = &pool.writerFor(writer_pool_test::TestAttributes[0]);
+
+            THEN("The same writer is returned") { REQUIRE(first == second); }
+        }
+        WHEN("Submitting interleaved tasks for several keys")
+        {
+            for (auto i = 0; i < 100; i++)
+            {
+                for (auto &attr : writer_pool_test::TestAttributes)
+                {
+                    pool.submit(attr, [attr, i](writer_pool_test::MockConnection &conn) {
+                        conn.values.emplace_back(attr, i);
+                    });
+                }
+            }
+
+            auto conns = pool.shutdown();
+
+            THEN("Every key was stored on one connection in the order it was submitted")
+            {
+                REQUIRE(conns.size() == 4);
+
+                for (auto &attr : writer_pool_test::TestAttributes)
+                {
+                    auto connections_used = 0;
+
+                    for (auto &conn : conns)
+                    {
+                        vector<int> values;
+
+                        for (auto &value : conn->values)
+                            if (value.first == attr)
+                                values.push_back(value.second);
+
+                        if (values.empty())
+                            continue;
+
+                        connections_used++;
+                        REQUIRE(values.size() == 100);
+
+                        for (auto i = 0; i < 100; i++)
+                            REQUIRE(values[i] == i);
+                    }
+
+                    REQUIRE(connections_used == 1);
+                }
+            }
+        }
+    }
+}